@@ -0,0 +1,320 @@
+//go:build !js
+// +build !js
+
+package main
+
+import (
+	"encoding/json"
+	"flag"
+	"fmt"
+	"math"
+	"math/rand"
+	"os"
+	"regexp"
+	"runtime"
+	"sort"
+	"strconv"
+	"strings"
+	"testing"
+	"time"
+
+	"gonum.org/v1/gonum/mat"
+)
+
+// Native benchmark harness for the backend kernels (go run . bench).
+//
+// Every case runs on a synthetic image that depends only on its size, so results are
+// comparable across machines and commits. Results are printed as a table and can be
+// written as JSON (-out) and compared against a stored baseline (-baseline), in which
+// case the command fails if any case got slower than the threshold allows.
+// Go's benchmark flags apply too, e.g. -test.benchtime=200ms.
+
+// Default image sizes (square, in pixels per side)
+var defaultBenchSizes = []int{256, 512, 1024, 2048, 4096, 8192}
+
+// benchCase is one benchmarked operation. maxSize skips sizes where the case would
+// take minutes per iteration (full SVD is cubic in the image size).
+type benchCase struct {
+	name    string
+	maxSize int
+	run     func(img []uint8, size int) func() // Prepares buffers, returns one iteration
+}
+
+// benchResult is one case at one size; field names are the JSON schema.
+type benchResult struct {
+	Name        string  `json:"name"`
+	Size        int     `json:"size"`
+	Iterations  int     `json:"iterations"`
+	NsPerOp     int64   `json:"nsPerOp"`
+	AllocsPerOp int64   `json:"allocsPerOp"`
+	BytesPerOp  int64   `json:"bytesPerOp"`
+	MPixPerSec  float64 `json:"mpixPerSec"`
+}
+
+// benchReport is the document written by -out and read by -baseline.
+type benchReport struct {
+	GoVersion string        `json:"goVersion"`
+	GOOS      string        `json:"goos"`
+	GOARCH    string        `json:"goarch"`
+	NumCPU    int           `json:"numCPU"`
+	Timestamp string        `json:"timestamp"`
+	Results   []benchResult `json:"results"`
+}
+
+func benchCases() []benchCase {
+	var cases []benchCase
+	for _, name := range []string{"blur", "sharpen", "edge", "emboss"} {
+		filter := name
+		cases = append(cases, benchCase{name: "filter/" + filter, maxSize: 8192, run: func(img []uint8, size int) func() {
+			dst := make([]uint8, len(img))
+			return func() { applyFilterInto(dst, img, size, size, filter) }
+		}})
+	}
+
+	kernels := []struct {
+		name    string
+		maxSize int
+		build   func() *convKernel
+	}{
+		{"kernel/gaussian-r5-separable", 8192, func() *convKernel { return benchGaussian(5) }},
+		{"kernel/gaussian-r25-separable", 4096, func() *convKernel { return benchGaussian(25) }},
+		{"kernel/box-9-sat", 8192, func() *convKernel { return benchDense(9, func(int) float64 { return 1 }) }},
+		{"kernel/dense-5-direct", 4096, func() *convKernel { return benchDense(5, func(i int) float64 { return float64(i%7) - 3 }) }},
+		{"kernel/dense-15-fft", 4096, func() *convKernel { return benchDense(15, func(i int) float64 { return float64(i%11) - 5 }) }},
+	}
+	for _, kc := range kernels {
+		kc := kc
+		cases = append(cases, benchCase{name: kc.name, maxSize: kc.maxSize, run: func(img []uint8, size int) func() {
+			k, dst := kc.build(), make([]uint8, len(img))
+			return func() { convolveImageInto(dst, img, size, size, k, convMethodAuto) }
+		}})
+	}
+
+	svds := []struct {
+		name    string
+		maxSize int
+		rank    int
+		method  string
+	}{
+		{"svd/randomized-r10", 2048, 10, svdMethodRandomized},
+		{"svd/randomized-r50", 2048, 50, svdMethodRandomized},
+		{"svd/full-r50", 512, 50, svdMethodFull},
+	}
+	for _, sc := range svds {
+		sc := sc
+		opts := defaultSVDOptions()
+		opts.Method = sc.method
+		cases = append(cases, benchCase{name: sc.name, maxSize: sc.maxSize, run: func(img []uint8, size int) func() {
+			dst := make([]uint8, len(img))
+			return func() { compressSVDInto(dst, img, int32(size), int32(size), int32(sc.rank), opts) }
+		}})
+
+		// The per-channel stages of compressSVD on their own: factorization and reconstruction
+		cases = append(cases, benchCase{name: "factor/" + strings.TrimPrefix(sc.name, "svd/"), maxSize: sc.maxSize, run: func(img []uint8, size int) func() {
+			plane := make([]float64, size*size)
+			for p := range plane {
+				plane[p] = float64(img[p*4])
+			}
+			m := mat.NewDense(size, size, plane)
+			return func() { factorChannel(m, sc.rank, opts) }
+		}})
+	}
+	cases = append(cases, benchCase{name: "reconstruct/r50", maxSize: 4096, run: func(img []uint8, size int) func() {
+		f := benchFactors(size, 50)
+		dst := make([]uint8, len(img))
+		return func() { reconstructChannelInto(dst, 0, f, 50) }
+	}})
+	return cases
+}
+
+// benchImage returns the reproducible size x size RGBA test image: smooth gradients
+// and waves (low rank, like photographs) plus seeded noise, with opaque alpha.
+func benchImage(size int) []uint8 {
+	rng := rand.New(rand.NewSource(int64(size)))
+	img := make([]uint8, size*size*4)
+	for y := 0; y < size; y++ {
+		for x := 0; x < size; x++ {
+			fx, fy := float64(x)/float64(size), float64(y)/float64(size)
+			base := 128 + 60*math.Sin(fx*23) + 40*math.Cos(fy*17) + 30*math.Sin((fx+fy)*41)
+			i := (y*size + x) * 4
+			for c := 0; c < 3; c++ {
+				v := base + float64(c-1)*25*fx + rng.NormFloat64()*8
+				img[i+c] = uint8(clampFloat64(v, 0, 255))
+			}
+			img[i+3] = 255
+		}
+	}
+	return img
+}
+
+func benchGaussian(radius int) *convKernel {
+	taps := make([]float64, 2*radius+1)
+	sigma := float64(radius) / 3
+	for i := range taps {
+		d := float64(i - radius)
+		taps[i] = math.Exp(-d * d / (2 * sigma * sigma))
+	}
+	k, _ := newSeparableKernel(taps, taps)
+	k.normalize()
+	return k
+}
+
+func benchDense(size int, weight func(i int) float64) *convKernel {
+	weights := make([]float64, size*size)
+	for i := range weights {
+		weights[i] = weight(i)
+	}
+	k, _ := newDenseKernel(size, size, weights)
+	k.normalize()
+	return k
+}
+
+// benchFactors returns seeded random rank-k factors of a size x size channel.
+func benchFactors(size, k int) *svdFactors {
+	rng := rand.New(rand.NewSource(int64(size)))
+	f := &svdFactors{rows: size, cols: size, k: k, u: make([]float64, size*k), s: make([]float64, k), v: make([]float64, size*k)}
+	for i := range f.u {
+		f.u[i], f.v[i] = rng.NormFloat64()/math.Sqrt(float64(size)), rng.NormFloat64()/math.Sqrt(float64(size))
+	}
+	for i := range f.s {
+		f.s[i] = 4000 / float64(i+1)
+	}
+	return f
+}
+
+// runBench implements the bench command.
+func runBench(args []string) int {
+	fs := flag.NewFlagSet("bench", flag.ExitOnError)
+	sizesFlag := fs.String("sizes", "", "comma-separated image sizes (default 256..8192)")
+	runFlag := fs.String("run", "", "regular expression selecting case names")
+	outFlag := fs.String("out", "", "write results as JSON to this file")
+	baselineFlag := fs.String("baseline", "", "compare against a JSON report written by -out")
+	thresholdFlag := fs.Float64("threshold", 0.10, "fail if a case is slower than the baseline by more than this fraction")
+	listFlag := fs.Bool("list", false, "list case names and exit")
+	testing.Init()
+	flag.CommandLine.VisitAll(func(f *flag.Flag) { fs.Var(f.Value, f.Name, f.Usage) }) // -test.benchtime etc.
+	fs.Parse(args)
+
+	sizes := defaultBenchSizes
+	if *sizesFlag != "" {
+		sizes = nil
+		for _, field := range strings.Split(*sizesFlag, ",") {
+			size, err := strconv.Atoi(strings.TrimSpace(field))
+			if err != nil || size <= 0 {
+				fmt.Fprintf(os.Stderr, "invalid size %q\n", field)
+				return 2
+			}
+			sizes = append(sizes, size)
+		}
+	}
+	var filter *regexp.Regexp
+	if *runFlag != "" {
+		var err error
+		if filter, err = regexp.Compile(*runFlag); err != nil {
+			fmt.Fprintf(os.Stderr, "invalid -run: %v\n", err)
+			return 2
+		}
+	}
+
+	var cases []benchCase
+	for _, c := range benchCases() {
+		if filter == nil || filter.MatchString(c.name) {
+			cases = append(cases, c)
+		}
+	}
+	if *listFlag {
+		for _, c := range cases {
+			fmt.Printf("%s (up to %d)\n", c.name, c.maxSize)
+		}
+		return 0
+	}
+
+	report := benchReport{GoVersion: runtime.Version(), GOOS: runtime.GOOS, GOARCH: runtime.GOARCH,
+		NumCPU: runtime.NumCPU(), Timestamp: time.Now().UTC().Format(time.RFC3339)}
+	fmt.Printf("%-32s %6s %10s %14s %12s %14s %10s\n", "case", "size", "iters", "ns/op", "allocs/op", "bytes/op", "MPix/s")
+	for _, size := range sizes {
+		img := benchImage(size)
+		for _, c := range cases {
+			if size > c.maxSize {
+				continue
+			}
+			iteration := c.run(img, size)
+			res := quietBenchmark(func(b *testing.B) {
+				b.ReportAllocs()
+				for i := 0; i < b.N; i++ {
+					iteration()
+				}
+			})
+			r := benchResult{Name: c.name, Size: size, Iterations: res.N, NsPerOp: res.NsPerOp(),
+				AllocsPerOp: res.AllocsPerOp(), BytesPerOp: res.AllocedBytesPerOp()}
+			if r.NsPerOp > 0 {
+				r.MPixPerSec = float64(size*size) / float64(r.NsPerOp) * 1e3
+			}
+			report.Results = append(report.Results, r)
+			fmt.Printf("%-32s %6d %10d %14d %12d %14d %10.1f\n", r.Name, r.Size, r.Iterations, r.NsPerOp, r.AllocsPerOp, r.BytesPerOp, r.MPixPerSec)
+		}
+	}
+
+	if *outFlag != "" {
+		data, _ := json.MarshalIndent(report, "", "  ")
+		if err := os.WriteFile(*outFlag, append(data, '\n'), 0o644); err != nil {
+			fmt.Fprintf(os.Stderr, "writing %s: %v\n", *outFlag, err)
+			return 1
+		}
+	}
+	if *baselineFlag != "" {
+		return compareBaseline(report, *baselineFlag, *thresholdFlag)
+	}
+	return 0
+}
+
+// quietBenchmark runs fn with the kernels' progress logging sent to /dev/null.
+func quietBenchmark(fn func(b *testing.B)) testing.BenchmarkResult {
+	stdout := os.Stdout
+	if devNull, err := os.OpenFile(os.DevNull, os.O_WRONLY, 0); err == nil {
+		os.Stdout = devNull
+		defer devNull.Close()
+	}
+	defer func() { os.Stdout = stdout }()
+	return testing.Benchmark(fn)
+}
+
+// compareBaseline prints the change in ns/op of every case also present in the baseline
+// and returns 1 if any regressed by more than threshold.
+func compareBaseline(report benchReport, path string, threshold float64) int {
+	data, err := os.ReadFile(path)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "reading baseline: %v\n", err)
+		return 1
+	}
+	var baseline benchReport
+	if err := json.Unmarshal(data, &baseline); err != nil {
+		fmt.Fprintf(os.Stderr, "parsing baseline: %v\n", err)
+		return 1
+	}
+	key := func(r benchResult) string { return fmt.Sprintf("%s@%d", r.Name, r.Size) }
+	base := map[string]benchResult{}
+	for _, r := range baseline.Results {
+		base[key(r)] = r
+	}
+
+	fmt.Printf("\nAgainst %s (%s, %s/%s, %d CPUs):\n", path, baseline.GoVersion, baseline.GOOS, baseline.GOARCH, baseline.NumCPU)
+	var regressions []string
+	for _, r := range report.Results {
+		b, ok := base[key(r)]
+		if !ok || b.NsPerOp <= 0 {
+			continue
+		}
+		delta := float64(r.NsPerOp)/float64(b.NsPerOp) - 1
+		fmt.Printf("%-40s %+7.1f%% ns/op, allocs %d -> %d\n", key(r), 100*delta, b.AllocsPerOp, r.AllocsPerOp)
+		if delta > threshold {
+			regressions = append(regressions, key(r))
+		}
+	}
+	if len(regressions) > 0 {
+		sort.Strings(regressions)
+		fmt.Printf("%d regression(s) beyond %.0f%%: %s\n", len(regressions), 100*threshold, strings.Join(regressions, ", "))
+		return 1
+	}
+	return 0
+}
@@ -0,0 +1,131 @@
+package main
+
+import (
+	"gonum.org/v1/gonum/mat"
+)
+
+// Block-wise SVD compression.
+//
+// Instead of factoring each H x W channel at once, the image is cut into
+// blockSize x blockSize tiles (smaller at the right and bottom edges) and every
+// tile of every channel is factored independently. Each block keeps the fewest
+// singular triplets whose squared singular values retain the requested fraction
+// of the block's energy, capped by the global rank. Flat regions therefore cost
+// one or two triplets while detailed ones get as many as they need.
+
+const (
+	minSVDBlockSize     = 8
+	maxSVDBlockSize     = 512
+	defaultSVDEnergy    = 0.99 // Fraction of each block's energy (sum of σ²) to retain
+	svdBlockChannelSize = 4    // RGBA
+)
+
+// blockSVDStats summarizes a block-wise compression run.
+type blockSVDStats struct {
+	Blocks       int // Blocks factored (over all compressed channels)
+	TotalRank    int // Sum of the ranks kept across those blocks
+	Coefficients int // Stored values: Σ k·(blockRows + blockCols + 1)
+}
+
+// blockRankForEnergy returns the smallest k <= maxRank whose leading singular values
+// retain at least energy of the total σ² of s. A zero block needs no triplets.
+func blockRankForEnergy(s []float64, energy float64, maxRank int) int {
+	total := 0.0
+	for _, v := range s {
+		total += v * v
+	}
+	if total == 0 {
+		return 0
+	}
+	kept := 0.0
+	for k, v := range s {
+		if k >= maxRank {
+			return maxRank
+		}
+		kept += v * v
+		if kept >= energy*total {
+			return k + 1
+		}
+	}
+	return min(len(s), maxRank)
+}
+
+// compressSVDBlocksInto compresses the channels selected by opts.Channels block by
+// block into result and copies the other channels from data. rank caps the rank of
+// every block; opts.BlockSize and opts.Energy control the tiling and rank choice.
+func compressSVDBlocksInto(result, data []uint8, width, height, rank int, opts svdOptions) blockSVDStats {
+	copy(result, data)
+
+	bs := opts.BlockSize
+	blocksX := (width + bs - 1) / bs
+	blocksY := (height + bs - 1) / bs
+
+	var channels []int
+	for c, selected := range opts.Channels {
+		if selected {
+			channels = append(channels, c)
+		}
+	}
+
+	// Per-block stats, summed after the parallel loop so workers never share counters
+	ranks := make([]int, blocksX*blocksY*len(channels))
+
+	parallelItems(len(ranks), func(item int) {
+		c := channels[item%len(channels)]
+		block := item / len(channels)
+		x0, y0 := (block%blocksX)*bs, (block/blocksX)*bs
+		bw, bh := min(bs, width-x0), min(bs, height-y0)
+
+		// Gather the block straight into the matrix backing slice
+		values := make([]float64, bh*bw)
+		for y := 0; y < bh; y++ {
+			row := ((y0+y)*width + x0) * svdBlockChannelSize
+			for x := 0; x < bw; x++ {
+				values[y*bw+x] = float64(data[row+x*svdBlockChannelSize+c])
+			}
+		}
+
+		var svd mat.SVD
+		if !svd.Factorize(mat.NewDense(bh, bw, values), mat.SVDThin) {
+			return // Leave the block's original pixels in place
+		}
+		s := svd.Values(nil)
+		k := blockRankForEnergy(s, opts.Energy, rank)
+		ranks[item] = k
+
+		var u, v mat.Dense
+		svd.UTo(&u) // bh x min(bh, bw)
+		svd.VTo(&v) // bw x min(bh, bw)
+		uRaw, vRaw := u.RawMatrix(), v.RawMatrix()
+
+		// Fold Σ into U once, then write each pixel as a k-term dot product
+		us := make([]float64, bh*k)
+		for y := 0; y < bh; y++ {
+			for i := 0; i < k; i++ {
+				us[y*k+i] = uRaw.Data[y*uRaw.Stride+i] * s[i]
+			}
+		}
+		for y := 0; y < bh; y++ {
+			urow := us[y*k : (y+1)*k]
+			row := ((y0+y)*width + x0) * svdBlockChannelSize
+			for x := 0; x < bw; x++ {
+				vrow := vRaw.Data[x*vRaw.Stride : x*vRaw.Stride+k]
+				sum := 0.0
+				for i, uv := range urow {
+					sum += uv * vrow[i]
+				}
+				result[row+x*svdBlockChannelSize+c] = uint8(clampFloat64(sum+0.5, 0, 255))
+			}
+		}
+	})
+
+	stats := blockSVDStats{Blocks: len(ranks)}
+	for item, k := range ranks {
+		block := item / len(channels)
+		bw := min(bs, width-(block%blocksX)*bs)
+		bh := min(bs, height-(block/blocksX)*bs)
+		stats.TotalRank += k
+		stats.Coefficients += k * (bw + bh + 1)
+	}
+	return stats
+}
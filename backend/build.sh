@@ -1,7 +1,21 @@
 #!/bin/bash
 
-# Compile Go code (main.go) in the current directory to WebAssembly
-GOOS=js GOARCH=wasm go build -o ../frontend/public/main.wasm main.go
+# Compile the Go package in the current directory to WebAssembly. -s -w drop the
+# symbol table and DWARF data, which the browser never uses.
+GOOS=js GOARCH=wasm go build -trimpath -ldflags="-s -w" -o ../frontend/public/main.wasm .
+
+# Shrink the module further with binaryen when it is installed
+if command -v wasm-opt >/dev/null 2>&1; then
+  wasm-opt -Oz --enable-bulk-memory --enable-sign-ext --enable-nontrapping-float-to-int \
+    ../frontend/public/main.wasm -o ../frontend/public/main.wasm
+fi
+
+# Assemble the optional SIMD128 kernels; the engine falls back to scalar loops without them
+if command -v wat2wasm >/dev/null 2>&1; then
+  wat2wasm simd/kernels.wat -o ../frontend/public/simd_kernels.wasm
+else
+  echo "wat2wasm not found (install wabt); skipping SIMD kernels"
+fi
 
 # Find the wasm_exec.js file
 WASM_EXEC_PATH=$(go env GOROOT)/misc/wasm/wasm_exec.js
@@ -0,0 +1,23 @@
+package main
+
+// Cooperative cancellation of the exported call in progress.
+//
+// A call cannot be interrupted from outside, so the host installs a poll function
+// (setCancelPoll) that reports whether the call it is running has been superseded.
+// parallelRows and parallelItems consult it before every chunk and item, and the SVD
+// paths between channels, so a cancelled call stops within one chunk of work. The
+// output of a cancelled call is undefined and the host must discard it; persistent
+// state (the SVD factor cache) is only updated from work that ran to completion.
+
+// cancelPoll is nil when the running call cannot be cancelled.
+var cancelPoll func() bool
+
+// setCancelPoll installs poll for the calls that follow; nil disables cancellation.
+func setCancelPoll(poll func() bool) {
+	cancelPoll = poll
+}
+
+// cancelled reports whether the running call should stop.
+func cancelled() bool {
+	return cancelPoll != nil && cancelPoll()
+}
@@ -0,0 +1,30 @@
+//go:build js && wasm
+// +build js,wasm
+
+package main
+
+import "syscall/js"
+
+// JavaScript binding for cooperative cancellation (see cancel.go).
+
+// setCancelTokenWrapper expects (flag: Int32Array | null, id: number). Until the next
+// call, the running call counts as cancelled once flag[0] equals id; the host writes
+// the id of a superseded request into the flag (a SharedArrayBuffer view) from another
+// thread. A null flag disables cancellation.
+func setCancelTokenWrapper(this js.Value, args []js.Value) interface{} {
+	if len(args) < 1 || args[0].IsNull() || args[0].IsUndefined() {
+		setCancelPoll(nil)
+		return nil
+	}
+	if len(args) < 2 || args[0].Type() != js.TypeObject || args[1].Type() != js.TypeNumber {
+		return createError("Invalid arguments for setCancelToken: expected (flag: Int32Array | null, id: number)")
+	}
+	flag, id := args[0], args[1].Int()
+	stopped := false
+	setCancelPoll(func() bool {
+		// Once cancelled, stay cancelled without asking JavaScript again
+		stopped = stopped || flag.Index(0).Int() == id
+		return stopped
+	})
+	return nil
+}
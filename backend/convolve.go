@@ -0,0 +1,231 @@
+package main
+
+import "fmt"
+
+// Fixed-point convolution engine used by applyFilter.
+//
+// Kernels are precomputed as integer weights sharing one positive divisor, so every
+// tap is an integer multiply-add. The final rounding reproduces the float64
+// reference (uint8(clamp(int(sum+0.5), 0, 255))) bit for bit: for sum <= 0 the
+// result is 0, otherwise it is floor((2*sum + divisor) / (2*divisor)) computed with
+// a precomputed 32-bit reciprocal.
+
+// intKernel is a 3x3 convolution kernel in fixed-point form.
+type intKernel struct {
+	weights   [9]int32 // Row-major 3x3 weights
+	divisor   int32    // Common positive divisor of all weights
+	recip     uint64   // ceil(2^32 / (2*divisor)), exact for every reachable sum
+	separable bool     // weights[r*3+c] == colTaps[r] * rowTaps[c]
+	rowTaps   [3]int32 // Horizontal 1D factor (separable kernels only)
+	colTaps   [3]int32 // Vertical 1D factor (separable kernels only)
+	simdOK    bool     // simdFilter3x3 reproduces this kernel exactly (see simdParams)
+	simdMul   uint16   // 16-bit rounding reciprocal for simdFilter3x3, 0 for divisor 1
+}
+
+// newIntKernel builds a non-separable fixed-point kernel.
+func newIntKernel(weights [9]int32, divisor int32) *intKernel {
+	k := &intKernel{
+		weights: weights,
+		divisor: divisor,
+		recip:   ((1 << 32) + uint64(2*divisor) - 1) / uint64(2*divisor),
+	}
+	k.simdMul, k.simdOK = simdParams(weights, divisor)
+	return k
+}
+
+// newSeparableIntKernel builds a kernel from its vertical and horizontal 1D factors.
+func newSeparableIntKernel(colTaps, rowTaps [3]int32, divisor int32) *intKernel {
+	var weights [9]int32
+	for r := 0; r < 3; r++ {
+		for c := 0; c < 3; c++ {
+			weights[r*3+c] = colTaps[r] * rowTaps[c]
+		}
+	}
+	k := newIntKernel(weights, divisor)
+	k.separable = true
+	k.rowTaps = rowTaps
+	k.colTaps = colTaps
+	return k
+}
+
+// builtinKernels holds the precomputed kernels for the filter names exposed to JavaScript.
+var builtinKernels = map[string]*intKernel{
+	"blur": newSeparableIntKernel([3]int32{1, 1, 1}, [3]int32{1, 1, 1}, 9),
+	"sharpen": newIntKernel([9]int32{
+		0, -1, 0,
+		-1, 5, -1,
+		0, -1, 0,
+	}, 1),
+	"edge": newIntKernel([9]int32{
+		-1, -1, -1,
+		-1, 8, -1,
+		-1, -1, -1,
+	}, 1),
+	"emboss": newIntKernel([9]int32{
+		-2, -1, 0,
+		-1, 1, 1,
+		0, 1, 2,
+	}, 1),
+}
+
+// toByte rounds sum/divisor half up and clamps it to [0, 255].
+func (k *intKernel) toByte(sum int32) uint8 {
+	if sum <= 0 {
+		return 0
+	}
+	if k.divisor == 1 {
+		if sum > 255 {
+			return 255
+		}
+		return uint8(sum)
+	}
+	v := (uint64(2*sum+k.divisor) * k.recip) >> 32
+	if v > 255 {
+		return 255
+	}
+	return uint8(v)
+}
+
+// convolveRows applies k to the RGB channels of rows [startY, endY) of src and
+// writes them to dst, copying alpha unchanged. Borders replicate edge pixels.
+func convolveRows(dst, src []uint8, width, height, startY, endY int, k *intKernel) {
+	if simdFilter3x3 != nil && k.simdOK && width >= simdMinWidth {
+		convolveRowsSIMD(dst, src, width, height, startY, endY, k)
+		return
+	}
+	if k.separable {
+		convolveSeparableRows(dst, src, width, height, startY, endY, k)
+		return
+	}
+
+	w := &k.weights
+	rowStride := width * 4
+	for y := startY; y < endY; y++ {
+		if y == 0 || y == height-1 || width < 3 {
+			// Thin border strip: full rows at the top and bottom edge
+			for x := 0; x < width; x++ {
+				convolvePixelClamped(dst, src, width, height, x, y, k)
+			}
+			continue
+		}
+
+		convolvePixelClamped(dst, src, width, height, 0, y, k)
+
+		// Interior: all 9 taps are in bounds, so no coordinate clamping is needed
+		up := src[(y-1)*rowStride : y*rowStride]
+		mid := src[y*rowStride : (y+1)*rowStride]
+		down := src[(y+1)*rowStride : (y+2)*rowStride]
+		out := dst[y*rowStride : (y+1)*rowStride]
+		for i := 4; i < rowStride-4; i += 4 {
+			for c := i; c < i+3; c++ {
+				sum := w[0]*int32(up[c-4]) + w[1]*int32(up[c]) + w[2]*int32(up[c+4]) +
+					w[3]*int32(mid[c-4]) + w[4]*int32(mid[c]) + w[5]*int32(mid[c+4]) +
+					w[6]*int32(down[c-4]) + w[7]*int32(down[c]) + w[8]*int32(down[c+4])
+				out[c] = k.toByte(sum)
+			}
+			out[i+3] = mid[i+3]
+		}
+
+		convolvePixelClamped(dst, src, width, height, width-1, y, k)
+	}
+}
+
+// convolveSeparableRows runs k as a horizontal pass into an int32 scratch buffer
+// (covering the chunk plus one halo row on each side) followed by a vertical pass.
+func convolveSeparableRows(dst, src []uint8, width, height, startY, endY int, k *intKernel) {
+	haloStart := clamp(startY-1, 0, height-1)
+	haloEnd := clamp(endY+1, 0, height)
+	rowStride := width * 4
+	scratchStride := width * 3
+	scratch := make([]int32, (haloEnd-haloStart)*scratchStride)
+	r0, r1, r2 := k.rowTaps[0], k.rowTaps[1], k.rowTaps[2]
+
+	// Horizontal pass; only the first and last pixel of a row need clamped taps
+	for y := haloStart; y < haloEnd; y++ {
+		row := src[y*rowStride : (y+1)*rowStride]
+		h := scratch[(y-haloStart)*scratchStride : (y-haloStart+1)*scratchStride]
+		last := (width - 1) * 4
+		for c := 0; c < 3; c++ {
+			h[c] = r0*int32(row[c]) + r1*int32(row[c]) + r2*int32(row[min(4, last)+c])
+		}
+		for i, j := 4, 3; i < last; i, j = i+4, j+3 {
+			for c := 0; c < 3; c++ {
+				h[j+c] = r0*int32(row[i+c-4]) + r1*int32(row[i+c]) + r2*int32(row[i+c+4])
+			}
+		}
+		if width > 1 {
+			for c := 0; c < 3; c++ {
+				h[(width-1)*3+c] = r0*int32(row[last-4+c]) + r1*int32(row[last+c]) + r2*int32(row[last+c])
+			}
+		}
+	}
+
+	// Vertical pass, clamping halo rows at the image edges
+	c0, c1, c2 := k.colTaps[0], k.colTaps[1], k.colTaps[2]
+	for y := startY; y < endY; y++ {
+		up := scratch[(clamp(y-1, 0, height-1)-haloStart)*scratchStride:][:scratchStride]
+		mid := scratch[(y-haloStart)*scratchStride:][:scratchStride]
+		down := scratch[(clamp(y+1, 0, height-1)-haloStart)*scratchStride:][:scratchStride]
+		in := src[y*rowStride : (y+1)*rowStride]
+		out := dst[y*rowStride : (y+1)*rowStride]
+		for i, j := 0, 0; i < rowStride; i, j = i+4, j+3 {
+			for c := 0; c < 3; c++ {
+				out[i+c] = k.toByte(c0*up[j+c] + c1*mid[j+c] + c2*down[j+c])
+			}
+			out[i+3] = in[i+3]
+		}
+	}
+}
+
+// convolvePixelClamped applies k at (x, y) with clamped sample coordinates.
+// Used only for the one-pixel border strip around the interior.
+func convolvePixelClamped(dst, src []uint8, width, height, x, y int, k *intKernel) {
+	idx := (y*width + x) * 4
+	for c := 0; c < 3; c++ {
+		var sum int32
+		for fy := 0; fy < 3; fy++ {
+			sy := clamp(y+fy-1, 0, height-1)
+			for fx := 0; fx < 3; fx++ {
+				sx := clamp(x+fx-1, 0, width-1)
+				sum += k.weights[fy*3+fx] * int32(src[(sy*width+sx)*4+c])
+			}
+		}
+		dst[idx+c] = k.toByte(sum)
+	}
+	dst[idx+3] = src[idx+3]
+}
+
+// applyFilter applies a convolution filter to image data (internal logic).
+// Takes raw pixel data, dimensions, and filter type. Returns processed pixel data.
+func applyFilter(srcData []uint8, width, height int, filterType string) []uint8 {
+	// Create result data slice, initialized to zeros
+	resultData := make([]uint8, len(srcData))
+	applyFilterInto(resultData, srcData, width, height, filterType)
+	return resultData
+}
+
+// applyFilterInto is applyFilter writing into a caller-owned buffer of len(srcData) bytes.
+func applyFilterInto(resultData, srcData []uint8, width, height int, filterType string) {
+	// Select the precomputed fixed-point kernel (see convolve.go)
+	kernel, ok := builtinKernels[filterType]
+	if !ok {
+		fmt.Printf("Unknown filter type '%s', returning original data\n", filterType)
+		// If no valid filter is specified, return a copy of the original image data
+		copy(resultData, srcData)
+		return
+	}
+	if width <= 0 || height <= 0 || len(srcData) < width*height*4 {
+		fmt.Printf("Image data too short for %dx%d, returning original data\n", width, height)
+		copy(resultData, srcData)
+		return
+	}
+
+	logf("Applying filter '%s'...\n", filterType)
+
+	// Process image in parallel chunks (rows)
+	parallelRows(height, func(startY, endY int) {
+		convolveRows(resultData, srcData, width, height, startY, endY, kernel)
+	})
+
+	logln("Filter application complete.")
+}
@@ -0,0 +1,77 @@
+package main
+
+import (
+	"math/rand"
+	"testing"
+)
+
+// randomImage returns a width x height RGBA image of uniformly random bytes.
+func randomImage(width, height int, seed int64) []uint8 {
+	data := make([]uint8, width*height*4)
+	rand.New(rand.NewSource(seed)).Read(data)
+	return data
+}
+
+// referenceToByte is the float64 rounding that intKernel.toByte reproduces.
+func referenceToByte(sum, divisor int32) uint8 {
+	return uint8(clamp(int(float64(sum)/float64(divisor)+0.5), 0, 255))
+}
+
+// referenceConvolve applies k to every pixel with clamped taps and a float64 division.
+func referenceConvolve(src []uint8, width, height int, k *intKernel) []uint8 {
+	dst := make([]uint8, len(src))
+	for y := 0; y < height; y++ {
+		for x := 0; x < width; x++ {
+			idx := (y*width + x) * 4
+			for c := 0; c < 3; c++ {
+				var sum int32
+				for fy := 0; fy < 3; fy++ {
+					for fx := 0; fx < 3; fx++ {
+						sx, sy := clamp(x+fx-1, 0, width-1), clamp(y+fy-1, 0, height-1)
+						sum += k.weights[fy*3+fx] * int32(src[(sy*width+sx)*4+c])
+					}
+				}
+				dst[idx+c] = referenceToByte(sum, k.divisor)
+			}
+			dst[idx+3] = src[idx+3]
+		}
+	}
+	return dst
+}
+
+func TestIntKernelToByte(t *testing.T) {
+	for name, k := range builtinKernels {
+		// Every reachable sum: all negative taps at 255 down to all positive taps at 255
+		var lo, hi int32
+		for _, w := range k.weights {
+			if w < 0 {
+				lo += 255 * w
+			} else {
+				hi += 255 * w
+			}
+		}
+		for sum := lo; sum <= hi; sum++ {
+			if got, want := k.toByte(sum), referenceToByte(sum, k.divisor); got != want {
+				t.Fatalf("%s: toByte(%d) = %d, want %d", name, sum, got, want)
+			}
+		}
+	}
+}
+
+func TestConvolveRowsMatchesReference(t *testing.T) {
+	sizes := [][2]int{{1, 1}, {2, 3}, {3, 1}, {7, 5}, {64, CHUNK_SIZE + 3}}
+	for name, k := range builtinKernels {
+		for _, size := range sizes {
+			width, height := size[0], size[1]
+			src := randomImage(width, height, int64(width*height))
+			got := applyFilter(src, width, height, name)
+			want := referenceConvolve(src, width, height, k)
+			for i := range want {
+				if got[i] != want[i] {
+					t.Fatalf("%s %dx%d: byte %d (pixel %d, channel %d) = %d, want %d",
+						name, width, height, i, i/4, i%4, got[i], want[i])
+				}
+			}
+		}
+	}
+}
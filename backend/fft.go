@@ -0,0 +1,176 @@
+package main
+
+import (
+	"math"
+	"sync"
+)
+
+// FFT-based convolution for large dense kernels.
+//
+// The image is processed in square tiles with the overlap-save method: each
+// fftTileSize x fftTileSize input tile (including a halo of kernel radius on
+// every side, edge-replicated at the image borders) is transformed, multiplied by
+// the kernel spectrum and transformed back. The circular wraparound only touches
+// the halo, and every tile yields (tile - kernel + 1)² valid output pixels.
+// R and G are packed into the real and imaginary parts of one complex transform,
+// which is valid because the kernel is real.
+
+const (
+	fftMinTileSize = 128  // Smallest tile edge; keeps per-tile overhead low for mid-sized kernels
+	fftMaxTileSize = 2048 // Largest tile edge: 64 MiB per complex128 plane, so 128 MiB of scratch per worker plus the shared kernel spectrum
+)
+
+// fftPlan holds the bit-reversal permutation and twiddle factors for a power-of-two size.
+type fftPlan struct {
+	n       int
+	rev     []int
+	twiddle []complex128 // exp(-2πik/n) for k in [0, n/2)
+}
+
+// newFFTPlan precomputes an in-place radix-2 transform of size n (a power of two).
+func newFFTPlan(n int) *fftPlan {
+	bits := 0
+	for 1<<bits < n {
+		bits++
+	}
+	rev := make([]int, n)
+	for i := range rev {
+		r := 0
+		for b := 0; b < bits; b++ {
+			if i&(1<<b) != 0 {
+				r |= 1 << (bits - 1 - b)
+			}
+		}
+		rev[i] = r
+	}
+	twiddle := make([]complex128, n/2)
+	for k := range twiddle {
+		angle := -2 * math.Pi * float64(k) / float64(n)
+		twiddle[k] = complex(math.Cos(angle), math.Sin(angle))
+	}
+	return &fftPlan{n: n, rev: rev, twiddle: twiddle}
+}
+
+// transform runs an unscaled forward (or inverse, with conjugated twiddles) FFT on a in place.
+func (p *fftPlan) transform(a []complex128, inverse bool) {
+	n := p.n
+	for i := 0; i < n; i++ {
+		if j := p.rev[i]; i < j {
+			a[i], a[j] = a[j], a[i]
+		}
+	}
+	for size := 2; size <= n; size <<= 1 {
+		half := size / 2
+		step := n / size
+		for start := 0; start < n; start += size {
+			for k := 0; k < half; k++ {
+				w := p.twiddle[k*step]
+				if inverse {
+					w = complex(real(w), -imag(w))
+				}
+				u := a[start+k]
+				v := a[start+k+half] * w
+				a[start+k] = u + v
+				a[start+k+half] = u - v
+			}
+		}
+	}
+}
+
+// transform2D runs the FFT over every row and then every column of an n x n
+// row-major buffer. column is scratch of length n.
+func (p *fftPlan) transform2D(a, column []complex128, inverse bool) {
+	n := p.n
+	for r := 0; r < n; r++ {
+		p.transform(a[r*n:(r+1)*n], inverse)
+	}
+	for c := 0; c < n; c++ {
+		for r := 0; r < n; r++ {
+			column[r] = a[r*n+c]
+		}
+		p.transform(column, inverse)
+		for r := 0; r < n; r++ {
+			a[r*n+c] = column[r]
+		}
+	}
+}
+
+// fftTileSizeFor returns the tile edge for a kernel: the smallest power of two at
+// least four times the kernel extent, so that no more than half of each tile is halo.
+func fftTileSizeFor(k *convKernel) int {
+	extent := max(k.width, k.height) - 1
+	n := fftMinTileSize
+	for n < 4*extent && n < fftMaxTileSize {
+		n <<= 1
+	}
+	return n
+}
+
+// convolveFFT applies k to the RGB channels of src with tiled overlap-save FFT
+// convolution and copies alpha unchanged.
+func convolveFFT(dst, src []uint8, width, height int, k *convKernel) {
+	n := fftTileSizeFor(k)
+	plan := newFFTPlan(n)
+	rx, ry := k.width/2, k.height/2
+	validW, validH := n-(k.width-1), n-(k.height-1)
+
+	// Kernel spectrum: g[(-fy) mod n][(-fx) mod n] = k[fy][fx] turns circular
+	// convolution into the correlation sum used by the direct path.
+	spectrum := make([]complex128, n*n)
+	for fy := 0; fy < k.height; fy++ {
+		for fx := 0; fx < k.width; fx++ {
+			spectrum[((n-fy)%n)*n+(n-fx)%n] = complex(k.weights[fy*k.width+fx], 0)
+		}
+	}
+	plan.transform2D(spectrum, make([]complex128, n), false)
+	scale := 1 / float64(n*n)
+
+	tilesX := (width + validW - 1) / validW
+	tilesY := (height + validH - 1) / validH
+
+	// Per-worker scratch: two n x n complex tiles plus one column
+	type fftScratch struct{ rg, b, column []complex128 }
+	scratchPool := sync.Pool{New: func() any {
+		return &fftScratch{rg: make([]complex128, n*n), b: make([]complex128, n*n), column: make([]complex128, n)}
+	}}
+
+	parallelItems(tilesX*tilesY, func(tile int) {
+		scratch := scratchPool.Get().(*fftScratch)
+		defer scratchPool.Put(scratch)
+		rg, b, column := scratch.rg, scratch.b, scratch.column
+
+		originX := (tile % tilesX) * validW
+		originY := (tile / tilesX) * validH
+
+		// Gather the tile with its halo, replicating edge pixels
+		for i := 0; i < n; i++ {
+			sy := clamp(originY-ry+i, 0, height-1)
+			row := src[sy*width*4 : (sy+1)*width*4]
+			for j := 0; j < n; j++ {
+				idx := clamp(originX-rx+j, 0, width-1) * 4
+				rg[i*n+j] = complex(float64(row[idx]), float64(row[idx+1]))
+				b[i*n+j] = complex(float64(row[idx+2]), 0)
+			}
+		}
+
+		for _, buf := range [][]complex128{rg, b} {
+			plan.transform2D(buf, column, false)
+			for i, s := range spectrum {
+				buf[i] *= s
+			}
+			plan.transform2D(buf, column, true)
+		}
+
+		// Scatter the valid region
+		for i := 0; i < validH && originY+i < height; i++ {
+			y := originY + i
+			for j := 0; j < validW && originX+j < width; j++ {
+				idx := (y*width + originX + j) * 4
+				dst[idx] = floatToByte(real(rg[i*n+j]) * scale)
+				dst[idx+1] = floatToByte(imag(rg[i*n+j]) * scale)
+				dst[idx+2] = floatToByte(real(b[i*n+j]) * scale)
+				dst[idx+3] = src[idx+3]
+			}
+		}
+	})
+}
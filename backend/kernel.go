@@ -0,0 +1,434 @@
+package main
+
+import (
+	"errors"
+	"fmt"
+	"math"
+)
+
+// Convolution methods for user-supplied kernels (applyKernel).
+const (
+	convMethodAuto      = "auto"      // Pick from kernel size and structure (see selectConvMethod)
+	convMethodDirect    = "direct"    // Full 2D tap loop, O(w*h) per pixel
+	convMethodSeparable = "separable" // Horizontal then vertical 1D pass, O(w+h) per pixel
+	convMethodSAT       = "sat"       // Summed-area table, O(1) per pixel, box kernels only
+	convMethodFFT       = "fft"       // Tiled overlap-save FFT, O(log tile) per pixel
+)
+
+const (
+	maxKernelDimension   = 511  // Largest accepted kernel width/height (radius 255)
+	satMinKernelSize     = 7    // Box kernels at least this wide use a summed-area table
+	fftMinKernelTaps     = 225  // Dense kernels with at least this many taps (15x15) use the FFT
+	separableRelativeTol = 1e-9 // Rank-1 check tolerance, relative to the largest weight
+)
+
+// convMethodTolerance is how far, per channel byte, the separable, SAT and FFT
+// methods may differ from the direct one at the same kernel. All of them round the
+// same sum, but accumulate it in a different order (and the separable passes in
+// float32), so a sum within rounding error of a .5 boundary can round either way.
+// Alpha is always copied exactly.
+const convMethodTolerance = 1
+
+// convKernel is an arbitrary convolution kernel with odd dimensions, anchored at
+// its center tap. Samples outside the image replicate the nearest edge pixel.
+type convKernel struct {
+	width, height int       // Odd dimensions
+	weights       []float64 // Row-major width*height weights
+	row, col      []float64 // 1D factors with weights = col ⊗ row; nil if not separable
+}
+
+// newDenseKernel builds a kernel from row-major weights and detects whether it is separable.
+func newDenseKernel(width, height int, weights []float64) (*convKernel, error) {
+	if err := validateKernelDims(width, height); err != nil {
+		return nil, err
+	}
+	if len(weights) != width*height {
+		return nil, fmt.Errorf("kernel has %d weights, expected %dx%d = %d", len(weights), width, height, width*height)
+	}
+	k := &convKernel{width: width, height: height, weights: weights}
+	k.col, k.row = factorSeparable(width, height, weights)
+	return k, nil
+}
+
+// newSeparableKernel builds a kernel from a horizontal (1xN) and vertical (Nx1) factor.
+func newSeparableKernel(row, col []float64) (*convKernel, error) {
+	if err := validateKernelDims(len(row), len(col)); err != nil {
+		return nil, err
+	}
+	weights := make([]float64, len(row)*len(col))
+	for r, cv := range col {
+		for c, rv := range row {
+			weights[r*len(row)+c] = cv * rv
+		}
+	}
+	return &convKernel{width: len(row), height: len(col), weights: weights, row: row, col: col}, nil
+}
+
+// validateKernelDims checks that a kernel has odd, bounded dimensions.
+func validateKernelDims(width, height int) error {
+	if width <= 0 || height <= 0 || width%2 == 0 || height%2 == 0 {
+		return fmt.Errorf("kernel dimensions must be odd and positive, got %dx%d", width, height)
+	}
+	if width > maxKernelDimension || height > maxKernelDimension {
+		return fmt.Errorf("kernel dimensions %dx%d exceed the maximum of %d", width, height, maxKernelDimension)
+	}
+	return nil
+}
+
+// normalize scales the kernel so its weights sum to 1. Zero-sum kernels
+// (edge detectors) are left unchanged.
+func (k *convKernel) normalize() {
+	sum := 0.0
+	for _, w := range k.weights {
+		sum += w
+	}
+	if sum == 0 {
+		return
+	}
+	for i := range k.weights {
+		k.weights[i] /= sum
+	}
+	if k.row != nil {
+		// Fold the whole scale into the vertical factor
+		for i := range k.col {
+			k.col[i] /= sum
+		}
+	}
+}
+
+// boxWeight reports whether all weights are identical (a box kernel) and returns that weight.
+func (k *convKernel) boxWeight() (float64, bool) {
+	for _, w := range k.weights {
+		if w != k.weights[0] {
+			return 0, false
+		}
+	}
+	return k.weights[0], true
+}
+
+// factorSeparable returns col and row with weights = col ⊗ row when the kernel has rank 1,
+// or nil slices otherwise. The pivot is the largest-magnitude weight.
+func factorSeparable(width, height int, weights []float64) ([]float64, []float64) {
+	pivot := 0
+	for i, w := range weights {
+		if math.Abs(w) > math.Abs(weights[pivot]) {
+			pivot = i
+		}
+	}
+	p := weights[pivot]
+	if p == 0 {
+		return nil, nil
+	}
+	pr, pc := pivot/width, pivot%width
+
+	col := make([]float64, height)
+	for r := 0; r < height; r++ {
+		col[r] = weights[r*width+pc]
+	}
+	row := make([]float64, width)
+	for c := 0; c < width; c++ {
+		row[c] = weights[pr*width+c] / p
+	}
+
+	tol := separableRelativeTol * math.Abs(p)
+	for r := 0; r < height; r++ {
+		for c := 0; c < width; c++ {
+			if math.Abs(col[r]*row[c]-weights[r*width+c]) > tol {
+				return nil, nil
+			}
+		}
+	}
+	return col, row
+}
+
+// selectConvMethod picks the cheapest algorithm for k:
+// box kernels of width >= satMinKernelSize use a summed-area table, other separable
+// kernels use two 1D passes, large dense kernels use the FFT and the rest run directly.
+func selectConvMethod(k *convKernel) string {
+	if k.width*k.height == 1 {
+		return convMethodDirect
+	}
+	if _, ok := k.boxWeight(); ok && min(k.width, k.height) >= satMinKernelSize {
+		return convMethodSAT
+	}
+	if k.row != nil {
+		return convMethodSeparable
+	}
+	if k.width*k.height >= fftMinKernelTaps {
+		return convMethodFFT
+	}
+	return convMethodDirect
+}
+
+// convolveImage applies k to the RGB channels of an RGBA image (alpha is copied)
+// with the requested method, resolving convMethodAuto via selectConvMethod.
+// It returns the result and the method actually used.
+func convolveImage(src []uint8, width, height int, k *convKernel, method string) ([]uint8, string, error) {
+	dst := make([]uint8, len(src))
+	used, err := convolveImageInto(dst, src, width, height, k, method)
+	if err != nil {
+		return nil, "", err
+	}
+	return dst, used, nil
+}
+
+// convolveImageInto is convolveImage writing into a caller-owned buffer of len(src) bytes.
+func convolveImageInto(dst, src []uint8, width, height int, k *convKernel, method string) (string, error) {
+	if width <= 0 || height <= 0 || len(src) < width*height*4 {
+		return "", fmt.Errorf("image data too short for %dx%d", width, height)
+	}
+	if len(dst) < len(src) {
+		return "", fmt.Errorf("output buffer holds %d bytes, expected %d", len(dst), len(src))
+	}
+	if method == "" || method == convMethodAuto {
+		method = selectConvMethod(k)
+	}
+
+	switch method {
+	case convMethodDirect:
+		parallelRows(height, func(startY, endY int) {
+			convolveDirectRows(dst, src, width, height, startY, endY, k)
+		})
+	case convMethodSeparable:
+		if k.row == nil {
+			return "", errors.New("kernel is not separable")
+		}
+		// Bands of at least four kernel heights keep the re-computed halo rows under ~25%
+		bandRows := max(CHUNK_SIZE, 4*k.height)
+		numBands := (height + bandRows - 1) / bandRows
+		parallelItems(numBands, func(band int) {
+			startY := band * bandRows
+			convolveSeparableFloatRows(dst, src, width, height, startY, min(startY+bandRows, height), k)
+		})
+	case convMethodSAT:
+		weight, ok := k.boxWeight()
+		if !ok {
+			return "", errors.New("summed-area tables require a box kernel (all weights equal)")
+		}
+		convolveBoxSAT(dst, src, width, height, k.width, k.height, weight)
+	case convMethodFFT:
+		convolveFFT(dst, src, width, height, k)
+	default:
+		return "", fmt.Errorf("unknown convolution method '%s'", method)
+	}
+	return method, nil
+}
+
+// floatToByte rounds and clamps a convolution sum exactly like the reference filter path.
+func floatToByte(sum float64) uint8 {
+	return uint8(clampFloat64(sum+0.5, 0, 255))
+}
+
+// convolveDirectRows evaluates every non-zero tap of k for rows [startY, endY).
+// Interior pixels use precomputed byte offsets; only the border strip of width
+// radius clamps coordinates.
+func convolveDirectRows(dst, src []uint8, width, height, startY, endY int, k *convKernel) {
+	rx, ry := k.width/2, k.height/2
+
+	// Compact the kernel to its non-zero taps with offsets relative to the center pixel
+	var offsets []int
+	var taps []float64
+	var tapX, tapY []int
+	for fy := 0; fy < k.height; fy++ {
+		for fx := 0; fx < k.width; fx++ {
+			if w := k.weights[fy*k.width+fx]; w != 0 {
+				offsets = append(offsets, ((fy-ry)*width+(fx-rx))*4)
+				taps = append(taps, w)
+				tapX = append(tapX, fx-rx)
+				tapY = append(tapY, fy-ry)
+			}
+		}
+	}
+
+	clampedPixel := func(x, y int) {
+		idx := (y*width + x) * 4
+		for c := 0; c < 3; c++ {
+			sum := 0.0
+			for t, w := range taps {
+				sx := clamp(x+tapX[t], 0, width-1)
+				sy := clamp(y+tapY[t], 0, height-1)
+				sum += float64(src[(sy*width+sx)*4+c]) * w
+			}
+			dst[idx+c] = floatToByte(sum)
+		}
+		dst[idx+3] = src[idx+3]
+	}
+
+	for y := startY; y < endY; y++ {
+		if y < ry || y >= height-ry || width <= 2*rx {
+			for x := 0; x < width; x++ {
+				clampedPixel(x, y)
+			}
+			continue
+		}
+		for x := 0; x < rx; x++ {
+			clampedPixel(x, y)
+		}
+		for x := rx; x < width-rx; x++ {
+			idx := (y*width + x) * 4
+			for c := 0; c < 3; c++ {
+				base := idx + c
+				sum := 0.0
+				for t, off := range offsets {
+					sum += float64(src[base+off]) * taps[t]
+				}
+				dst[base] = floatToByte(sum)
+			}
+			dst[idx+3] = src[idx+3]
+		}
+		for x := width - rx; x < width; x++ {
+			clampedPixel(x, y)
+		}
+	}
+}
+
+// convolveSeparableFloatRows runs k.row horizontally over rows [startY-ry, endY+ry)
+// into a pooled float32 scratch plane, then k.col vertically over rows [startY, endY).
+// Both passes loop tap-outer over contiguous rows so the inner loops stream memory.
+// float32 keeps sums of at most 255 * Σ|w| to about 7 significant digits, so a byte
+// only differs from the float64 direct method when the exact sum lies within that of
+// a rounding boundary.
+func convolveSeparableFloatRows(dst, src []uint8, width, height, startY, endY int, k *convKernel) {
+	rx, ry := k.width/2, k.height/2
+	haloStart := clamp(startY-ry, 0, height-1)
+	haloEnd := min(endY+ry, height)
+	rowStride := width * 4
+	scratchStride := width * 3
+	scratch := float32Planes.get((haloEnd - haloStart) * scratchStride)
+	defer float32Planes.put(scratch)
+	rowSymmetric, colSymmetric := isSymmetric(k.row), isSymmetric(k.col)
+	row32, col32 := float32Taps(k.row), float32Taps(k.col)
+
+	// Edge-replicated RGB row: (width + 2rx) pixels, converted to float32 once per row
+	padded := float32Planes.get((width + 2*rx) * 3)
+	defer float32Planes.put(padded)
+	taps := make([][]float32, max(k.width, k.height))
+
+	// Horizontal pass
+	for t := range k.row {
+		taps[t] = padded[t*3 : t*3+scratchStride]
+	}
+	for y := haloStart; y < haloEnd; y++ {
+		row := src[y*rowStride : (y+1)*rowStride]
+		for px := 0; px < width+2*rx; px++ {
+			idx := clamp(px-rx, 0, width-1) * 4
+			padded[px*3] = float32(row[idx])
+			padded[px*3+1] = float32(row[idx+1])
+			padded[px*3+2] = float32(row[idx+2])
+		}
+		h := scratch[(y-haloStart)*scratchStride : (y-haloStart+1)*scratchStride]
+		accumulateTaps(h, taps[:k.width], row32, rowSymmetric)
+	}
+
+	// Vertical pass
+	acc := float32Planes.get(scratchStride)
+	defer float32Planes.put(acc)
+	for y := startY; y < endY; y++ {
+		for t := range k.col {
+			sy := clamp(y+t-ry, 0, height-1)
+			taps[t] = scratch[(sy-haloStart)*scratchStride:][:scratchStride]
+		}
+		accumulateTaps(acc, taps[:k.height], col32, colSymmetric)
+
+		in := src[y*rowStride : (y+1)*rowStride]
+		out := dst[y*rowStride : (y+1)*rowStride]
+		for i, j := 0, 0; i < rowStride; i, j = i+4, j+3 {
+			out[i] = floatToByte(float64(acc[j]))
+			out[i+1] = floatToByte(float64(acc[j+1]))
+			out[i+2] = floatToByte(float64(acc[j+2]))
+			out[i+3] = in[i+3]
+		}
+	}
+}
+
+// float32Taps converts 1D kernel weights for the float32 separable passes.
+func float32Taps(w []float64) []float32 {
+	out := make([]float32, len(w))
+	for i, v := range w {
+		out[i] = float32(v)
+	}
+	return out
+}
+
+// accumulateTaps sets acc = Σ_t w[t] * rows[t]. For symmetric kernels the mirrored
+// taps are added first and multiplied once, halving the multiplies.
+func accumulateTaps(acc []float32, rows [][]float32, w []float32, symmetric bool) {
+	n := len(w)
+	center := rows[n/2][:len(acc)]
+	wc := w[n/2]
+	for j, v := range center {
+		acc[j] = v * wc
+	}
+	for t := 0; t < n/2; t++ {
+		a, b := rows[t][:len(acc)], rows[n-1-t][:len(acc)]
+		wa, wb := w[t], w[n-1-t]
+		if symmetric {
+			for j := range acc {
+				acc[j] += (a[j] + b[j]) * wa
+			}
+			continue
+		}
+		for j := range acc {
+			acc[j] += a[j]*wa + b[j]*wb
+		}
+	}
+}
+
+// isSymmetric reports whether a 1D kernel reads the same in both directions.
+func isSymmetric(w []float64) bool {
+	for i := 0; i < len(w)/2; i++ {
+		if w[i] != w[len(w)-1-i] {
+			return false
+		}
+	}
+	return true
+}
+
+// convolveBoxSAT applies a kernelWidth x kernelHeight box kernel with the given weight
+// using one summed-area table per channel over the edge-replicated padded image.
+// The table is uint32 and allowed to wrap: window sums never exceed 255*taps < 2^32,
+// so the four-corner difference is exact in modular arithmetic.
+func convolveBoxSAT(dst, src []uint8, width, height, kernelWidth, kernelHeight int, weight float64) {
+	rx, ry := kernelWidth/2, kernelHeight/2
+	paddedWidth, paddedHeight := width+2*rx, height+2*ry
+	satStride := paddedWidth + 1
+	sat := make([]uint32, satStride*(paddedHeight+1)) // Row 0 and column 0 stay zero
+
+	// Padded column -> clamped source byte offset
+	srcX := make([]int, paddedWidth)
+	for px := range srcX {
+		srcX[px] = clamp(px-rx, 0, width-1) * 4
+	}
+
+	for c := 0; c < 3; c++ {
+		// Build the table for channel c
+		for py := 0; py < paddedHeight; py++ {
+			row := src[clamp(py-ry, 0, height-1)*width*4:]
+			above := sat[py*satStride : (py+1)*satStride]
+			cur := sat[(py+1)*satStride : (py+2)*satStride]
+			var rowSum uint32
+			for px, off := range srcX {
+				rowSum += uint32(row[off+c])
+				cur[px+1] = above[px+1] + rowSum
+			}
+		}
+
+		// Query one window per output pixel
+		parallelRows(height, func(startY, endY int) {
+			for y := startY; y < endY; y++ {
+				top := sat[y*satStride : (y+1)*satStride]
+				bottom := sat[(y+kernelHeight)*satStride : (y+kernelHeight+1)*satStride]
+				out := dst[y*width*4 : (y+1)*width*4]
+				for x := 0; x < width; x++ {
+					sum := bottom[x+kernelWidth] - top[x+kernelWidth] - bottom[x] + top[x]
+					out[x*4+c] = floatToByte(float64(sum) * weight)
+				}
+			}
+		})
+	}
+
+	// Copy alpha unchanged
+	for i := 3; i < width*height*4; i += 4 {
+		dst[i] = src[i]
+	}
+}
@@ -0,0 +1,103 @@
+package main
+
+import (
+	"math"
+	"math/rand"
+	"testing"
+)
+
+// gaussianTaps returns normalized 1D Gaussian weights of the given radius.
+func gaussianTaps(radius int, sigma float64) []float64 {
+	taps := make([]float64, 2*radius+1)
+	sum := 0.0
+	for i := range taps {
+		d := float64(i - radius)
+		taps[i] = math.Exp(-d * d / (2 * sigma * sigma))
+		sum += taps[i]
+	}
+	for i := range taps {
+		taps[i] /= sum
+	}
+	return taps
+}
+
+// denseTestKernel builds a normalized kernel from weights, failing the test on error.
+func denseTestKernel(t *testing.T, width, height int, weights []float64) *convKernel {
+	t.Helper()
+	k, err := newDenseKernel(width, height, weights)
+	if err != nil {
+		t.Fatalf("newDenseKernel: %v", err)
+	}
+	k.normalize()
+	return k
+}
+
+func TestConvMethodsAgree(t *testing.T) {
+	box := func(n int) []float64 {
+		w := make([]float64, n*n)
+		for i := range w {
+			w[i] = 1
+		}
+		return w
+	}
+	outer := func(taps []float64) []float64 {
+		w := make([]float64, len(taps)*len(taps))
+		for r, a := range taps {
+			for c, b := range taps {
+				w[r*len(taps)+c] = a * b
+			}
+		}
+		return w
+	}
+	rng := rand.New(rand.NewSource(1))
+	random := make([]float64, 15*15)
+	for i := range random {
+		random[i] = rng.Float64()
+	}
+
+	all := []string{convMethodDirect, convMethodSeparable, convMethodSAT, convMethodFFT}
+	tests := []struct {
+		name    string
+		kernel  *convKernel
+		auto    string
+		methods []string
+	}{
+		{"box 7x7", denseTestKernel(t, 7, 7, box(7)), convMethodSAT, all},
+		{"box 21x21", denseTestKernel(t, 21, 21, box(21)), convMethodSAT, all},
+		{"gaussian 9x9", denseTestKernel(t, 9, 9, outer(gaussianTaps(4, 1.5))), convMethodSeparable,
+			[]string{convMethodDirect, convMethodSeparable, convMethodFFT}},
+		{"gaussian 31x31", denseTestKernel(t, 31, 31, outer(gaussianTaps(15, 5))), convMethodSeparable,
+			[]string{convMethodDirect, convMethodSeparable, convMethodFFT}},
+		{"dense 15x15", denseTestKernel(t, 15, 15, random), convMethodFFT,
+			[]string{convMethodDirect, convMethodFFT}},
+	}
+	// Below the kernel, below one FFT tile, and across tile seams
+	sizes := [][2]int{{1, 1}, {5, 3}, {37, 29}, {150, 70}}
+
+	for _, tt := range tests {
+		if got := selectConvMethod(tt.kernel); got != tt.auto {
+			t.Errorf("%s: selectConvMethod = %s, want %s", tt.name, got, tt.auto)
+		}
+		for _, size := range sizes {
+			width, height := size[0], size[1]
+			src := randomImage(width, height, int64(width+height))
+			want, _, err := convolveImage(src, width, height, tt.kernel, convMethodDirect)
+			if err != nil {
+				t.Fatalf("%s: direct: %v", tt.name, err)
+			}
+			for _, method := range tt.methods[1:] {
+				got, _, err := convolveImage(src, width, height, tt.kernel, method)
+				if err != nil {
+					t.Fatalf("%s: %s: %v", tt.name, method, err)
+				}
+				for i := range want {
+					diff := int(got[i]) - int(want[i])
+					if i%4 == 3 && diff != 0 || diff > convMethodTolerance || diff < -convMethodTolerance {
+						t.Fatalf("%s %dx%d via %s: byte %d (pixel %d, channel %d) = %d, direct gives %d",
+							tt.name, width, height, method, i, i/4, i%4, got[i], want[i])
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,99 @@
+package main
+
+// Blocked low-rank reconstruction.
+//
+// A rank-r approximation U_r Σ_r V_rᵀ of a rows x cols channel is never built as a
+// dense matrix. Output is produced in panels of lowRankPanelRows x lowRankPanelCols
+// pixels: the panel's r-wide slice of V (and one row of UΣ at a time) stays in cache
+// while every pixel of the panel is evaluated as a contiguous r-term dot product, and
+// each panel row is handed to the caller, who converts it straight to bytes.
+
+// Panel shape: panelCols rows of V (r float64s each) are kept hot across panelRows
+// output rows; lowRankPanelBytes bounds that V slice to comfortably fit in L1/L2.
+const (
+	lowRankPanelRows  = 16
+	lowRankPanelBytes = 32 * 1024
+)
+
+// lowRankPanelCols returns the panel width for rank r.
+func lowRankPanelCols(r int) int {
+	return max(16, lowRankPanelBytes/(8*max(r, 1)))
+}
+
+// reconstructRows evaluates rows [startY, endY) of the rank-r approximation held in f,
+// calling emit(y, x0, vals) with vals[i] the value at column x0+i. vals is reused
+// between calls and must not be retained.
+func reconstructRows(f *svdFactors, r, startY, endY int, emit func(y, x0 int, vals []float64)) {
+	r = min(r, f.k)
+	k := f.k
+	panelCols := min(lowRankPanelCols(r), f.cols)
+	vals := make([]float64, panelCols)
+	us := make([]float64, lowRankPanelRows*r)
+	var panel []float64 // Whole-panel output of simdLowRankPanel
+	if simdLowRankPanel != nil {
+		panel = make([]float64, lowRankPanelRows*panelCols)
+	}
+
+	for y0 := startY; y0 < endY; y0 += lowRankPanelRows {
+		y1 := min(y0+lowRankPanelRows, endY)
+		// Fold Σ into the panel's rows of U once
+		for y := y0; y < y1; y++ {
+			urow := f.u[y*k : y*k+r]
+			dst := us[(y-y0)*r : (y-y0+1)*r]
+			for i, u := range urow {
+				dst[i] = u * f.s[i]
+			}
+		}
+		for x0 := 0; x0 < f.cols; x0 += panelCols {
+			x1 := min(x0+panelCols, f.cols)
+			if panel != nil {
+				cols := x1 - x0
+				simdLowRankPanel(panel, us, f.v[x0*k:], k, r, y1-y0, cols)
+				for y := y0; y < y1; y++ {
+					emit(y, x0, panel[(y-y0)*cols:(y-y0+1)*cols])
+				}
+				continue
+			}
+			out := vals[:x1-x0]
+			for y := y0; y < y1; y++ {
+				urow := us[(y-y0)*r : (y-y0+1)*r]
+				for x := range out {
+					vrow := f.v[(x0+x)*k : (x0+x)*k+r]
+					sum := 0.0
+					for i, u := range urow {
+						sum += u * vrow[i]
+					}
+					out[x] = sum
+				}
+				emit(y, x0, out)
+			}
+		}
+	}
+}
+
+// reconstructChannelInto writes the rank-r approximation in f as channel c of the
+// interleaved RGBA image dst, rounding and clamping to bytes.
+func reconstructChannelInto(dst []uint8, c int, f *svdFactors, r int) {
+	cols := f.cols
+	parallelRows(f.rows, func(startY, endY int) {
+		reconstructRows(f, r, startY, endY, func(y, x0 int, vals []float64) {
+			row := dst[(y*cols+x0)*4:]
+			for i, v := range vals {
+				row[i*4+c] = uint8(clampFloat64(v+0.5, 0, 255))
+			}
+		})
+	})
+}
+
+// reconstructPlaneInto writes the rank-r approximation in f into the rows x cols plane dst.
+func reconstructPlaneInto(dst []float32, f *svdFactors, r int) {
+	cols := f.cols
+	parallelRows(f.rows, func(startY, endY int) {
+		reconstructRows(f, r, startY, endY, func(y, x0 int, vals []float64) {
+			row := dst[y*cols+x0:]
+			for i, v := range vals {
+				row[i] = float32(v)
+			}
+		})
+	})
+}
@@ -0,0 +1,37 @@
+//go:build !js
+// +build !js
+
+package main
+
+import (
+	"fmt"
+	"os"
+)
+
+// Native entry point: the WebAssembly module's main (main.go) only exists in js/wasm
+// builds, so native builds of the package are the command-line tools.
+//
+//	go run . bench [-sizes 256,1024] [-run svd/] [-out results.json] [-baseline baseline.json]
+//	go run . process -op '{"op":"applyFilter","filterType":"blur"}' [-out dir] [-workers n] images or directories...
+//	go run . serve [-addr :8080] [-workers n]
+func main() {
+	if len(os.Args) < 2 {
+		usage()
+		os.Exit(2)
+	}
+	switch os.Args[1] {
+	case "bench":
+		os.Exit(runBench(os.Args[2:]))
+	case "process":
+		os.Exit(runProcess(os.Args[2:]))
+	case "serve":
+		os.Exit(runServe(os.Args[2:]))
+	default:
+		usage()
+		os.Exit(2)
+	}
+}
+
+func usage() {
+	fmt.Fprintln(os.Stderr, "usage: go run . bench|process|serve [flags]   (see go run . <command> -h)")
+}
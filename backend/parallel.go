@@ -0,0 +1,132 @@
+package main
+
+import (
+	"fmt"
+	"runtime"
+	"sync"
+	"sync/atomic"
+)
+
+const CHUNK_SIZE = 64 // Define chunk size for parallel processing
+
+// Persistent worker pool shared by every parallel kernel.
+//
+// GOMAXPROCS-1 helper goroutines are started on first use and sleep on a channel
+// between calls. A parallel call publishes a job of n chunks and wakes idle helpers;
+// the caller and the helpers then claim chunk indices from the job's atomic counter
+// until none are left. Whoever is faster takes more chunks, so uneven per-row cost
+// (e.g. SVD bands, FFT tiles at the edges) balances itself, and no goroutine is
+// created per call. The caller always works on its own job, so a call completes even
+// when every helper is busy, and nested or concurrent calls (per-channel work that
+// reconstructs rows, native requests in parallel) cannot deadlock. With GOMAXPROCS=1,
+// as in the browser, there are no helpers and the caller runs every chunk itself.
+//
+// A panic in a chunk is recovered on whichever goroutine ran it, so a helper never
+// takes the process down. The remaining chunks are skipped, and the caller re-panics
+// with the first panic once every claimed chunk has finished.
+
+// parallelJob is one parallel call: chunks [0, n) of run.
+type parallelJob struct {
+	next atomic.Int64 // Next unclaimed chunk
+	n    int64
+	run  func(chunk int)
+	name string // Reported with recovered panics
+	wg   sync.WaitGroup
+
+	failed    atomic.Bool // Set once a chunk panicked; later chunks are skipped
+	panicOnce sync.Once
+	panicErr  error // First recovered panic, re-raised on the caller
+}
+
+var (
+	parallelOnce    sync.Once
+	parallelWake    chan *parallelJob // Jobs offered to idle helpers
+	parallelHelpers int
+)
+
+func startParallelHelpers() {
+	parallelHelpers = runtime.GOMAXPROCS(0) - 1
+	parallelWake = make(chan *parallelJob, parallelHelpers)
+	for i := 0; i < parallelHelpers; i++ {
+		go func() {
+			for job := range parallelWake {
+				job.work()
+			}
+		}()
+	}
+}
+
+// work claims and runs chunks of j until none are left. Chunks that start after the
+// call was cancelled or a chunk panicked are skipped.
+func (j *parallelJob) work() {
+	for {
+		chunk := j.next.Add(1) - 1
+		if chunk >= j.n {
+			return
+		}
+		if !cancelled() && !j.failed.Load() {
+			j.runChunk(int(chunk))
+		}
+		j.wg.Done()
+	}
+}
+
+// runChunk runs one chunk, recording a panic for the caller so one bad chunk can
+// neither hang it nor crash a helper.
+func (j *parallelJob) runChunk(chunk int) {
+	defer func() {
+		if r := recover(); r != nil {
+			j.panicOnce.Do(func() {
+				j.panicErr = fmt.Errorf("%s chunk %d: %v", j.name, chunk, r)
+				j.failed.Store(true)
+			})
+		}
+	}()
+	j.run(chunk)
+}
+
+// parallelFor runs run(chunk) for every chunk in [0, n) on the calling goroutine and
+// any idle pool helpers, returning when all chunks are done. If a chunk panicked,
+// parallelFor panics with an error naming the chunk.
+func parallelFor(name string, n int, run func(chunk int)) {
+	if n <= 0 {
+		return
+	}
+	parallelOnce.Do(startParallelHelpers)
+	job := &parallelJob{n: int64(n), run: run, name: name}
+	job.wg.Add(n)
+	// Offer the job to as many helpers as could take a chunk; busy helpers are skipped
+wake:
+	for i := 0; i < min(parallelHelpers, n-1); i++ {
+		select {
+		case parallelWake <- job:
+		default:
+			break wake
+		}
+	}
+	job.work()
+	job.wg.Wait()
+	if job.failed.Load() {
+		panic(job.panicErr)
+	}
+}
+
+// parallelRows splits [0, height) into CHUNK_SIZE row chunks and runs fn on each chunk
+// in the worker pool, returning when all of them are done.
+// A panic inside fn is re-raised on the caller once the running chunks are done.
+// Chunks that start after the call was cancelled are skipped.
+func parallelRows(height int, fn func(startY, endY int)) {
+	numChunks := max((height+CHUNK_SIZE-1)/CHUNK_SIZE, 1)
+	parallelFor("parallelRows", numChunks, func(chunk int) {
+		startY := chunk * CHUNK_SIZE
+		fn(startY, min(startY+CHUNK_SIZE, height))
+	})
+}
+
+// parallelItems runs fn(i) for every i in [0, n) in the worker pool. Used when each item
+// needs its own large scratch buffer: at most one item runs per participating goroutine,
+// so the number of live buffers stays bounded.
+// Items that start after the call was cancelled are skipped.
+func parallelItems(n int, fn func(i int)) {
+	parallelFor("parallelItems", n, fn)
+}
@@ -0,0 +1,78 @@
+package main
+
+import (
+	"strings"
+	"sync/atomic"
+	"testing"
+)
+
+func TestParallelRowsCoverage(t *testing.T) {
+	for _, height := range []int{0, 1, CHUNK_SIZE - 1, CHUNK_SIZE, CHUNK_SIZE + 1, 10*CHUNK_SIZE + 7} {
+		counts := make([]atomic.Int32, height)
+		parallelRows(height, func(startY, endY int) {
+			for y := startY; y < endY; y++ {
+				counts[y].Add(1)
+			}
+		})
+		for y := range counts {
+			if n := counts[y].Load(); n != 1 {
+				t.Fatalf("height %d: row %d processed %d times", height, y, n)
+			}
+		}
+	}
+}
+
+func TestParallelItemsCoverage(t *testing.T) {
+	const n = 1000
+	counts := make([]atomic.Int32, n)
+	// Nested calls share the pool with the outer one
+	parallelItems(n/10, func(i int) {
+		parallelItems(10, func(j int) { counts[i*10+j].Add(1) })
+	})
+	for i := range counts {
+		if c := counts[i].Load(); c != 1 {
+			t.Fatalf("item %d processed %d times", i, c)
+		}
+	}
+}
+
+func TestParallelPanicReachesCaller(t *testing.T) {
+	var ran atomic.Int32
+	func() {
+		defer func() {
+			r := recover()
+			err, ok := r.(error)
+			if !ok || !strings.Contains(err.Error(), "chunk 37: boom") {
+				t.Errorf("recovered %v, want the chunk 37 panic", r)
+			}
+		}()
+		parallelItems(1000, func(i int) {
+			ran.Add(1)
+			if i == 37 {
+				panic("boom")
+			}
+		})
+		t.Error("parallelItems returned after a panic")
+	}()
+	if n := ran.Load(); n == 1000 {
+		t.Error("every item ran after the panic")
+	}
+
+	// The pool keeps working after a panic
+	var sum atomic.Int64
+	parallelItems(100, func(i int) { sum.Add(int64(i)) })
+	if sum.Load() != 4950 {
+		t.Errorf("after a panic, items summed to %d, want 4950", sum.Load())
+	}
+}
+
+func TestParallelStopsWhenCancelled(t *testing.T) {
+	var ran atomic.Int32
+	setCancelPoll(func() bool { return ran.Load() >= 3 })
+	defer setCancelPoll(nil)
+	parallelItems(1000, func(i int) { ran.Add(1) })
+	// Items already past the poll when the third one finished may still complete
+	if n := int(ran.Load()); n < 3 || n > 3+parallelHelpers {
+		t.Errorf("%d items ran after cancelling at 3 with %d helpers", n, parallelHelpers)
+	}
+}
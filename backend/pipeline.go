@@ -0,0 +1,307 @@
+package main
+
+import (
+	"errors"
+	"fmt"
+	"math"
+	"sync"
+)
+
+// Filter pipelines: an ordered list of stages (builtin filters, custom kernels, point
+// operations and SVD compression) applied inside the module in one call.
+//
+// Consecutive point operations are composed into one 256-entry lookup table, and a
+// table that follows a convolution is applied to each band of that convolution's
+// output while it is still in cache. Runs of row-local stages (builtin filters and
+// kernels using the direct or separable method) are streamed band by band: each band
+// carries enough halo rows for every remaining stage, so its intermediates only ever
+// cover a few dozen rows instead of the whole frame. Stages that need the whole image
+// (SVD, summed-area table and FFT convolution) are barriers that run on full frames.
+
+// Point operations selectable from JavaScript via { op: "point", type, amount }.
+const (
+	pointBrightness = "brightness" // v + amount
+	pointContrast   = "contrast"   // (v - 128) * amount + 128
+	pointGamma      = "gamma"      // 255 * (v / 255)^(1 / amount)
+	pointInvert     = "invert"     // 255 - v
+	pointThreshold  = "threshold"  // 255 if v >= amount, else 0
+)
+
+// pipelineStage is one executable step after fusion. Exactly one of filter, kernel
+// and svd is set, or none of them for a standalone lookup table stage.
+type pipelineStage struct {
+	filter *intKernel  // Builtin 3x3 filter
+	kernel *convKernel // Custom kernel
+	method string      // Resolved convolution method for kernel
+	svd    *pipelineSVD
+	lut    *[256]uint8 // Point operations applied to the RGB output, nil if none
+}
+
+// pipelineSVD holds the parameters of an SVD stage.
+type pipelineSVD struct {
+	rank int
+	opts svdOptions
+}
+
+// pipelineBuilder collects stages, fusing point operations as they are added.
+type pipelineBuilder struct {
+	stages []pipelineStage
+}
+
+// addFilter appends a builtin filter stage.
+func (b *pipelineBuilder) addFilter(name string) error {
+	k, ok := builtinKernels[name]
+	if !ok {
+		return fmt.Errorf("unknown filter type '%s'", name)
+	}
+	b.stages = append(b.stages, pipelineStage{filter: k})
+	return nil
+}
+
+// addKernel appends a custom kernel stage, resolving convMethodAuto up front.
+func (b *pipelineBuilder) addKernel(k *convKernel, method string) error {
+	if method == "" || method == convMethodAuto {
+		method = selectConvMethod(k)
+	}
+	switch method {
+	case convMethodDirect, convMethodFFT:
+	case convMethodSeparable:
+		if k.row == nil {
+			return errors.New("kernel is not separable")
+		}
+	case convMethodSAT:
+		if _, ok := k.boxWeight(); !ok {
+			return errors.New("summed-area tables require a box kernel (all weights equal)")
+		}
+	default:
+		return fmt.Errorf("unknown convolution method '%s'", method)
+	}
+	b.stages = append(b.stages, pipelineStage{kernel: k, method: method})
+	return nil
+}
+
+// addSVD appends an SVD compression stage.
+func (b *pipelineBuilder) addSVD(rank int, opts svdOptions) {
+	b.stages = append(b.stages, pipelineStage{svd: &pipelineSVD{rank: rank, opts: opts}})
+}
+
+// addPoint composes a point operation into the previous stage's lookup table, or
+// starts a table stage if it is the first operation.
+func (b *pipelineBuilder) addPoint(op string, amount float64) error {
+	f, err := pointFunc(op, amount)
+	if err != nil {
+		return err
+	}
+	if len(b.stages) == 0 {
+		b.stages = append(b.stages, pipelineStage{})
+	}
+	last := &b.stages[len(b.stages)-1]
+	lut := new([256]uint8)
+	for v := range lut {
+		in := uint8(v)
+		if last.lut != nil {
+			in = last.lut[v]
+		}
+		lut[v] = uint8(clampFloat64(f(float64(in))+0.5, 0, 255))
+	}
+	last.lut = lut
+	return nil
+}
+
+// pointFunc returns the per-channel mapping of a point operation.
+func pointFunc(op string, amount float64) (func(v float64) float64, error) {
+	switch op {
+	case pointBrightness:
+		return func(v float64) float64 { return v + amount }, nil
+	case pointContrast:
+		return func(v float64) float64 { return (v-128)*amount + 128 }, nil
+	case pointGamma:
+		if amount <= 0 {
+			return nil, errors.New("gamma must be positive")
+		}
+		return func(v float64) float64 { return 255 * math.Pow(v/255, 1/amount) }, nil
+	case pointInvert:
+		return func(v float64) float64 { return 255 - v }, nil
+	case pointThreshold:
+		return func(v float64) float64 {
+			if v >= amount {
+				return 255
+			}
+			return 0
+		}, nil
+	}
+	return nil, fmt.Errorf("unknown point operation '%s'", op)
+}
+
+// streamable reports whether the stage only reads a bounded number of neighbouring
+// rows, so it can run on a band of the image.
+func (s *pipelineStage) streamable() bool {
+	if s.svd != nil {
+		return false
+	}
+	return s.kernel == nil || s.method == convMethodDirect || s.method == convMethodSeparable
+}
+
+// rowRadius is the number of rows above and below each output row the stage reads.
+func (s *pipelineStage) rowRadius() int {
+	switch {
+	case s.filter != nil:
+		return 1
+	case s.kernel != nil:
+		return s.kernel.height / 2
+	}
+	return 0
+}
+
+// convolveBand runs a streamable stage's convolution (or a plain copy for table
+// stages) on rows [startY, endY) of an image of the given height.
+func (s *pipelineStage) convolveBand(dst, src []uint8, width, height, startY, endY int) {
+	switch {
+	case s.filter != nil:
+		convolveRows(dst, src, width, height, startY, endY, s.filter)
+	case s.kernel != nil && s.method == convMethodSeparable:
+		convolveSeparableFloatRows(dst, src, width, height, startY, endY, s.kernel)
+	case s.kernel != nil:
+		convolveDirectRows(dst, src, width, height, startY, endY, s.kernel)
+	default:
+		copy(dst[startY*width*4:endY*width*4], src[startY*width*4:endY*width*4])
+	}
+}
+
+// applyLUT maps the RGB bytes of buf through lut, leaving alpha unchanged.
+func applyLUT(buf []uint8, lut *[256]uint8) {
+	for i := 0; i+3 < len(buf); i += 4 {
+		buf[i] = lut[buf[i]]
+		buf[i+1] = lut[buf[i+1]]
+		buf[i+2] = lut[buf[i+2]]
+	}
+}
+
+// pipelineBandRows is the height of the output band each streaming task produces.
+const pipelineBandRows = CHUNK_SIZE
+
+// Band scratch buffers, reused across bands and calls
+var pipelineScratch sync.Pool
+
+// runPipelineInto applies stages to src and writes the result into dst. Both hold
+// width*height RGBA pixels; src is not modified.
+func runPipelineInto(dst, src []uint8, width, height int, stages []pipelineStage) error {
+	n := width * height * 4
+	if width <= 0 || height <= 0 || len(src) < n || len(dst) < n {
+		return fmt.Errorf("image data too short for %dx%d", width, height)
+	}
+	if len(stages) == 0 {
+		copy(dst[:n], src[:n])
+		return nil
+	}
+
+	// Split into segments: a run of streamable stages or a single barrier stage
+	var bounds []int
+	for i := 0; i < len(stages); {
+		j := i + 1
+		if stages[i].streamable() {
+			for j < len(stages) && stages[j].streamable() {
+				j++
+			}
+		}
+		bounds = append(bounds, i)
+		i = j
+	}
+	bounds = append(bounds, len(stages))
+
+	// Segments alternate between dst and one spare frame, chosen so the last writes dst
+	var spare []uint8
+	cur := src[:n]
+	for k := 0; k+1 < len(bounds); k++ {
+		out := dst[:n]
+		if (len(bounds)-2-k)%2 == 1 {
+			if spare == nil {
+				spare = make([]uint8, n)
+			}
+			out = spare
+		}
+		if err := runPipelineSegment(out, cur, width, height, stages[bounds[k]:bounds[k+1]]); err != nil {
+			return err
+		}
+		if activeStats != nil {
+			statsPhase(fmt.Sprintf("stages %d-%d", bounds[k], bounds[k+1]-1))
+		}
+		cur = out
+	}
+	return nil
+}
+
+// runPipelineSegment runs either one barrier stage or a run of streamable stages.
+func runPipelineSegment(dst, src []uint8, width, height int, stages []pipelineStage) error {
+	s := &stages[0]
+	if !s.streamable() {
+		switch {
+		case s.svd != nil:
+			compressSVDInto(dst, src, int32(width), int32(height), int32(s.svd.rank), s.svd.opts)
+		default:
+			if _, err := convolveImageInto(dst, src, width, height, s.kernel, s.method); err != nil {
+				return err
+			}
+		}
+		if s.lut != nil {
+			parallelRows(height, func(startY, endY int) {
+				applyLUT(dst[startY*width*4:endY*width*4], s.lut)
+			})
+		}
+		return nil
+	}
+
+	// Output rows [y0, y1) of a band need rows [y0 - r, y1 + r) of the last stage's input,
+	// where r is that stage's row radius, and so on back to the segment's input.
+	totalRadius := 0
+	for i := range stages {
+		totalRadius += stages[i].rowRadius()
+	}
+	// Bands of at least four halo heights keep the re-computed rows under ~25%
+	bandRows := max(pipelineBandRows, 4*totalRadius)
+	numBands := (height + bandRows - 1) / bandRows
+	rowStride := width * 4
+
+	parallelItems(numBands, func(band int) {
+		// Stage i reads rows [starts[i], ends[i]) and writes [starts[i+1], ends[i+1])
+		y0 := band * bandRows
+		y1 := min(y0+bandRows, height)
+		starts, ends := make([]int, len(stages)+1), make([]int, len(stages)+1)
+		starts[len(stages)], ends[len(stages)] = y0, y1
+		for i := len(stages) - 1; i >= 0; i-- {
+			r := stages[i].rowRadius()
+			starts[i], ends[i] = max(starts[i+1]-r, 0), min(ends[i+1]+r, height)
+		}
+
+		slabBytes := (ends[0] - starts[0]) * rowStride
+		var scratch [2][]uint8
+		if pooled, ok := pipelineScratch.Get().(*[2][]uint8); ok && cap(pooled[0]) >= slabBytes {
+			scratch = *pooled
+		} else {
+			scratch = [2][]uint8{make([]uint8, slabBytes), make([]uint8, slabBytes)}
+		}
+
+		// Each stage runs on its input slab as if it were the whole image. Rows a stage
+		// computes never read past the slab except at real image borders, where the slab
+		// and the image share the same edge, so edge replication matches the full frame.
+		in := src[starts[0]*rowStride : ends[0]*rowStride]
+		for i := range stages {
+			slabHeight := ends[i] - starts[i]
+			outStart, outEnd := starts[i+1]-starts[i], ends[i+1]-starts[i]
+			var out []uint8
+			if i == len(stages)-1 {
+				// Align dst so the band's rows land at their final position
+				out = dst[starts[i]*rowStride:]
+			} else {
+				out = scratch[i%2][:slabHeight*rowStride]
+			}
+			stages[i].convolveBand(out, in, width, slabHeight, outStart, outEnd)
+			if stages[i].lut != nil {
+				applyLUT(out[outStart*rowStride:outEnd*rowStride], stages[i].lut)
+			}
+			in = out[outStart*rowStride : outEnd*rowStride]
+		}
+		pipelineScratch.Put(&scratch)
+	})
+	return nil
+}
@@ -0,0 +1,133 @@
+//go:build js && wasm
+// +build js,wasm
+
+package main
+
+import (
+	"errors"
+	"fmt"
+	"syscall/js"
+	"time"
+)
+
+// JavaScript bindings for filter pipelines (see pipeline.go).
+
+// parsePipeline converts an array of stage specs (see stageSpec in spec.go) into
+// fused pipeline stages.
+func parsePipeline(opsJS js.Value) ([]pipelineStage, error) {
+	if opsJS.IsUndefined() || opsJS.IsNull() || opsJS.Type() != js.TypeObject {
+		return nil, errors.New("expected an array of operations")
+	}
+	specs := make([]stageSpec, opsJS.Length())
+	for i := range specs {
+		var err error
+		if specs[i], err = readStageSpec(opsJS.Index(i)); err != nil {
+			return nil, fmt.Errorf("operation %d: %v", i, err)
+		}
+	}
+	return buildPipeline(specs)
+}
+
+// readStageSpec reads one stage spec object, checking the types of its fields.
+func readStageSpec(op js.Value) (stageSpec, error) {
+	if op.Type() != js.TypeObject || op.Get("op").Type() != js.TypeString {
+		return stageSpec{}, errors.New("expected an object with an op string")
+	}
+	s := stageSpec{Op: op.Get("op").String()}
+	switch s.Op {
+	case "filter":
+		if op.Get("filterType").Type() != js.TypeString {
+			return s, errors.New("filterType must be a string")
+		}
+		s.FilterType = op.Get("filterType").String()
+	case "kernel":
+		kernel, err := readKernelSpec(op.Get("kernel"))
+		if err != nil {
+			return s, err
+		}
+		s.Kernel = kernel
+	case "point":
+		if op.Get("type").Type() != js.TypeString {
+			return s, errors.New("type must be a string")
+		}
+		s.Type = op.Get("type").String()
+		if amountVal := op.Get("amount"); !amountVal.IsUndefined() {
+			if amountVal.Type() != js.TypeNumber {
+				return s, errors.New("amount must be a number")
+			}
+			s.Amount = amountVal.Float()
+		}
+	case "svd":
+		if op.Get("rank").Type() != js.TypeNumber {
+			return s, errors.New("rank must be a positive number")
+		}
+		s.Rank = op.Get("rank").Int()
+		var errMsg string
+		if s.Options, errMsg = readSVDOptionsSpec(op.Get("options")); errMsg != "" {
+			return s, errors.New(errMsg)
+		}
+	}
+	// Unknown ops are reported by stageSpec.addTo
+	return s, nil
+}
+
+// applyPipelineWrapper expects imageData { width, height, data } and an array of stage
+// specs (see parsePipeline). It returns the processed Uint8ClampedArray or an error object.
+func applyPipelineWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("applyPipeline")
+	defer endStats()
+	if len(args) < 2 {
+		return createError("Invalid number of arguments for applyPipeline: expected 2 (imageData, ops)")
+	}
+	dataJS, width, height, errObj := readImageDataArg("applyPipeline", args[0])
+	if errObj != nil {
+		return errObj
+	}
+	stages, err := parsePipeline(args[1])
+	if err != nil {
+		return createError(fmt.Sprintf("Invalid pipeline: %v", err))
+	}
+
+	src := make([]uint8, dataJS.Length())
+	js.CopyBytesToGo(src, dataJS)
+	statsBytes(len(src), 0)
+	statsPhase(phaseCopyIn)
+	dst := make([]uint8, len(src))
+	if err := runPipelineInto(dst, src, width, height, stages); err != nil {
+		return createError(fmt.Sprintf("applyPipeline failed: %v", err))
+	}
+
+	resultJS := js.Global().Get("Uint8ClampedArray").New(len(dst))
+	js.CopyBytesToJS(resultJS, dst)
+	statsBytes(0, len(dst))
+	statsPhase(phaseCopyOut)
+	logf("applyPipelineWrapper: %d fused stages completed in %v\n", len(stages), time.Since(startTime))
+	return resultJS
+}
+
+// applyPipelineSharedWrapper expects (width, height, ops) and runs the pipeline from the
+// shared source buffer into the shared result buffer. It returns the result { ptr, length }.
+func applyPipelineSharedWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("applyPipelineShared")
+	defer endStats()
+	src, dst, width, height, errObj := sharedImageBuffers("applyPipelineShared", args)
+	if errObj != nil {
+		return errObj
+	}
+	if len(args) < 3 {
+		return createError("Invalid number of arguments for applyPipelineShared: expected 3 (width, height, ops)")
+	}
+	stages, err := parsePipeline(args[2])
+	if err != nil {
+		return createError(fmt.Sprintf("Invalid pipeline: %v", err))
+	}
+
+	if err := runPipelineInto(dst, src, width, height, stages); err != nil {
+		return createError(fmt.Sprintf("applyPipelineShared failed: %v", err))
+	}
+
+	logf("applyPipelineSharedWrapper: %d fused stages completed in %v\n", len(stages), time.Since(startTime))
+	return sharedBufferInfo(dst)
+}
@@ -0,0 +1,110 @@
+package main
+
+import "testing"
+
+// pointReference applies one point operation to the RGB bytes of src on its own.
+func pointReference(t *testing.T, src []uint8, op string, amount float64) []uint8 {
+	t.Helper()
+	f, err := pointFunc(op, amount)
+	if err != nil {
+		t.Fatalf("pointFunc(%s): %v", op, err)
+	}
+	dst := append([]uint8(nil), src...)
+	for i := range dst {
+		if i%4 != 3 {
+			dst[i] = uint8(clampFloat64(f(float64(dst[i]))+0.5, 0, 255))
+		}
+	}
+	return dst
+}
+
+func TestPipelineMatchesStageByStage(t *testing.T) {
+	gaussian, err := newSeparableKernel(gaussianTaps(4, 1.5), gaussianTaps(4, 1.5))
+	if err != nil {
+		t.Fatalf("newSeparableKernel: %v", err)
+	}
+	weights := make([]float64, 5*5)
+	for i := range weights {
+		weights[i] = float64(i%7) - 2
+	}
+	direct := denseTestKernel(t, 5, 5, weights)
+	box := denseTestKernel(t, 7, 7, []float64{
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	})
+
+	// Each stage is added to the pipeline and, separately, applied to the whole image
+	type stage struct {
+		add   func(b *pipelineBuilder) error
+		apply func(src []uint8, width, height int) []uint8
+	}
+	filter := func(name string) stage {
+		return stage{
+			func(b *pipelineBuilder) error { return b.addFilter(name) },
+			func(src []uint8, width, height int) []uint8 { return applyFilter(src, width, height, name) },
+		}
+	}
+	kernel := func(k *convKernel, method string) stage {
+		return stage{
+			func(b *pipelineBuilder) error { return b.addKernel(k, method) },
+			func(src []uint8, width, height int) []uint8 {
+				dst, _, err := convolveImage(src, width, height, k, method)
+				if err != nil {
+					t.Fatalf("convolveImage(%s): %v", method, err)
+				}
+				return dst
+			},
+		}
+	}
+	point := func(op string, amount float64) stage {
+		return stage{
+			func(b *pipelineBuilder) error { return b.addPoint(op, amount) },
+			func(src []uint8, width, height int) []uint8 { return pointReference(t, src, op, amount) },
+		}
+	}
+	svd := stage{
+		func(b *pipelineBuilder) error { b.addSVD(8, defaultSVDOptions()); return nil },
+		func(src []uint8, width, height int) []uint8 {
+			return compressSVD(src, int32(width), int32(height), 8, defaultSVDOptions())
+		},
+	}
+
+	stages := []stage{
+		point(pointGamma, 1.4), // A table stage ahead of any convolution
+		filter("blur"),
+		kernel(gaussian, convMethodSeparable),
+		point(pointContrast, 1.3), // Fused into the Gaussian's bands
+		point(pointBrightness, -10),
+		kernel(box, convMethodSAT), // Barrier
+		filter("sharpen"),
+		kernel(direct, convMethodDirect),
+		point(pointInvert, 0),
+		svd, // Barrier
+		filter("emboss"),
+	}
+
+	// Heights that are not a multiple of the band height, and one below a single band
+	for _, size := range [][2]int{{45, 2*pipelineBandRows + 19}, {37, 5}} {
+		width, height := size[0], size[1]
+		src := randomImage(width, height, int64(height))
+		b := &pipelineBuilder{}
+		want := src
+		for _, s := range stages {
+			if err := s.add(b); err != nil {
+				t.Fatalf("adding a stage: %v", err)
+			}
+			want = s.apply(want, width, height)
+		}
+
+		got := make([]uint8, len(src))
+		if err := runPipelineInto(got, src, width, height, b.stages); err != nil {
+			t.Fatalf("runPipelineInto: %v", err)
+		}
+		for i := range want {
+			if got[i] != want[i] {
+				t.Fatalf("%dx%d: byte %d (row %d, channel %d) = %d, stage by stage gives %d",
+					width, height, i, i/(width*4), i%4, got[i], want[i])
+			}
+		}
+	}
+}
@@ -0,0 +1,151 @@
+package main
+
+import (
+	"sync"
+	"unsafe"
+
+	"gonum.org/v1/gonum/mat"
+)
+
+// Planar (structure-of-arrays) images and pooled plane buffers.
+//
+// The JavaScript side hands over interleaved RGBA bytes, but SVD factors whole
+// channels and most per-channel loops vectorize best over contiguous values. A
+// planarImage holds each channel in its own contiguous float64 plane, which backs a
+// gonum matrix directly (denseView), so no per-pixel Set/At calls are needed. Planes
+// that never reach gonum (SVD reconstructions, convolution scratch) are float32, at
+// half the memory. Planes come from byte-bounded pools reused across calls, so
+// repeated operations on the same image size do not allocate full-size buffers.
+
+// planarImage stores width x height pixels as up to four channel planes; planes of
+// absent channels are nil.
+type planarImage struct {
+	width, height int
+	planes        [4][]float64
+}
+
+// Pool limits, per element type. Planes over maxPooledPlaneBytes (an 8-megapixel
+// float64 or 16-megapixel float32 plane) are never kept: one huge image would
+// otherwise pin its buffers for the life of the module, and the wasm heap never
+// shrinks. The free list as a whole holds at most maxPooledBytes.
+const (
+	maxPooledPlaneBytes = 64 << 20
+	maxPooledBytes      = 160 << 20
+)
+
+// planePool is a free list of plane buffers of one element type.
+type planePool[T any] struct {
+	mu    sync.Mutex
+	free  [][]T
+	bytes int // Total capacity of free, in bytes
+}
+
+// float64Planes back gonum matrices; everything else uses float32Planes.
+var (
+	float64Planes planePool[float64]
+	float32Planes planePool[float32]
+)
+
+// sizeOf returns the capacity of buf in bytes.
+func (p *planePool[T]) sizeOf(buf []T) int {
+	var zero T
+	return cap(buf) * int(unsafe.Sizeof(zero))
+}
+
+// get returns a buffer of n elements, reusing the smallest free buffer that fits.
+// The contents are not cleared.
+func (p *planePool[T]) get(n int) []T {
+	p.mu.Lock()
+	best := -1
+	for i, buf := range p.free {
+		if cap(buf) >= n && (best < 0 || cap(buf) < cap(p.free[best])) {
+			best = i
+		}
+	}
+	if best >= 0 {
+		buf := p.free[best]
+		p.remove(best)
+		p.mu.Unlock()
+		return buf[:n]
+	}
+	p.mu.Unlock()
+	return make([]T, n)
+}
+
+// put returns buf to the pool. Buffers over maxPooledPlaneBytes are dropped. When the
+// pool would exceed maxPooledBytes, smaller buffers are dropped first, so the pool
+// keeps the sizes most likely to be requested again.
+func (p *planePool[T]) put(buf []T) {
+	size := p.sizeOf(buf)
+	if size == 0 || size > maxPooledPlaneBytes {
+		return
+	}
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	for p.bytes+size > maxPooledBytes {
+		smallest := 0
+		for i, b := range p.free {
+			if cap(b) < cap(p.free[smallest]) {
+				smallest = i
+			}
+		}
+		if cap(p.free[smallest]) >= cap(buf) {
+			return
+		}
+		p.remove(smallest)
+	}
+	p.free = append(p.free, buf)
+	p.bytes += size
+}
+
+// remove drops free[i]; p.mu must be held.
+func (p *planePool[T]) remove(i int) {
+	p.bytes -= p.sizeOf(p.free[i])
+	p.free[i] = p.free[len(p.free)-1]
+	p.free[len(p.free)-1] = nil
+	p.free = p.free[:len(p.free)-1]
+}
+
+// newPlanarImage returns an image with pooled (uncleared) planes for the channels in
+// channels. Call release when done with it.
+func newPlanarImage(width, height int, channels [4]bool) *planarImage {
+	img := &planarImage{width: width, height: height}
+	for c, present := range channels {
+		if present {
+			img.planes[c] = float64Planes.get(width * height)
+		}
+	}
+	return img
+}
+
+// release returns the planes to their pool; img must not be used afterwards.
+func (img *planarImage) release() {
+	for c, plane := range img.planes {
+		float64Planes.put(plane)
+		img.planes[c] = nil
+	}
+}
+
+// planarFromRGBA splits the channels selected in channels out of interleaved RGBA data.
+func planarFromRGBA(data []uint8, width, height int, channels [4]bool) *planarImage {
+	img := newPlanarImage(width, height, channels)
+	parallelRows(height, func(startY, endY int) {
+		for c, plane := range img.planes {
+			if plane == nil {
+				continue
+			}
+			// One channel at a time: a strided read and a contiguous write per row
+			src := data[startY*width*4 : endY*width*4]
+			dst := plane[startY*width : endY*width]
+			for p := range dst {
+				dst[p] = float64(src[p*4+c])
+			}
+		}
+	})
+	return img
+}
+
+// denseView wraps plane c as a height x width matrix sharing its storage.
+func denseView(img *planarImage, c int) *mat.Dense {
+	return mat.NewDense(img.height, img.width, img.planes[c])
+}
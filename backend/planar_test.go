@@ -0,0 +1,33 @@
+package main
+
+import "testing"
+
+func TestPlanePoolBounds(t *testing.T) {
+	var pool planePool[float32]
+	// Over the per-plane cap: dropped
+	pool.put(make([]float32, maxPooledPlaneBytes/4+1))
+	if len(pool.free) != 0 {
+		t.Fatalf("pooled a %d-byte plane over the %d-byte cap", maxPooledPlaneBytes+4, maxPooledPlaneBytes)
+	}
+
+	// Full-cap planes: the pool stops at maxPooledBytes
+	for i := 0; i < 2*maxPooledBytes/maxPooledPlaneBytes; i++ {
+		pool.put(make([]float32, maxPooledPlaneBytes/4))
+		if pool.bytes > maxPooledBytes {
+			t.Fatalf("pool holds %d bytes, over the %d-byte budget", pool.bytes, maxPooledBytes)
+		}
+	}
+
+	// A small plane does not displace larger ones, and get reuses a fitting plane
+	pool.put(make([]float32, 16))
+	if got := pool.get(1000); cap(got) != maxPooledPlaneBytes/4 {
+		t.Errorf("get reused a buffer of capacity %d, want %d", cap(got), maxPooledPlaneBytes/4)
+	}
+	total := 0
+	for _, b := range pool.free {
+		total += pool.sizeOf(b)
+	}
+	if total != pool.bytes {
+		t.Errorf("pool accounts %d bytes, free list holds %d", pool.bytes, total)
+	}
+}
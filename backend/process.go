@@ -0,0 +1,252 @@
+//go:build !js
+// +build !js
+
+package main
+
+import (
+	"bytes"
+	"encoding/json"
+	"flag"
+	"fmt"
+	"image"
+	"image/draw"
+	_ "image/gif" // Register decoders for image.Decode
+	_ "image/jpeg"
+	"image/png"
+	"io"
+	"os"
+	"path/filepath"
+	"runtime"
+	"strings"
+	"sync"
+	"time"
+)
+
+// Native batch processing (go run . process) and the shared image plumbing of the HTTP
+// service (serve.go).
+//
+// Images are decoded with the standard library, run through runPipelineInto, the same
+// code the browser engine runs, and written as PNG. Operations are the JSON form of
+// the frontend's EngineOp (see spec.go); single operations run as one-stage pipelines.
+// Several images are processed at once on top of the per-image row parallelism: the
+// pipeline path keeps no per-call global state (no stats recorder, cancel token or SVD
+// factor cache), and built stages are only read, so one set serves every image.
+
+// Extensions picked up when an input is a directory
+var imageExtensions = map[string]bool{".png": true, ".jpg": true, ".jpeg": true, ".gif": true}
+
+// PNG output favours throughput; the engine's results are usually re-encoded downstream
+var pngEncoder = png.Encoder{CompressionLevel: png.BestSpeed}
+
+// parseOpSpec builds the pipeline stages of an operation given as JSON.
+func parseOpSpec(data []byte) ([]pipelineStage, error) {
+	var spec opSpec
+	if err := json.Unmarshal(data, &spec); err != nil {
+		return nil, fmt.Errorf("invalid operation JSON: %v", err)
+	}
+	return spec.pipeline()
+}
+
+// errTooManyPixels reports an image whose declared size exceeds the pixel limit.
+type errTooManyPixels struct {
+	width, height, limit int
+}
+
+func (e *errTooManyPixels) Error() string {
+	return fmt.Sprintf("image is %dx%d, more than the %d pixel limit", e.width, e.height, e.limit)
+}
+
+// decodeRGBA decodes an image into tightly packed, non-premultiplied RGBA, the layout
+// the browser hands the engine. With maxPixels > 0 the size in the header is checked
+// first, so a small file declaring a huge image fails before its pixels are allocated.
+func decodeRGBA(r io.Reader, maxPixels int) (*image.NRGBA, error) {
+	if maxPixels > 0 {
+		// Replay the bytes DecodeConfig consumed (only the header) ahead of the rest
+		var header bytes.Buffer
+		cfg, _, err := image.DecodeConfig(io.TeeReader(r, &header))
+		if err != nil {
+			return nil, err
+		}
+		if cfg.Width <= 0 || cfg.Height <= 0 || cfg.Width > maxPixels/max(cfg.Height, 1) {
+			return nil, &errTooManyPixels{cfg.Width, cfg.Height, maxPixels}
+		}
+		r = io.MultiReader(&header, r)
+	}
+	img, _, err := image.Decode(r)
+	if err != nil {
+		return nil, err
+	}
+	b := img.Bounds()
+	if n, ok := img.(*image.NRGBA); ok && b.Min == (image.Point{}) && n.Stride == 4*b.Dx() {
+		return n, nil
+	}
+	out := image.NewNRGBA(image.Rect(0, 0, b.Dx(), b.Dy()))
+	draw.Draw(out, out.Rect, img, b.Min, draw.Src)
+	return out, nil
+}
+
+// processImage runs stages on src and returns the result as a new image.
+func processImage(src *image.NRGBA, stages []pipelineStage) (*image.NRGBA, error) {
+	dst := image.NewNRGBA(src.Rect)
+	if err := runPipelineInto(dst.Pix, src.Pix, src.Rect.Dx(), src.Rect.Dy(), stages); err != nil {
+		return nil, err
+	}
+	return dst, nil
+}
+
+// readOpFlag returns the -op argument: inline JSON, or @path to read it from a file.
+func readOpFlag(value string) ([]byte, error) {
+	if path, ok := strings.CutPrefix(value, "@"); ok {
+		return os.ReadFile(path)
+	}
+	return []byte(value), nil
+}
+
+// collectInputs expands directories (one level) into their image files.
+func collectInputs(args []string) ([]string, error) {
+	var files []string
+	for _, arg := range args {
+		info, err := os.Stat(arg)
+		if err != nil {
+			return nil, err
+		}
+		if !info.IsDir() {
+			files = append(files, arg)
+			continue
+		}
+		entries, err := os.ReadDir(arg)
+		if err != nil {
+			return nil, err
+		}
+		for _, e := range entries {
+			if !e.IsDir() && imageExtensions[strings.ToLower(filepath.Ext(e.Name()))] {
+				files = append(files, filepath.Join(arg, e.Name()))
+			}
+		}
+	}
+	return files, nil
+}
+
+// outputPaths maps each input to dir/<stem>.png, suffixing stems that collide.
+func outputPaths(files []string, dir string) []string {
+	used := make(map[string]bool)
+	paths := make([]string, len(files))
+	for i, file := range files {
+		stem := strings.TrimSuffix(filepath.Base(file), filepath.Ext(file))
+		name := stem + ".png"
+		for n := 2; used[name]; n++ {
+			name = fmt.Sprintf("%s-%d.png", stem, n)
+		}
+		used[name] = true
+		paths[i] = filepath.Join(dir, name)
+	}
+	return paths
+}
+
+// processFile decodes in, applies stages and writes the PNG result to out.
+func processFile(in, out string, stages []pipelineStage) error {
+	f, err := os.Open(in)
+	if err != nil {
+		return err
+	}
+	src, err := decodeRGBA(f, 0)
+	f.Close()
+	if err != nil {
+		return err
+	}
+	dst, err := processImage(src, stages)
+	if err != nil {
+		return err
+	}
+	w, err := os.Create(out)
+	if err != nil {
+		return err
+	}
+	if err := pngEncoder.Encode(w, dst); err != nil {
+		w.Close()
+		return err
+	}
+	return w.Close()
+}
+
+func runProcess(args []string) int {
+	fs := flag.NewFlagSet("process", flag.ExitOnError)
+	opFlag := fs.String("op", "", `operation as JSON or @file.json, e.g. '{"op":"applyFilter","filterType":"blur"}'`)
+	outFlag := fs.String("out", "out", "output directory")
+	workersFlag := fs.Int("workers", runtime.NumCPU(), "images processed at once (bounds memory)")
+	verboseFlag := fs.Bool("v", false, "print the engine's progress messages")
+	fs.Usage = func() {
+		fmt.Fprintln(fs.Output(), "usage: go run . process -op <json|@file> [-out dir] [-workers n] <image or directory>...")
+		fs.PrintDefaults()
+	}
+	fs.Parse(args)
+	setLogging(*verboseFlag)
+
+	if *opFlag == "" || fs.NArg() == 0 {
+		fs.Usage()
+		return 2
+	}
+	opJSON, err := readOpFlag(*opFlag)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "reading -op: %v\n", err)
+		return 2
+	}
+	stages, err := parseOpSpec(opJSON)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		return 2
+	}
+	files, err := collectInputs(fs.Args())
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		return 2
+	}
+	if len(files) == 0 {
+		fmt.Fprintln(os.Stderr, "no input images")
+		return 2
+	}
+	if err := os.MkdirAll(*outFlag, 0o755); err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		return 1
+	}
+	outputs := outputPaths(files, *outFlag)
+
+	// A fixed set of workers takes files from a channel, so at most -workers images
+	// are decoded at any time
+	start := time.Now()
+	indices := make(chan int)
+	var failed int
+	var mu sync.Mutex // Serializes the report lines and failed
+	var wg sync.WaitGroup
+	for w := 0; w < max(1, min(*workersFlag, len(files))); w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range indices {
+				fileStart := time.Now()
+				err := processFile(files[i], outputs[i], stages)
+				mu.Lock()
+				if err != nil {
+					failed++
+					fmt.Fprintf(os.Stderr, "%s: %v\n", files[i], err)
+				} else {
+					fmt.Printf("%s -> %s (%v)\n", files[i], outputs[i], time.Since(fileStart).Round(time.Millisecond))
+				}
+				mu.Unlock()
+			}
+		}()
+	}
+	for i := range files {
+		indices <- i
+	}
+	close(indices)
+	wg.Wait()
+
+	elapsed := time.Since(start)
+	fmt.Printf("%d image(s) in %v (%.1f images/s), %d failed\n",
+		len(files), elapsed.Round(time.Millisecond), float64(len(files))/elapsed.Seconds(), failed)
+	if failed > 0 {
+		return 1
+	}
+	return 0
+}
@@ -0,0 +1,164 @@
+package main
+
+import (
+	"math"
+	"math/rand"
+
+	"gonum.org/v1/gonum/mat"
+)
+
+// SVD methods selectable from JavaScript via the compressSVD options object.
+const (
+	svdMethodFull       = "full"       // Exact factorization of the whole channel matrix
+	svdMethodRandomized = "randomized" // Randomized range finder, computes only the leading triplets
+)
+
+// Defaults for the randomized method. A handful of oversampling vectors and two
+// power iterations are enough for photographic images, whose spectra decay quickly.
+const (
+	defaultSVDOversampling    = 10
+	defaultSVDPowerIterations = 2
+	randomizedSVDSeed         = 42 // Fixed seed so repeated runs produce identical output
+)
+
+// previewSVDPowerIterations bounds the subspace iterations of progressive previews,
+// which only need to look right for the moment they are on screen.
+const previewSVDPowerIterations = 1
+
+// svdOptions selects how factorChannel obtains the truncated factors.
+type svdOptions struct {
+	Method          string  // svdMethodFull or svdMethodRandomized
+	Oversampling    int     // Extra sample vectors drawn beyond the target rank (randomized only)
+	PowerIterations int     // Subspace iterations that sharpen the sampled basis (randomized only)
+	Channels        [4]bool // R, G, B, A channels to compress; the others are copied unchanged
+	BlockSize       int     // Block edge for block-wise SVD; 0 factors whole channels
+	Energy          float64 // Energy fraction each block retains (block-wise only)
+	ColorSpace      string  // svdColorSpaceRGB or svdColorSpaceYCbCr
+	ChromaRank      int     // Rank of the Cb/Cr planes in YCbCr mode; 0 derives it from rank
+	Target          string  // "" uses rank directly; otherwise a target of svd_rank.go, capped by rank
+	TargetValue     float64 // Value of Target: energy fraction, PSNR in dB or container bytes
+}
+
+// previewSVDOptions returns opts adjusted for a fast approximate preview.
+func previewSVDOptions(opts svdOptions) svdOptions {
+	opts.Method = svdMethodRandomized
+	opts.PowerIterations = min(opts.PowerIterations, previewSVDPowerIterations)
+	return opts
+}
+
+// defaultSVDOptions returns the options used when JavaScript does not pass any.
+func defaultSVDOptions() svdOptions {
+	return svdOptions{
+		Method:          svdMethodFull,
+		Oversampling:    defaultSVDOversampling,
+		PowerIterations: defaultSVDPowerIterations,
+		Channels:        [4]bool{true, true, true, true},
+		Energy:          defaultSVDEnergy,
+		ColorSpace:      svdColorSpaceRGB,
+	}
+}
+
+// randomizedSVD computes the top-k singular triplets of a using a randomized
+// range finder with power iterations (Halko, Martinsson & Tropp).
+// It returns U_k (rows x k), the k leading singular values and V_k (cols x k).
+// Memory and time scale with k + oversampling rather than with min(rows, cols)².
+func randomizedSVD(a *mat.Dense, k, oversampling, powerIterations int) (*mat.Dense, []float64, *mat.Dense, bool) {
+	rows, cols := a.Dims()
+	l := min(k+oversampling, min(rows, cols)) // Width of the sampled subspace
+	if k <= 0 || l < k {
+		return nil, nil, nil, false
+	}
+
+	// Gaussian test matrix Ω (cols x l)
+	rng := rand.New(rand.NewSource(randomizedSVDSeed))
+	omega := mat.NewDense(cols, l, nil)
+	omegaData := omega.RawMatrix().Data
+	for i := range omegaData {
+		omegaData[i] = rng.NormFloat64()
+	}
+
+	// Sample the range: Y = A * Ω (rows x l), then orthonormalize into Q
+	var q, z mat.Dense
+	q.Mul(a, omega)
+	orthonormalizeColumns(&q)
+
+	// Power iterations: Q <- orth(A * orth(A^T * Q)), re-orthonormalizing each
+	// half step so that small singular directions are not lost to rounding.
+	for i := 0; i < powerIterations; i++ {
+		z.Mul(a.T(), &q) // z = A^T * Q (cols x l)
+		orthonormalizeColumns(&z)
+		q.Mul(a, &z) // Q = A * z (rows x l)
+		orthonormalizeColumns(&q)
+	}
+
+	// Project A onto the sampled basis: B = Q^T * A (l x cols) is small enough to factor exactly
+	var b mat.Dense
+	b.Mul(q.T(), a)
+
+	var svd mat.SVD
+	if ok := svd.Factorize(&b, mat.SVDThin); !ok {
+		return nil, nil, nil, false
+	}
+	var ub, vb mat.Dense
+	svd.UTo(&ub)         // ub is (l x l)
+	svd.VTo(&vb)         // vb is (cols x l)
+	s := svd.Values(nil) // l singular values, descending
+
+	// Lift the left singular vectors back to the full space: U_k = Q * ub[:, :k]
+	var u mat.Dense
+	u.Mul(&q, ub.Slice(0, l, 0, k))
+	v := vb.Slice(0, cols, 0, k).(*mat.Dense)
+
+	return &u, s[:k], v, true
+}
+
+// orthonormalizeColumns replaces the columns of m with an orthonormal basis of
+// their span using modified Gram-Schmidt, run twice for numerical stability.
+// Rows are walked contiguously so the row-major storage stays cache friendly.
+// Columns that turn out (numerically) dependent are zeroed.
+func orthonormalizeColumns(m *mat.Dense) {
+	raw := m.RawMatrix()
+	rows, cols, stride, data := raw.Rows, raw.Cols, raw.Stride, raw.Data
+	dots := make([]float64, cols)
+
+	for pass := 0; pass < 2; pass++ {
+		for j := 0; j < cols; j++ {
+			// Normalize column j
+			norm := 0.0
+			for r := 0; r < rows; r++ {
+				v := data[r*stride+j]
+				norm += v * v
+			}
+			norm = math.Sqrt(norm)
+			scale := 0.0
+			if norm > 1e-10 {
+				scale = 1 / norm
+			}
+			for r := 0; r < rows; r++ {
+				data[r*stride+j] *= scale
+			}
+			if j+1 == cols {
+				continue
+			}
+
+			// Remove the column j component from every later column
+			for c := j + 1; c < cols; c++ {
+				dots[c] = 0
+			}
+			for r := 0; r < rows; r++ {
+				row := data[r*stride : r*stride+cols]
+				qj := row[j]
+				for c := j + 1; c < cols; c++ {
+					dots[c] += qj * row[c]
+				}
+			}
+			for r := 0; r < rows; r++ {
+				row := data[r*stride : r*stride+cols]
+				qj := row[j]
+				for c := j + 1; c < cols; c++ {
+					row[c] -= dots[c] * qj
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,105 @@
+//go:build !js
+// +build !js
+
+package main
+
+import (
+	"errors"
+	"flag"
+	"fmt"
+	"log"
+	"net/http"
+	"os"
+	"runtime"
+	"time"
+)
+
+// Native HTTP service (go run . serve).
+//
+//	POST /process?op=<operation JSON>   body: PNG, JPEG or GIF   response: PNG
+//	GET  /healthz
+//
+// The operation has the same JSON form as for go run . process. A fixed number of
+// requests is processed at once; the others wait for a slot (or give up when the
+// client disconnects), so memory stays bounded under load. Bodies are decoded only
+// once a slot is free, and only after the size in their header passed -max-pixels.
+
+func runServe(args []string) int {
+	fs := flag.NewFlagSet("serve", flag.ExitOnError)
+	addrFlag := fs.String("addr", ":8080", "listen address")
+	workersFlag := fs.Int("workers", runtime.NumCPU(), "requests processed at once (bounds memory)")
+	maxBytesFlag := fs.Int64("max-bytes", 64<<20, "largest accepted request body")
+	maxPixelsFlag := fs.Int("max-pixels", maxImagePixels, "largest accepted image in pixels (width x height)")
+	verboseFlag := fs.Bool("v", false, "print the engine's progress messages")
+	fs.Parse(args)
+	setLogging(*verboseFlag)
+
+	slots := make(chan struct{}, max(1, *workersFlag))
+	mux := http.NewServeMux()
+	mux.HandleFunc("GET /healthz", func(w http.ResponseWriter, r *http.Request) {
+		fmt.Fprintln(w, "ok")
+	})
+	mux.HandleFunc("POST /process", func(w http.ResponseWriter, r *http.Request) {
+		handleProcess(w, r, slots, *maxBytesFlag, *maxPixelsFlag)
+	})
+
+	// WriteTimeout bounds a request from its headers to the end of the response,
+	// queueing and processing included
+	server := &http.Server{
+		Addr:              *addrFlag,
+		Handler:           mux,
+		ReadHeaderTimeout: 10 * time.Second,
+		WriteTimeout:      5 * time.Minute,
+		IdleTimeout:       2 * time.Minute,
+	}
+	log.Printf("TinyIMG service listening on %s with %d worker(s)", *addrFlag, cap(slots))
+	if err := server.ListenAndServe(); err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		return 1
+	}
+	return 0
+}
+
+// handleProcess runs one /process request once a slot in slots is free.
+func handleProcess(w http.ResponseWriter, r *http.Request, slots chan struct{}, maxBytes int64, maxPixels int) {
+	start := time.Now()
+	stages, err := parseOpSpec([]byte(r.URL.Query().Get("op")))
+	if err != nil {
+		http.Error(w, err.Error(), http.StatusBadRequest)
+		return
+	}
+
+	select {
+	case slots <- struct{}{}:
+		defer func() { <-slots }()
+	case <-r.Context().Done():
+		return // Client gave up while waiting
+	}
+	queued := time.Since(start)
+
+	src, err := decodeRGBA(http.MaxBytesReader(w, r.Body, maxBytes), maxPixels)
+	if err != nil {
+		var tooLarge *http.MaxBytesError
+		var tooManyPixels *errTooManyPixels
+		if errors.As(err, &tooLarge) {
+			http.Error(w, fmt.Sprintf("image larger than %d bytes", maxBytes), http.StatusRequestEntityTooLarge)
+		} else if errors.As(err, &tooManyPixels) {
+			http.Error(w, err.Error(), http.StatusRequestEntityTooLarge)
+		} else {
+			http.Error(w, fmt.Sprintf("decoding image: %v", err), http.StatusBadRequest)
+		}
+		return
+	}
+	dst, err := processImage(src, stages)
+	if err != nil {
+		http.Error(w, err.Error(), http.StatusUnprocessableEntity)
+		return
+	}
+	w.Header().Set("Content-Type", "image/png")
+	if err := pngEncoder.Encode(w, dst); err != nil {
+		log.Printf("writing response: %v", err)
+		return
+	}
+	log.Printf("%s %dx%d in %v (queued %v)", r.URL.Query().Get("op"), src.Rect.Dx(), src.Rect.Dy(),
+		time.Since(start).Round(time.Millisecond), queued.Round(time.Millisecond))
+}
@@ -0,0 +1,215 @@
+//go:build js && wasm
+// +build js,wasm
+
+package main
+
+import (
+	"fmt"
+	"syscall/js"
+	"time"
+	"unsafe"
+)
+
+// Shared buffers are persistent Go-owned pixel buffers that JavaScript accesses
+// through Uint8ClampedArray views on the module's linear memory. The frontend
+// writes the source image into the "source" buffer once; the *Shared exports then
+// read it in place and write into the "result" buffer, so no per-call copies or
+// allocations cross the JS/Go boundary. Buffers only reallocate when they must grow.
+//
+// The Go GC does not move objects, so the returned pointers stay valid while the
+// buffers are referenced here. Growing the wasm memory detaches ArrayBuffers on the
+// JS side, so callers must rebuild their views from { ptr, length } after every call.
+const (
+	sharedSourceBuffer = "source"
+	sharedResultBuffer = "result"
+)
+
+var sharedBuffers = map[string][]uint8{}
+
+// ensureSharedBuffer returns the named buffer resliced to n bytes, allocating only if it must grow.
+func ensureSharedBuffer(name string, n int) []uint8 {
+	buf := sharedBuffers[name]
+	if cap(buf) < n {
+		buf = make([]uint8, n)
+		logf("Shared buffer '%s' allocated: %d bytes\n", name, n)
+	}
+	buf = buf[:n]
+	sharedBuffers[name] = buf
+	return buf
+}
+
+// sharedBufferInfo describes a buffer as { ptr, length } for building a JS view.
+func sharedBufferInfo(buf []uint8) js.Value {
+	ptr := 0
+	if len(buf) > 0 {
+		ptr = int(uintptr(unsafe.Pointer(&buf[0])))
+	}
+	info := js.Global().Get("Object").New()
+	info.Set("ptr", ptr)
+	info.Set("length", len(buf))
+	return info
+}
+
+// getSharedBufferWrapper expects a buffer name ("source" or "result") and a byte length.
+// It returns { ptr, length } for the (possibly grown) buffer or an error object.
+// Requesting the source buffer invalidates the SVD factor cache, so callers must do so
+// before every new image they write into it.
+func getSharedBufferWrapper(this js.Value, args []js.Value) interface{} {
+	if len(args) < 2 || args[0].Type() != js.TypeString || args[1].Type() != js.TypeNumber {
+		return createError("Invalid arguments for getSharedBuffer: expected (name: string, byteLength: number)")
+	}
+	name := args[0].String()
+	if name != sharedSourceBuffer && name != sharedResultBuffer {
+		return createError(fmt.Sprintf("Unknown shared buffer '%s': expected 'source' or 'result'", name))
+	}
+	n := args[1].Int()
+	if n < 0 {
+		return createError("Invalid byteLength for getSharedBuffer: expected a non-negative number")
+	}
+	if name == sharedSourceBuffer {
+		// The caller is about to write a new image; cached SVD factors describe the old one
+		invalidateSVDCache()
+	}
+	return sharedBufferInfo(ensureSharedBuffer(name, n))
+}
+
+// sharedImageBuffers validates (width, height) arguments against the source buffer and
+// returns the source pixels together with a result buffer of the same size.
+func sharedImageBuffers(fn string, args []js.Value) (src, dst []uint8, width, height int, errObj interface{}) {
+	if len(args) < 2 || args[0].Type() != js.TypeNumber || args[1].Type() != js.TypeNumber {
+		return nil, nil, 0, 0, createError(fmt.Sprintf("Invalid arguments for %s: expected (width, height, ...)", fn))
+	}
+	width, height = args[0].Int(), args[1].Int()
+	n := width * height * 4
+	source := sharedBuffers[sharedSourceBuffer]
+	if width <= 0 || height <= 0 || len(source) < n {
+		return nil, nil, 0, 0, createError(fmt.Sprintf("%s: source buffer holds %d bytes, expected %d for %dx%d", fn, len(source), n, width, height))
+	}
+	return source[:n], ensureSharedBuffer(sharedResultBuffer, n), width, height, nil
+}
+
+// applyFilterSharedWrapper expects (width, height, filterType) and filters the shared
+// source buffer into the shared result buffer. It returns the result { ptr, length }.
+func applyFilterSharedWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("applyFilterShared")
+	defer endStats()
+	src, dst, width, height, errObj := sharedImageBuffers("applyFilterShared", args)
+	if errObj != nil {
+		return errObj
+	}
+	if len(args) < 3 || args[2].Type() != js.TypeString {
+		return createError("Invalid filterType argument for applyFilterShared: expected a string")
+	}
+
+	applyFilterInto(dst, src, width, height, args[2].String())
+	statsPhase(phaseConvolve)
+
+	logf("applyFilterSharedWrapper completed in %v\n", time.Since(startTime))
+	return sharedBufferInfo(dst)
+}
+
+// applyKernelSharedWrapper expects (width, height, kernel) with the kernel spec of
+// applyKernel and convolves the shared source buffer into the shared result buffer.
+func applyKernelSharedWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("applyKernelShared")
+	defer endStats()
+	src, dst, width, height, errObj := sharedImageBuffers("applyKernelShared", args)
+	if errObj != nil {
+		return errObj
+	}
+	if len(args) < 3 {
+		return createError("Invalid number of arguments for applyKernelShared: expected 3 (width, height, kernel)")
+	}
+	kernel, method, err := parseKernelSpec(args[2])
+	if err != nil {
+		return createError(fmt.Sprintf("Invalid kernel argument: %v", err))
+	}
+
+	usedMethod, err := convolveImageInto(dst, src, width, height, kernel, method)
+	if err != nil {
+		return createError(fmt.Sprintf("applyKernelShared failed: %v", err))
+	}
+	statsPhase(phaseConvolve)
+
+	logf("applyKernelSharedWrapper: %dx%d kernel via %s completed in %v\n", kernel.width, kernel.height, usedMethod, time.Since(startTime))
+	return sharedBufferInfo(dst)
+}
+
+// compressSVDSharedWrapper expects (width, height, rank, options?) with the options of
+// compressSVD and compresses the shared source buffer into the shared result buffer.
+// Whole-channel RGB factors are cached, so calls that only change rank skip factorization.
+func compressSVDSharedWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("compressSVDShared")
+	defer endStats()
+	src, dst, width, height, errObj := sharedImageBuffers("compressSVDShared", args)
+	if errObj != nil {
+		return errObj
+	}
+	rank, opts, errObj := sharedSVDArgs("compressSVDShared", args)
+	if errObj != nil {
+		return errObj
+	}
+
+	if opts.BlockSize > 0 || opts.ColorSpace == svdColorSpaceYCbCr {
+		compressSVDInto(dst, src, int32(width), int32(height), int32(rank), opts)
+	} else {
+		compressSVDCachedInto(dst, src, int32(width), int32(height), int32(rank), opts)
+	}
+
+	logf("compressSVDSharedWrapper completed in %v\n", time.Since(startTime))
+	return sharedBufferInfo(dst)
+}
+
+// sharedSVDArgs parses the (rank, options?) arguments that follow (width, height).
+func sharedSVDArgs(fn string, args []js.Value) (int, svdOptions, interface{}) {
+	if len(args) < 3 || !args[2].Truthy() || args[2].Type() != js.TypeNumber {
+		return 0, svdOptions{}, createError(fmt.Sprintf("Invalid rank argument for %s: expected a number", fn))
+	}
+	opts := defaultSVDOptions()
+	if len(args) > 3 {
+		var errMsg string
+		if opts, errMsg = parseSVDOptions(args[3]); errMsg != "" {
+			return 0, opts, createError(errMsg)
+		}
+	}
+	return args[2].Int(), opts, nil
+}
+
+// compressSVDPreviewSharedWrapper expects the arguments of compressSVDShared and writes a
+// quick, approximate rank-r reconstruction for progressive display: the factors come
+// from the randomized method with fewer power iterations and bypass the cache.
+func compressSVDPreviewSharedWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("compressSVDPreviewShared")
+	defer endStats()
+	src, dst, width, height, errObj := sharedImageBuffers("compressSVDPreviewShared", args)
+	if errObj != nil {
+		return errObj
+	}
+	rank, opts, errObj := sharedSVDArgs("compressSVDPreviewShared", args)
+	if errObj != nil {
+		return errObj
+	}
+
+	compressSVDInto(dst, src, int32(width), int32(height), int32(rank), previewSVDOptions(opts))
+
+	logf("compressSVDPreviewSharedWrapper: rank %d completed in %v\n", rank, time.Since(startTime))
+	return sharedBufferInfo(dst)
+}
+
+// svdCacheReadyWrapper expects the arguments of compressSVDShared and reports whether
+// that call would be served from cached factors, i.e. would only reconstruct.
+func svdCacheReadyWrapper(this js.Value, args []js.Value) interface{} {
+	src, _, width, height, errObj := sharedImageBuffers("svdCacheReady", args)
+	if errObj != nil {
+		return errObj
+	}
+	rank, opts, errObj := sharedSVDArgs("svdCacheReady", args)
+	if errObj != nil {
+		return errObj
+	}
+	return svdCacheReady(src, width, height, rank, opts)
+}
@@ -0,0 +1,67 @@
+package main
+
+// SIMD128 kernels hosted outside Go (simd/kernels.wat).
+//
+// Go's wasm backend only emits scalar instructions. When the browser supports wasm
+// SIMD, the host instantiates simd/kernels.wasm against this module's linear memory
+// and registers its exports (setSIMDKernels), which sets the hooks below; the kernels
+// then work on Go-owned slices in place. Natively, or without SIMD support, the hooks
+// stay nil and the portable loops run.
+var (
+	// simdFilter3x3 convolves the interior pixels (1 <= x < width-1) of the interior
+	// rows within [startY, endY); only called for kernels with simdOK and width >= 6.
+	simdFilter3x3 func(dst, src []uint8, width, height, startY, endY int, k *intKernel)
+	// simdLowRankPanel sets out[y*cols+x] = Σ_{i<r} us[y*r+i] * v[x*k+i].
+	simdLowRankPanel func(out, us, v []float64, k, r, rows, cols int)
+)
+
+// simdMinWidth is the narrowest image the SIMD filter handles: one 4-pixel group
+// between the two border columns.
+const simdMinWidth = 6
+
+// simdParams reports whether the SIMD filter reproduces toByte for the kernel: every
+// reachable sum must fit in 16 bits, and for divisor > 1 the 16-bit reciprocal mul
+// must round ((2*sum + divisor) * mul) >> 16 exactly like the 32-bit one.
+func simdParams(weights [9]int32, divisor int32) (mul uint16, ok bool) {
+	var pos, neg int32
+	for _, w := range weights {
+		if w > 0 {
+			pos += 255 * w
+		} else {
+			neg += 255 * w
+		}
+	}
+	if pos > 32767 || neg < -32768 {
+		return 0, false
+	}
+	if divisor == 1 {
+		return 0, true
+	}
+	if 2*pos+divisor > 32767 {
+		return 0, false
+	}
+	m := (65536 + 2*divisor - 1) / (2 * divisor)
+	for s := int32(0); s <= pos; s++ {
+		t := 2*s + divisor
+		if (t*m)>>16 != t/(2*divisor) {
+			return 0, false
+		}
+	}
+	return uint16(m), true
+}
+
+// convolveRowsSIMD is convolveRows with the interior handed to simdFilter3x3; the
+// one-pixel border strip is computed here with clamped coordinates.
+func convolveRowsSIMD(dst, src []uint8, width, height, startY, endY int, k *intKernel) {
+	simdFilter3x3(dst, src, width, height, startY, endY, k)
+	for y := startY; y < endY; y++ {
+		if y == 0 || y == height-1 {
+			for x := 0; x < width; x++ {
+				convolvePixelClamped(dst, src, width, height, x, y, k)
+			}
+			continue
+		}
+		convolvePixelClamped(dst, src, width, height, 0, y, k)
+		convolvePixelClamped(dst, src, width, height, width-1, y, k)
+	}
+}
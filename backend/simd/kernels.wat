@@ -0,0 +1,517 @@
+;; SIMD128 kernels for the Go engine (see ../simd.go).
+;;
+;; Go's wasm backend emits scalar code only, so the hottest inner loops are written
+;; here by hand. The module imports the Go instance's linear memory and works on
+;; Go-owned buffers in place, addressed by the pointers Go passes in; it has no state
+;; of its own. Build with wabt (SIMD is enabled by default):
+;;
+;;   wat2wasm kernels.wat -o ../../frontend/public/simd_kernels.wasm
+;;
+;; build.sh does this when wat2wasm is installed.
+
+(module
+  (import "env" "memory" (memory 0))
+
+  ;; filter3x3 convolves the interior pixels (1 <= x < width-1) of the rows
+  ;; [max(y0, 1), min(y1, height-1)) of the RGBA image at $src into $dst, 4 pixels
+  ;; (16 bytes) per step. RGB follow the fixed-point rules of convolve.go bit for bit:
+  ;; with $mul = 0 the sum is clamped to [0, 255] (divisor 1); otherwise a positive
+  ;; sum becomes ((2*sum + $div) * $mul) >> 16, which the caller has checked equals
+  ;; round-half-up(sum / $div) for every reachable sum. Alpha is copied. Sums must fit
+  ;; in 16 bits and width must be at least 6; row borders are left to the caller.
+  (func (export "filter3x3")
+    (param $src i32) (param $dst i32) (param $width i32) (param $height i32)
+    (param $y0 i32) (param $y1 i32)
+    (param $k0 i32) (param $k1 i32) (param $k2 i32) (param $k3 i32) (param $k4 i32) (param $k5 i32) (param $k6 i32) (param $k7 i32) (param $k8 i32)
+    (param $div i32) (param $mul i32)
+    (local $stride i32) (local $y i32) (local $yEnd i32) (local $x i32) (local $xLast i32)
+    (local $up i32) (local $mid i32) (local $down i32)
+    (local $w0 v128) (local $w1 v128) (local $w2 v128) (local $w3 v128) (local $w4 v128) (local $w5 v128) (local $w6 v128) (local $w7 v128) (local $w8 v128)
+    (local $p v128) (local $lo v128) (local $hi v128) (local $a v128) (local $b v128)
+    (local $vdiv v128) (local $vmul v128) (local $alpha v128)
+
+    local.get $width
+    i32.const 4
+    i32.mul
+    local.set $stride
+    local.get $k0
+    i16x8.splat
+    local.set $w0
+    local.get $k1
+    i16x8.splat
+    local.set $w1
+    local.get $k2
+    i16x8.splat
+    local.set $w2
+    local.get $k3
+    i16x8.splat
+    local.set $w3
+    local.get $k4
+    i16x8.splat
+    local.set $w4
+    local.get $k5
+    i16x8.splat
+    local.set $w5
+    local.get $k6
+    i16x8.splat
+    local.set $w6
+    local.get $k7
+    i16x8.splat
+    local.set $w7
+    local.get $k8
+    i16x8.splat
+    local.set $w8
+    local.get $div
+    i16x8.splat
+    local.set $vdiv
+    local.get $mul
+    i16x8.splat
+    local.set $vmul
+    i32.const 0xff000000
+    i32x4.splat
+    local.set $alpha
+
+    ;; Interior rows: y = max(y0, 1) .. min(y1, height-1)
+    local.get $y0
+    i32.const 1
+    local.get $y0
+    i32.const 1
+    i32.gt_s
+    select
+    local.set $y
+    local.get $y1
+    local.get $height
+    i32.const 1
+    i32.sub
+    local.tee $yEnd
+    local.get $y1
+    local.get $yEnd
+    i32.lt_s
+    select
+    local.set $yEnd
+    ;; The last 4-pixel group starts at width-5, overlapping its predecessor
+    local.get $width
+    i32.const 5
+    i32.sub
+    local.set $xLast
+
+    block $rowsDone
+      loop $rows
+        local.get $y
+        local.get $yEnd
+        i32.ge_s
+        br_if $rowsDone
+
+        i32.const 1
+        local.set $x
+        loop $cols
+          ;; Taps start at pixel x-1 of rows y-1, y and y+1
+          local.get $src
+          local.get $y
+          i32.const 1
+          i32.sub
+          local.get $stride
+          i32.mul
+          i32.add
+          local.get $x
+          i32.const 1
+          i32.sub
+          i32.const 4
+          i32.mul
+          i32.add
+          local.tee $up
+          local.get $stride
+          i32.add
+          local.tee $mid
+          local.get $stride
+          i32.add
+          local.set $down
+
+        ;; Tap (-1, -1)
+        local.get $up
+        v128.load offset=0
+        local.set $p
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w0
+        i16x8.mul
+        local.set $lo
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w0
+        i16x8.mul
+        local.set $hi
+        ;; Tap (-1, +0)
+        local.get $up
+        v128.load offset=4
+        local.set $p
+        local.get $lo
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w1
+        i16x8.mul
+        i16x8.add
+        local.set $lo
+        local.get $hi
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w1
+        i16x8.mul
+        i16x8.add
+        local.set $hi
+        ;; Tap (-1, +1)
+        local.get $up
+        v128.load offset=8
+        local.set $p
+        local.get $lo
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w2
+        i16x8.mul
+        i16x8.add
+        local.set $lo
+        local.get $hi
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w2
+        i16x8.mul
+        i16x8.add
+        local.set $hi
+        ;; Tap (+0, -1)
+        local.get $mid
+        v128.load offset=0
+        local.set $p
+        local.get $lo
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w3
+        i16x8.mul
+        i16x8.add
+        local.set $lo
+        local.get $hi
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w3
+        i16x8.mul
+        i16x8.add
+        local.set $hi
+        ;; Tap (+0, +0)
+        local.get $mid
+        v128.load offset=4
+        local.set $p
+        local.get $lo
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w4
+        i16x8.mul
+        i16x8.add
+        local.set $lo
+        local.get $hi
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w4
+        i16x8.mul
+        i16x8.add
+        local.set $hi
+        ;; Tap (+0, +1)
+        local.get $mid
+        v128.load offset=8
+        local.set $p
+        local.get $lo
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w5
+        i16x8.mul
+        i16x8.add
+        local.set $lo
+        local.get $hi
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w5
+        i16x8.mul
+        i16x8.add
+        local.set $hi
+        ;; Tap (+1, -1)
+        local.get $down
+        v128.load offset=0
+        local.set $p
+        local.get $lo
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w6
+        i16x8.mul
+        i16x8.add
+        local.set $lo
+        local.get $hi
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w6
+        i16x8.mul
+        i16x8.add
+        local.set $hi
+        ;; Tap (+1, +0)
+        local.get $down
+        v128.load offset=4
+        local.set $p
+        local.get $lo
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w7
+        i16x8.mul
+        i16x8.add
+        local.set $lo
+        local.get $hi
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w7
+        i16x8.mul
+        i16x8.add
+        local.set $hi
+        ;; Tap (+1, +1)
+        local.get $down
+        v128.load offset=8
+        local.set $p
+        local.get $lo
+        local.get $p
+        i16x8.extend_low_i8x16_u
+        local.get $w8
+        i16x8.mul
+        i16x8.add
+        local.set $lo
+        local.get $hi
+        local.get $p
+        i16x8.extend_high_i8x16_u
+        local.get $w8
+        i16x8.mul
+        i16x8.add
+        local.set $hi
+
+          ;; Round and clamp to bytes
+          local.get $mul
+          if
+            ;; Negative sums give 0; the 32-bit products are exact
+            local.get $lo
+            v128.const i16x8 0 0 0 0 0 0 0 0
+            i16x8.max_s
+            i32.const 1
+            i16x8.shl
+            local.get $vdiv
+            i16x8.add
+            local.tee $lo
+            local.get $vmul
+            i32x4.extmul_low_i16x8_u
+            i32.const 16
+            i32x4.shr_u
+            local.get $lo
+            local.get $vmul
+            i32x4.extmul_high_i16x8_u
+            i32.const 16
+            i32x4.shr_u
+            i16x8.narrow_i32x4_u
+            local.set $lo
+            local.get $hi
+            v128.const i16x8 0 0 0 0 0 0 0 0
+            i16x8.max_s
+            i32.const 1
+            i16x8.shl
+            local.get $vdiv
+            i16x8.add
+            local.tee $hi
+            local.get $vmul
+            i32x4.extmul_low_i16x8_u
+            i32.const 16
+            i32x4.shr_u
+            local.get $hi
+            local.get $vmul
+            i32x4.extmul_high_i16x8_u
+            i32.const 16
+            i32x4.shr_u
+            i16x8.narrow_i32x4_u
+            local.set $hi
+          end
+          ;; Saturating narrow: negative lanes become 0, lanes above 255 become 255
+          local.get $lo
+          local.get $hi
+          i8x16.narrow_i16x8_u
+          local.set $p
+
+          ;; Keep the source alpha of the centre pixels and store 16 bytes
+          local.get $dst
+          local.get $mid
+          local.get $src
+          i32.sub
+          i32.add
+          local.get $mid
+          v128.load offset=4
+          local.get $p
+          local.get $alpha
+          v128.bitselect
+          v128.store offset=4
+
+          ;; Next group; the final one is shifted back to end exactly at width-1
+          local.get $x
+          local.get $xLast
+          i32.lt_s
+          if
+            local.get $x
+            i32.const 4
+            i32.add
+            local.tee $x
+            local.get $xLast
+            local.get $x
+            local.get $xLast
+            i32.lt_s
+            select
+            local.set $x
+            br $cols
+          end
+        end
+
+        local.get $y
+        i32.const 1
+        i32.add
+        local.set $y
+        br $rows
+      end
+    end
+  )
+
+  ;; lowRankPanel fills the rows x cols float64 panel at $out (row-major) with
+  ;; out[y][x] = sum over i < r of us[y*r + i] * v[x*k + i], two terms per step.
+  ;; $us holds the panel's rows of U with Σ folded in (r per row), $v the panel's rows
+  ;; of V (k per row). Pairwise lane sums may differ from a sequential sum in the last
+  ;; bit.
+  (func (export "lowRankPanel")
+    (param $us i32) (param $v i32) (param $k i32) (param $r i32)
+    (param $rows i32) (param $cols i32) (param $out i32)
+    (local $y i32) (local $x i32) (local $i i32) (local $pairs i32)
+    (local $a i32) (local $b i32) (local $acc v128) (local $sum f64)
+
+    ;; Bytes covered by whole pairs of terms
+    local.get $r
+    i32.const -2
+    i32.and
+    i32.const 8
+    i32.mul
+    local.set $pairs
+
+    i32.const 0
+    local.set $y
+    block $rowsDone
+      loop $rows
+        local.get $y
+        local.get $rows
+        i32.ge_s
+        br_if $rowsDone
+
+        i32.const 0
+        local.set $x
+        block $colsDone
+          loop $cols
+            local.get $x
+            local.get $cols
+            i32.ge_s
+            br_if $colsDone
+
+            ;; a = &us[y*r], b = &v[x*k]
+            local.get $us
+            local.get $y
+            local.get $r
+            i32.mul
+            i32.const 8
+            i32.mul
+            i32.add
+            local.set $a
+            local.get $v
+            local.get $x
+            local.get $k
+            i32.mul
+            i32.const 8
+            i32.mul
+            i32.add
+            local.set $b
+
+            v128.const f64x2 0 0
+            local.set $acc
+            i32.const 0
+            local.set $i
+            block $termsDone
+              loop $terms
+                local.get $i
+                local.get $pairs
+                i32.ge_s
+                br_if $termsDone
+                local.get $acc
+                local.get $a
+                local.get $i
+                i32.add
+                v128.load
+                local.get $b
+                local.get $i
+                i32.add
+                v128.load
+                f64x2.mul
+                f64x2.add
+                local.set $acc
+                local.get $i
+                i32.const 16
+                i32.add
+                local.set $i
+                br $terms
+              end
+            end
+
+            local.get $acc
+            f64x2.extract_lane 0
+            local.get $acc
+            f64x2.extract_lane 1
+            f64.add
+            local.set $sum
+            ;; Odd rank: one remaining term
+            local.get $r
+            i32.const 1
+            i32.and
+            if
+              local.get $sum
+              local.get $a
+              local.get $pairs
+              i32.add
+              f64.load
+              local.get $b
+              local.get $pairs
+              i32.add
+              f64.load
+              f64.mul
+              f64.add
+              local.set $sum
+            end
+
+            local.get $out
+            local.get $y
+            local.get $cols
+            i32.mul
+            local.get $x
+            i32.add
+            i32.const 8
+            i32.mul
+            i32.add
+            local.get $sum
+            f64.store
+
+            local.get $x
+            i32.const 1
+            i32.add
+            local.set $x
+            br $cols
+          end
+        end
+
+        local.get $y
+        i32.const 1
+        i32.add
+        local.set $y
+        br $rows
+      end
+    end
+  )
+)
@@ -0,0 +1,45 @@
+//go:build js && wasm
+// +build js,wasm
+
+package main
+
+import (
+	"syscall/js"
+	"unsafe"
+)
+
+// JavaScript binding for the SIMD kernels (see simd.go).
+
+func bytesAddr(b []uint8) uintptr {
+	return uintptr(unsafe.Pointer(unsafe.SliceData(b)))
+}
+
+func floatsAddr(f []float64) uintptr {
+	return uintptr(unsafe.Pointer(unsafe.SliceData(f)))
+}
+
+// setSIMDKernelsWrapper expects the exports of simd/kernels.wasm, instantiated with
+// this module's memory as env.memory, or null to return to the scalar loops.
+func setSIMDKernelsWrapper(this js.Value, args []js.Value) interface{} {
+	if len(args) < 1 || args[0].IsNull() || args[0].IsUndefined() {
+		simdFilter3x3, simdLowRankPanel = nil, nil
+		return nil
+	}
+	filter, panel := args[0].Get("filter3x3"), args[0].Get("lowRankPanel")
+	if filter.Type() != js.TypeFunction || panel.Type() != js.TypeFunction {
+		return createError("Invalid argument for setSIMDKernels: expected the exports of simd_kernels.wasm")
+	}
+	simdFilter3x3 = func(dst, src []uint8, width, height, startY, endY int, k *intKernel) {
+		callArgs := make([]interface{}, 0, 17)
+		callArgs = append(callArgs, bytesAddr(src), bytesAddr(dst), width, height, startY, endY)
+		for _, w := range k.weights {
+			callArgs = append(callArgs, w)
+		}
+		filter.Invoke(append(callArgs, k.divisor, k.simdMul)...)
+	}
+	simdLowRankPanel = func(out, us, v []float64, k, r, rows, cols int) {
+		panel.Invoke(floatsAddr(us), floatsAddr(v), k, r, rows, cols, floatsAddr(out))
+	}
+	logln("SIMD kernels enabled.")
+	return nil
+}
@@ -0,0 +1,256 @@
+package main
+
+import (
+	"errors"
+	"fmt"
+	"math"
+)
+
+// Operation specs shared by the JavaScript bindings and the native tools.
+//
+// The JS wrappers read their arguments into these structs and the native CLI and
+// server decode them from JSON; either way the same validation runs and the same
+// core code executes. Field names and JSON tags follow the frontend's EngineOp,
+// PipelineStage and KernelSpec types (frontend/src/lib/engineProtocol.ts), so an
+// operation built in the browser can be sent to the native service unchanged.
+
+// kernelSpec describes a custom kernel: dense weights (row-major, width x height,
+// square by default) or a separable row/column pair.
+type kernelSpec struct {
+	Weights   []float64 `json:"weights"`
+	Width     int       `json:"width"`  // 0 derives a square size from len(Weights)
+	Height    int       `json:"height"` // 0 derives a square size from len(Weights)
+	Row       []float64 `json:"row"`
+	Column    []float64 `json:"column"`
+	Normalize bool      `json:"normalize"`
+	Method    string    `json:"method"` // "" selects convMethodAuto
+}
+
+// build converts s into a convKernel and the requested method.
+func (s *kernelSpec) build() (*convKernel, string, error) {
+	var kernel *convKernel
+	var err error
+	switch {
+	case len(s.Weights) > 0:
+		size := int(math.Round(math.Sqrt(float64(len(s.Weights)))))
+		width, height := size, size
+		if s.Width > 0 {
+			width = s.Width
+		}
+		if s.Height > 0 {
+			height = s.Height
+		}
+		kernel, err = newDenseKernel(width, height, s.Weights)
+	case len(s.Row) > 0 && len(s.Column) > 0:
+		kernel, err = newSeparableKernel(s.Row, s.Column)
+	default:
+		return nil, "", errors.New("expected either weights or row and column")
+	}
+	if err != nil {
+		return nil, "", err
+	}
+	if s.Normalize {
+		kernel.normalize()
+	}
+	method := s.Method
+	if method == "" {
+		method = convMethodAuto
+	}
+	return kernel, method, nil
+}
+
+// svdOptionsSpec holds the optional compressSVD options; nil fields keep their defaults.
+type svdOptionsSpec struct {
+	Method          *string  `json:"method"`
+	Oversampling    *int     `json:"oversampling"`
+	PowerIterations *int     `json:"powerIterations"`
+	Channels        []int    `json:"channels"`
+	BlockSize       *int     `json:"blockSize"`
+	Energy          *float64 `json:"energy"`
+	ColorSpace      *string  `json:"colorSpace"`
+	ChromaRank      *int     `json:"chromaRank"`
+	Target          *string  `json:"target"`
+	TargetValue     *float64 `json:"targetValue"`
+}
+
+// resolve validates s and applies it on top of defaultSVDOptions. A nil s yields the defaults.
+func (s *svdOptionsSpec) resolve() (svdOptions, error) {
+	opts := defaultSVDOptions()
+	if s == nil {
+		return opts, nil
+	}
+	if s.Method != nil {
+		opts.Method = *s.Method
+		if opts.Method != svdMethodFull && opts.Method != svdMethodRandomized {
+			return opts, fmt.Errorf("Invalid options.method '%s': expected 'full' or 'randomized'", opts.Method)
+		}
+	}
+	if s.Oversampling != nil {
+		if *s.Oversampling < 0 {
+			return opts, errors.New("Invalid options.oversampling: expected a non-negative number")
+		}
+		opts.Oversampling = *s.Oversampling
+	}
+	if s.PowerIterations != nil {
+		if *s.PowerIterations < 0 {
+			return opts, errors.New("Invalid options.powerIterations: expected a non-negative number")
+		}
+		opts.PowerIterations = *s.PowerIterations
+	}
+	if s.Channels != nil {
+		if len(s.Channels) == 0 {
+			return opts, errors.New("Invalid options.channels: expected a non-empty array of channel indices (0-3)")
+		}
+		opts.Channels = [4]bool{}
+		for _, c := range s.Channels {
+			if c < 0 || c > 3 {
+				return opts, errors.New("Invalid options.channels: expected channel indices 0 (R) to 3 (A)")
+			}
+			opts.Channels[c] = true
+		}
+	}
+	if s.BlockSize != nil {
+		if *s.BlockSize < minSVDBlockSize || *s.BlockSize > maxSVDBlockSize {
+			return opts, fmt.Errorf("Invalid options.blockSize: expected a number between %d and %d", minSVDBlockSize, maxSVDBlockSize)
+		}
+		opts.BlockSize = *s.BlockSize
+	}
+	if s.Energy != nil {
+		if *s.Energy <= 0 || *s.Energy > 1 {
+			return opts, errors.New("Invalid options.energy: expected a number in (0, 1]")
+		}
+		opts.Energy = *s.Energy
+	}
+	if s.ColorSpace != nil {
+		opts.ColorSpace = *s.ColorSpace
+		if opts.ColorSpace != svdColorSpaceRGB && opts.ColorSpace != svdColorSpaceYCbCr {
+			return opts, fmt.Errorf("Invalid options.colorSpace '%s': expected 'rgb' or 'ycbcr'", opts.ColorSpace)
+		}
+	}
+	if s.ChromaRank != nil {
+		if *s.ChromaRank <= 0 {
+			return opts, errors.New("Invalid options.chromaRank: expected a positive number")
+		}
+		opts.ChromaRank = *s.ChromaRank
+	}
+	if s.Target != nil {
+		if err := resolveSVDTarget(&opts, *s.Target, s.TargetValue); err != nil {
+			return opts, err
+		}
+	}
+	return opts, nil
+}
+
+// resolveSVDTarget validates options.target and options.targetValue into opts.
+func resolveSVDTarget(opts *svdOptions, target string, value *float64) error {
+	if value == nil {
+		return errors.New("Invalid options.targetValue: expected a number for options.target")
+	}
+	switch target {
+	case svdTargetEnergy:
+		if *value <= 0 || *value > 1 {
+			return errors.New("Invalid options.targetValue: expected an energy fraction in (0, 1]")
+		}
+	case svdTargetPSNR, svdTargetBytes:
+		if *value <= 0 {
+			return fmt.Errorf("Invalid options.targetValue: expected a positive %s", map[string]string{svdTargetPSNR: "PSNR in dB", svdTargetBytes: "byte budget"}[target])
+		}
+	default:
+		return fmt.Errorf("Invalid options.target '%s': expected 'energy', 'psnr' or 'bytes'", target)
+	}
+	if opts.BlockSize > 0 || opts.ColorSpace == svdColorSpaceYCbCr {
+		return errors.New("Invalid options.target: only supported for whole-channel RGB compression (no block or YCbCr mode)")
+	}
+	opts.Target, opts.TargetValue = target, *value
+	return nil
+}
+
+// stageSpec is one pipeline stage:
+//   - { op: "filter", filterType }             builtin 3x3 filter
+//   - { op: "kernel", kernel }                 kernel spec of applyKernel
+//   - { op: "point", type, amount? }           brightness | contrast | gamma | invert | threshold
+//   - { op: "svd", rank, options? }            compressSVD with its options
+type stageSpec struct {
+	Op         string          `json:"op"`
+	FilterType string          `json:"filterType"`
+	Kernel     *kernelSpec     `json:"kernel"`
+	Type       string          `json:"type"`
+	Amount     float64         `json:"amount"`
+	Rank       int             `json:"rank"`
+	Options    *svdOptionsSpec `json:"options"`
+}
+
+// addTo validates the stage and appends it to b.
+func (s *stageSpec) addTo(b *pipelineBuilder) error {
+	switch s.Op {
+	case "filter":
+		return b.addFilter(s.FilterType)
+	case "kernel":
+		if s.Kernel == nil {
+			return errors.New("kernel is missing")
+		}
+		kernel, method, err := s.Kernel.build()
+		if err != nil {
+			return err
+		}
+		return b.addKernel(kernel, method)
+	case "point":
+		return b.addPoint(s.Type, s.Amount)
+	case "svd":
+		if s.Rank <= 0 {
+			return errors.New("rank must be a positive number")
+		}
+		opts, err := s.Options.resolve()
+		if err != nil {
+			return err
+		}
+		b.addSVD(s.Rank, opts)
+		return nil
+	default:
+		return fmt.Errorf("unknown op '%s'", s.Op)
+	}
+}
+
+// buildPipeline validates stage specs and fuses them into pipeline stages.
+func buildPipeline(specs []stageSpec) ([]pipelineStage, error) {
+	var b pipelineBuilder
+	for i := range specs {
+		if err := specs[i].addTo(&b); err != nil {
+			return nil, fmt.Errorf("operation %d: %v", i, err)
+		}
+	}
+	return b.stages, nil
+}
+
+// opSpec is one engine operation, as in the frontend's EngineOp: applyFilter,
+// applyKernel, compressSVD, or applyPipeline with a list of stages.
+type opSpec struct {
+	stageSpec
+	Stages []stageSpec `json:"stages"`
+}
+
+// Pipeline stage equivalent to each single-step operation
+var opStages = map[string]string{
+	"applyFilter": "filter",
+	"applyKernel": "kernel",
+	"compressSVD": "svd",
+}
+
+// pipeline returns s as pipeline stages. Single operations become one-stage pipelines,
+// which run the same kernels as the dedicated exports.
+func (s *opSpec) pipeline() ([]pipelineStage, error) {
+	if s.Op == "applyPipeline" {
+		return buildPipeline(s.Stages)
+	}
+	stageOp, ok := opStages[s.Op]
+	if !ok {
+		return nil, fmt.Errorf("unknown op '%s': expected applyFilter, applyKernel, compressSVD or applyPipeline", s.Op)
+	}
+	stage := s.stageSpec
+	stage.Op = stageOp
+	var b pipelineBuilder
+	if err := stage.addTo(&b); err != nil {
+		return nil, err
+	}
+	return b.stages, nil
+}
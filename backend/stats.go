@@ -0,0 +1,147 @@
+package main
+
+import (
+	"fmt"
+	"runtime"
+	"time"
+)
+
+// Engine telemetry: structured per-call statistics and switchable console logging.
+//
+// Each exported call opens a recorder (beginStats) and closes it when it returns
+// (endStats); the core marks the end of each phase with statsPhase. The finished
+// record is kept as lastStats for getEngineStats. Memory statistics come from
+// runtime.ReadMemStats, sampled at every phase boundary so the heap high-water mark
+// also sees peaks inside a call. Calls are expected one at a time, as in the JS host,
+// and statsPhase is a no-op without an open recorder (e.g. in native benchmarks).
+
+// Phase names passed to statsPhase; copy phases are marked by the JS wrappers.
+const (
+	phaseCopyIn      = "copy-in"
+	phaseCopyOut     = "copy-out"
+	phaseFill        = "fill"
+	phaseFactorize   = "factorize"
+	phaseReconstruct = "reconstruct"
+	phaseConvolve    = "convolve"
+	phaseEncode      = "encode"
+	phaseDecode      = "decode"
+	phaseRender      = "render"
+	phaseBlocks      = "blocks" // Block SVD factors and reconstructs each block in one pass
+)
+
+// engineStats describes one finished call.
+type engineStats struct {
+	op                string
+	total             time.Duration
+	phases            []phaseTiming
+	bytesIn, bytesOut int            // Bytes copied between JavaScript and Go memory
+	mallocs           uint64         // Heap objects allocated during the call
+	allocBytes        uint64         // Heap bytes allocated during the call
+	heapInUse         uint64         // Live heap at the end of the call
+	heapSys           uint64         // Heap memory obtained from the host; wasm memory never shrinks
+	heapHighWater     uint64         // Largest live heap sampled since the module started
+	svd               *svdRankReport // Ranks chosen by a whole-channel SVD compression
+}
+
+type phaseTiming struct {
+	name string
+	d    time.Duration
+}
+
+// statsRecorder accumulates the stats of the call in progress.
+type statsRecorder struct {
+	stats       engineStats
+	start, mark time.Time
+	mem         runtime.MemStats
+}
+
+var (
+	loggingEnabled = true // Per-call progress logging; see setLogging
+	lastStats      engineStats
+	heapHighWater  uint64
+	activeStats    *statsRecorder
+)
+
+// setLogging turns the per-call progress messages (logf, logln) on or off.
+func setLogging(enabled bool) {
+	loggingEnabled = enabled
+}
+
+// logf prints a progress message when logging is enabled.
+func logf(format string, args ...interface{}) {
+	if loggingEnabled {
+		fmt.Printf(format, args...)
+	}
+}
+
+// logln prints a progress line when logging is enabled.
+func logln(args ...interface{}) {
+	if loggingEnabled {
+		fmt.Println(args...)
+	}
+}
+
+// beginStats opens the recorder for an exported call named op.
+func beginStats(op string) {
+	r := &statsRecorder{stats: engineStats{op: op}}
+	runtime.ReadMemStats(&r.mem)
+	sampleHeap(&r.mem)
+	r.start = time.Now()
+	r.mark = r.start
+	activeStats = r
+}
+
+// statsPhase ends the current phase of the open call under name.
+func statsPhase(name string) {
+	r := activeStats
+	if r == nil {
+		return
+	}
+	now := time.Now()
+	r.stats.phases = append(r.stats.phases, phaseTiming{name: name, d: now.Sub(r.mark)})
+	var m runtime.MemStats
+	runtime.ReadMemStats(&m)
+	sampleHeap(&m)
+	// ReadMemStats stops the world; keep its cost out of the next phase
+	r.mark = time.Now()
+}
+
+// statsBytes records bytes copied into and out of Go memory by the open call.
+func statsBytes(in, out int) {
+	if r := activeStats; r != nil {
+		r.stats.bytesIn += in
+		r.stats.bytesOut += out
+	}
+}
+
+// statsSVD records the ranks chosen by the open call.
+func statsSVD(report svdRankReport) {
+	if r := activeStats; r != nil {
+		r.stats.svd = &report
+	}
+}
+
+// endStats closes the open recorder and publishes its stats as lastStats.
+func endStats() {
+	r := activeStats
+	if r == nil {
+		return
+	}
+	activeStats = nil
+	r.stats.total = time.Since(r.start)
+	var m runtime.MemStats
+	runtime.ReadMemStats(&m)
+	sampleHeap(&m)
+	r.stats.mallocs = m.Mallocs - r.mem.Mallocs
+	r.stats.allocBytes = m.TotalAlloc - r.mem.TotalAlloc
+	r.stats.heapInUse = m.HeapAlloc
+	r.stats.heapSys = m.HeapSys
+	r.stats.heapHighWater = heapHighWater
+	lastStats = r.stats
+}
+
+func sampleHeap(m *runtime.MemStats) {
+	if m.HeapAlloc > heapHighWater {
+		heapHighWater = m.HeapAlloc
+	}
+}
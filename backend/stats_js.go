@@ -0,0 +1,88 @@
+//go:build js && wasm
+// +build js,wasm
+
+package main
+
+import (
+	"syscall/js"
+	"time"
+)
+
+// JavaScript bindings for engine telemetry (see stats.go).
+
+func durationMs(d time.Duration) float64 {
+	return float64(d) / float64(time.Millisecond)
+}
+
+// getEngineStatsWrapper returns the stats of the last completed call as
+// { op, totalMs, phases: [{ name, ms }], bytesIn, bytesOut, mallocs, allocBytes,
+// heapInUse, heapSys, heapHighWater, svd? }, or null before the first call.
+func getEngineStatsWrapper(this js.Value, args []js.Value) interface{} {
+	s := lastStats
+	if s.op == "" {
+		return js.Null()
+	}
+	phases := js.Global().Get("Array").New(len(s.phases))
+	for i, p := range s.phases {
+		phase := js.Global().Get("Object").New()
+		phase.Set("name", p.name)
+		phase.Set("ms", durationMs(p.d))
+		phases.SetIndex(i, phase)
+	}
+	info := js.Global().Get("Object").New()
+	info.Set("op", s.op)
+	info.Set("totalMs", durationMs(s.total))
+	info.Set("phases", phases)
+	info.Set("bytesIn", s.bytesIn)
+	info.Set("bytesOut", s.bytesOut)
+	info.Set("mallocs", float64(s.mallocs))
+	info.Set("allocBytes", float64(s.allocBytes))
+	info.Set("heapInUse", float64(s.heapInUse))
+	info.Set("heapSys", float64(s.heapSys))
+	info.Set("heapHighWater", float64(s.heapHighWater))
+	if s.svd != nil {
+		info.Set("svd", svdRankReportJS(s.svd))
+	}
+	return info
+}
+
+// svdRankReportJS converts r to { target?, targetValue?, met, ranks, energy, psnr, bytes,
+// termBytes, compressionRatio }; energy holds one array per channel, null for copied channels.
+func svdRankReportJS(r *svdRankReport) js.Value {
+	ranks := js.Global().Get("Array").New(len(r.ranks))
+	energy := js.Global().Get("Array").New(len(r.energy))
+	for c := range r.ranks {
+		ranks.SetIndex(c, r.ranks[c])
+		if r.energy[c] == nil {
+			energy.SetIndex(c, js.Null())
+			continue
+		}
+		curve := js.Global().Get("Array").New(len(r.energy[c]))
+		for i, e := range r.energy[c] {
+			curve.SetIndex(i, e)
+		}
+		energy.SetIndex(c, curve)
+	}
+	info := js.Global().Get("Object").New()
+	if r.target != "" {
+		info.Set("target", r.target)
+		info.Set("targetValue", r.targetValue)
+	}
+	info.Set("met", r.met)
+	info.Set("ranks", ranks)
+	info.Set("energy", energy)
+	info.Set("psnr", r.psnr)
+	info.Set("bytes", r.bytes)
+	info.Set("termBytes", r.termBytes)
+	info.Set("compressionRatio", r.ratio)
+	return info
+}
+
+// setEngineLoggingWrapper expects a boolean and turns per-call console logging on or off.
+func setEngineLoggingWrapper(this js.Value, args []js.Value) interface{} {
+	if len(args) < 1 || args[0].Type() != js.TypeBoolean {
+		return createError("Invalid argument for setEngineLogging: expected a boolean")
+	}
+	setLogging(args[0].Bool())
+	return nil
+}
@@ -0,0 +1,93 @@
+package main
+
+import (
+	"fmt"
+
+	"gonum.org/v1/gonum/mat"
+)
+
+// compressSVD performs SVD compression on image data (internal logic).
+// Takes raw pixel data, dimensions, target rank and SVD options. Returns compressed pixel data.
+func compressSVD(data []uint8, width, height int32, rank int32, opts svdOptions) []uint8 {
+	result := make([]uint8, len(data))
+	compressSVDInto(result, data, width, height, rank, opts)
+	return result
+}
+
+// compressSVDInto is compressSVD writing into a caller-owned buffer of len(data) bytes.
+func compressSVDInto(result, data []uint8, width, height int32, rank int32, opts svdOptions) {
+	// Constant channels (e.g. opaque alpha) are copied exactly instead of factored
+	opts = skipConstantChannels(data, opts)
+	if opts.ColorSpace == svdColorSpaceYCbCr && rank > 0 && int(rank) < min(int(width), int(height)) {
+		compressSVDYCbCrInto(result, data, int(width), int(height), int(rank), opts)
+		logln("YCbCr SVD Compression Finished.")
+		return
+	}
+	if opts.BlockSize > 0 && rank > 0 {
+		// Block mode: rank only caps the per-block rank, so it may exceed the block size
+		stats := compressSVDBlocksInto(result, data, int(width), int(height), int(rank), opts)
+		statsPhase(phaseBlocks)
+		avgRank := 0.0
+		if stats.Blocks > 0 {
+			avgRank = float64(stats.TotalRank) / float64(stats.Blocks)
+		}
+		logf("Block SVD Compression Finished: %d blocks of %dx%d, energy %.4f, average rank %.2f, %d coefficients\n",
+			stats.Blocks, opts.BlockSize, opts.BlockSize, opts.Energy, avgRank, stats.Coefficients)
+		return
+	}
+	// Validate rank: must be positive and less than min(width, height) for actual compression.
+	// With a target, rank only caps the chosen ranks, so a full-rank cap is allowed too
+	if opts.Target != "" && rank > 0 {
+		rank = int32(min(int(rank), min(int(width), int(height))))
+	} else if rank <= 0 || int(rank) >= min(int(width), int(height)) {
+		logf("SVD Compression skipped: rank %d is invalid or >= min(width, height) (%dx%d)\n", rank, width, height)
+		copy(result, data) // Return original data if rank is invalid or won't compress
+		return
+	}
+	logf("Starting SVD Compression: rank %d, dimensions %dx%d, method %s\n", rank, width, height, opts.Method)
+
+	// Split the selected channels into pooled planes, each backing one channel matrix
+	planes := planarFromRGBA(data, int(width), int(height), opts.Channels)
+	defer planes.release()
+	var channelMatrices [4]*mat.Dense
+	for c, plane := range planes.planes {
+		if plane != nil {
+			channelMatrices[c] = denseView(planes, c)
+		}
+	}
+	logln("Matrix filling complete.")
+	statsPhase(phaseFill)
+
+	// Factor each selected channel in parallel; only the truncated factors are kept
+	var factors [4]*svdFactors
+	parallelItems(len(channelMatrices), func(c int) {
+		m := channelMatrices[c]
+		if m == nil {
+			return
+		}
+		f, ok := factorChannel(m, int(rank), opts)
+		if !ok {
+			fmt.Printf("SVD Factorization failed for channel %d, keeping it exact.\n", c)
+			return
+		}
+		factors[c] = f
+	})
+	logln("SVD computation for all channels complete.")
+	report := selectSVDRanks(data, int(width), int(height), factors, int(rank), opts, svdQuantInt8)
+	logSVDRanks(report)
+	statsSVD(report)
+	statsPhase(phaseFactorize)
+
+	// Write bytes straight from U_kΣ_k and V_k in cache-sized panels (see low_rank.go);
+	// unselected and failed channels are copied through unchanged
+	copy(result, data)
+	for c, f := range factors {
+		if f != nil {
+			reconstructChannelInto(result, c, f, report.ranks[c])
+		}
+	}
+	logln("Result array rebuilding complete.")
+	statsPhase(phaseReconstruct)
+
+	logln("SVD Compression Finished.")
+}
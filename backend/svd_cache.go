@@ -0,0 +1,275 @@
+package main
+
+import (
+	"fmt"
+
+	"gonum.org/v1/gonum/mat"
+)
+
+// Persistent SVD factor cache for the shared-buffer path.
+//
+// Factorization dominates the cost of compressSVD, yet the rank slider only changes
+// how many triplets are summed. The cache keeps the top svdCacheRank factors of every
+// channel of the current source image together with a float32 accumulator holding the
+// current reconstruction U_r Σ_r V_rᵀ. A rank change from r to r' then adds or
+// subtracts the rank-1 terms σ_i u_i v_iᵀ for i in [min(r, r'), max(r, r')), which
+// costs |r' - r| passes over the channel instead of a refactorization.
+//
+// The cache is invalidated whenever the shared source buffer is handed out for a new
+// image (see invalidateSVDCache) and whenever the factorization options change.
+
+// svdCacheRank is the minimum number of triplets factored per channel, so any rank up
+// to the UI slider's maximum is served from the cache.
+const svdCacheRank = 100
+
+// svdFactors holds truncated factors of one rows x cols channel, row-major:
+// u is rows x k, v is cols x k.
+type svdFactors struct {
+	rows, cols, k int
+	u, s, v       []float64
+}
+
+// svdChannelState is the cached factorization and running reconstruction of one channel.
+type svdChannelState struct {
+	factors *svdFactors
+	acc     []float32 // rows*cols reconstruction at accRank
+	accRank int
+}
+
+// svdFactorCache is keyed by the source image dimensions and the options that affect
+// the factors; Channels, BlockSize, Energy and Target do not.
+type svdFactorCache struct {
+	valid           bool
+	width, height   int
+	method          string
+	oversampling    int
+	powerIterations int
+	channels        [4]*svdChannelState
+}
+
+var svdCache svdFactorCache
+
+// invalidateSVDCache drops all cached factors; call it before the source pixels change.
+func invalidateSVDCache() {
+	svdCache = svdFactorCache{}
+}
+
+// matches reports whether the cache holds factors for this image and options.
+func (c *svdFactorCache) matches(width, height int, opts svdOptions) bool {
+	return c.valid && c.width == width && c.height == height && c.method == opts.Method &&
+		c.oversampling == opts.Oversampling && c.powerIterations == opts.PowerIterations
+}
+
+// factorChannel computes the top k triplets of m with the method in opts.
+func factorChannel(m *mat.Dense, k int, opts svdOptions) (*svdFactors, bool) {
+	rows, cols := m.Dims()
+	k = min(k, min(rows, cols))
+
+	var u, v *mat.Dense
+	var s []float64
+	if opts.Method == svdMethodRandomized {
+		var ok bool
+		u, s, v, ok = randomizedSVD(m, k, opts.Oversampling, opts.PowerIterations)
+		if !ok {
+			return nil, false
+		}
+	} else {
+		var svd mat.SVD
+		// Thin factors suffice: only the leading columns of U and V are kept
+		if !svd.Factorize(m, mat.SVDThin) {
+			return nil, false
+		}
+		u, v = &mat.Dense{}, &mat.Dense{}
+		svd.UTo(u)
+		svd.VTo(v)
+		s = svd.Values(nil)
+	}
+
+	f := &svdFactors{rows: rows, cols: cols, k: k, u: make([]float64, rows*k), s: make([]float64, k), v: make([]float64, cols*k)}
+	copy(f.s, s[:k])
+	uRaw, vRaw := u.RawMatrix(), v.RawMatrix()
+	for y := 0; y < rows; y++ {
+		copy(f.u[y*k:(y+1)*k], uRaw.Data[y*uRaw.Stride:y*uRaw.Stride+k])
+	}
+	for x := 0; x < cols; x++ {
+		copy(f.v[x*k:(x+1)*k], vRaw.Data[x*vRaw.Stride:x*vRaw.Stride+k])
+	}
+	return f, true
+}
+
+// setRank moves the accumulator to rank r by adding or removing rank-1 terms, or by
+// rebuilding from zero when that touches fewer terms.
+func (st *svdChannelState) setRank(r int) {
+	f := st.factors
+	r = min(r, f.k)
+	if st.acc == nil {
+		st.acc = make([]float32, f.rows*f.cols)
+		st.accRank = 0
+	}
+	from, to, sign := st.accRank, r, float64(1)
+	if r < st.accRank-r {
+		// Rebuilding r terms beats removing accRank - r of them
+		clear(st.acc)
+		from = 0
+	} else if r < st.accRank {
+		from, to, sign = r, st.accRank, -1
+	}
+	if from == to {
+		st.accRank = r
+		return
+	}
+
+	k := f.k
+	parallelRows(f.rows, func(startY, endY int) {
+		for y := startY; y < endY; y++ {
+			urow := f.u[y*k : (y+1)*k]
+			accRow := st.acc[y*f.cols : (y+1)*f.cols]
+			for x := range accRow {
+				vrow := f.v[x*k : (x+1)*k]
+				sum := 0.0
+				for i := from; i < to; i++ {
+					sum += urow[i] * f.s[i] * vrow[i]
+				}
+				accRow[x] += float32(sign * sum)
+			}
+		}
+	})
+	if cancelled() {
+		// Skipped chunks left the accumulator inconsistent; rebuild it on next use
+		st.acc, st.accRank = nil, 0
+		return
+	}
+	st.accRank = r
+}
+
+// ensureSVDFactors makes the cache hold at least rank triplets of every channel selected
+// in opts for the w x h image data. Missing channels are factored in parallel to
+// max(rank, svdCacheRank); channels already cached are left alone.
+func ensureSVDFactors(data []uint8, w, h, rank int, opts svdOptions) {
+	if !svdCache.matches(w, h, opts) {
+		invalidateSVDCache()
+		svdCache = svdFactorCache{valid: true, width: w, height: h, method: opts.Method,
+			oversampling: opts.Oversampling, powerIterations: opts.PowerIterations}
+	}
+
+	var missing [4]bool
+	count := 0
+	for c, selected := range opts.Channels {
+		if selected && (svdCache.channels[c] == nil || svdCache.channels[c].factors.k < min(rank, min(w, h))) {
+			missing[c] = true
+			count++
+		}
+	}
+	if count == 0 {
+		logf("SVD cache hit: %dx%d, rank %d\n", w, h, rank)
+		return
+	}
+
+	k := max(rank, svdCacheRank)
+	logf("SVD cache miss: factoring %d channel(s) to rank %d (%dx%d, method %s)\n", count, min(k, min(w, h)), w, h, opts.Method)
+	factors := factorImageChannels(data, w, h, k, missing, opts)
+	stopped := cancelled()
+	for c := range factors {
+		if missing[c] {
+			if factors[c] == nil && stopped {
+				continue // Skipped by cancellation; factors that did complete are kept
+			}
+			if factors[c] == nil {
+				fmt.Printf("SVD Factorization failed for channel %d.\n", c)
+				svdCache.channels[c] = nil
+			} else {
+				svdCache.channels[c] = &svdChannelState{factors: factors[c]}
+			}
+		}
+	}
+}
+
+// svdCacheReady reports whether compressSVDCachedInto(data, w, h, rank, opts) would find
+// all the factors it needs in the cache. Block and YCbCr modes are never cached.
+func svdCacheReady(data []uint8, w, h, rank int, opts svdOptions) bool {
+	if opts.BlockSize > 0 || opts.ColorSpace == svdColorSpaceYCbCr {
+		return false
+	}
+	if rank <= 0 || (rank >= min(w, h) && opts.Target == "") {
+		return true // Copies the source without factoring
+	}
+	if !svdCache.matches(w, h, opts) {
+		return false
+	}
+	for c, selected := range opts.Channels {
+		if selected && !isConstantChannel(data, c) && (svdCache.channels[c] == nil || svdCache.channels[c].factors.k < min(rank, min(w, h))) {
+			return false
+		}
+	}
+	return true
+}
+
+// cachedSVDFactors returns the cached factors of the channels selected in opts;
+// unselected and unfactorable channels are nil.
+func cachedSVDFactors(opts svdOptions) [4]*svdFactors {
+	var factors [4]*svdFactors
+	for c, selected := range opts.Channels {
+		if st := svdCache.channels[c]; selected && st != nil {
+			factors[c] = st.factors
+		}
+	}
+	return factors
+}
+
+// factorImageChannels factors the top k triplets of each selected channel of the
+// w x h RGBA image in parallel. Failed or unselected channels are nil.
+func factorImageChannels(data []uint8, w, h, k int, selected [4]bool, opts svdOptions) [4]*svdFactors {
+	var channels []int
+	for c, ok := range selected {
+		if ok {
+			channels = append(channels, c)
+		}
+	}
+	var factors [4]*svdFactors
+	parallelItems(len(channels), func(i int) {
+		c := channels[i]
+		// factorChannel copies what it keeps, so the plane goes straight back to the pool
+		values := float64Planes.get(w * h)
+		defer float64Planes.put(values)
+		for p := range values {
+			values[p] = float64(data[p*4+c])
+		}
+		if f, ok := factorChannel(mat.NewDense(h, w, values), k, opts); ok {
+			factors[c] = f
+		}
+	})
+	return factors
+}
+
+// compressSVDCachedInto is compressSVDInto for the shared source buffer: factors are
+// computed on first use per channel and reused for every later rank.
+func compressSVDCachedInto(result, data []uint8, width, height int32, rank int32, opts svdOptions) {
+	w, h := int(width), int(height)
+	if opts.Target != "" && rank > 0 {
+		rank = int32(min(int(rank), min(w, h))) // Caps the chosen ranks (see compressSVDInto)
+	} else if rank <= 0 || int(rank) >= min(w, h) {
+		logf("SVD Compression skipped: rank %d is invalid or >= min(width, height) (%dx%d)\n", rank, width, height)
+		copy(result, data)
+		return
+	}
+	opts = skipConstantChannels(data, opts)
+	ensureSVDFactors(data, w, h, int(rank), opts)
+	factors := cachedSVDFactors(opts)
+	report := selectSVDRanks(data, w, h, factors, int(rank), opts, svdQuantInt8)
+	logSVDRanks(report)
+	statsSVD(report)
+	statsPhase(phaseFactorize)
+
+	copy(result, data)
+	for c, f := range factors {
+		if f == nil {
+			continue // Unselected or unfactorable channels keep their original values
+		}
+		st := svdCache.channels[c]
+		st.setRank(report.ranks[c])
+		for p, v := range st.acc {
+			result[p*4+c] = uint8(clampFloat64(float64(v)+0.5, 0, 255))
+		}
+	}
+	statsPhase(phaseReconstruct)
+}
@@ -0,0 +1,181 @@
+package main
+
+import (
+	"fmt"
+
+	"gonum.org/v1/gonum/mat"
+)
+
+// Channel handling for SVD compression: constant-channel detection and the
+// luma/chroma (YCbCr) mode.
+//
+// A constant channel (typically the alpha of an opaque JPEG) is rank 1 and is
+// reproduced exactly by copying it, so factoring it is wasted work. In YCbCr mode
+// the RGB channels are converted to BT.601 full-range luma and chroma. Luma keeps
+// the requested rank while the chroma planes are subsampled 2x2 (as in JPEG 4:2:0)
+// and factored at a lower rank: the eye is far less sensitive to chroma detail, and
+// quarter-size matrices make the chroma factorizations several times cheaper.
+
+// SVD colour spaces selectable from JavaScript via options.colorSpace.
+const (
+	svdColorSpaceRGB   = "rgb"
+	svdColorSpaceYCbCr = "ycbcr"
+)
+
+// defaultChromaRankDivisor derives the chroma rank from the luma rank when
+// options.chromaRank is not given.
+const defaultChromaRankDivisor = 4
+
+// isConstantChannel reports whether channel c has the same value in every RGBA pixel.
+func isConstantChannel(data []uint8, c int) bool {
+	if len(data) < 4 {
+		return true
+	}
+	first := data[c]
+	for i := c + 4; i < len(data); i += 4 {
+		if data[i] != first {
+			return false
+		}
+	}
+	return true
+}
+
+// skipConstantChannels deselects every constant channel in opts.Channels. Callers
+// copy unselected channels from the source, which is exact for constant ones.
+func skipConstantChannels(data []uint8, opts svdOptions) svdOptions {
+	for c, selected := range opts.Channels {
+		if selected && isConstantChannel(data, c) {
+			opts.Channels[c] = false
+			logf("Skipping SVD for constant channel %d (value %d)\n", c, data[c])
+		}
+	}
+	return opts
+}
+
+// chromaRankFor returns the rank used for the Cb and Cr planes.
+func chromaRankFor(rank int, opts svdOptions) int {
+	if opts.ChromaRank > 0 {
+		return opts.ChromaRank
+	}
+	return max(1, rank/defaultChromaRankDivisor)
+}
+
+// compressSVDYCbCrInto compresses data in YCbCr mode: luma at rank, 2x2-subsampled
+// chroma at chromaRankFor(rank), and alpha (if selected and not constant) at rank.
+// RGB are always compressed together; opts.Channels only decides about alpha.
+func compressSVDYCbCrInto(result, data []uint8, width, height, rank int, opts svdOptions) {
+	n := width * height
+	cw, ch := (width+1)/2, (height+1)/2
+	chromaRank := chromaRankFor(rank, opts)
+	logf("Starting YCbCr SVD Compression: luma rank %d, chroma rank %d (%dx%d), method %s\n", rank, chromaRank, cw, ch, opts.Method)
+
+	// Planes: 0 = Y, 1 = Cb, 2 = Cr (subsampled), 3 = A
+	// All planes come from the pool and go back to it once the result is written
+	y := float64Planes.get(n)
+	cb, cr := float64Planes.get(cw*ch), float64Planes.get(cw*ch)
+	defer float64Planes.put(y)
+	defer float64Planes.put(cb)
+	defer float64Planes.put(cr)
+	parallelRows(height, func(startY, endY int) {
+		for py := startY; py < endY; py++ {
+			for px := 0; px < width; px++ {
+				i := (py*width + px) * 4
+				r, g, b := float64(data[i]), float64(data[i+1]), float64(data[i+2])
+				y[py*width+px] = 0.299*r + 0.587*g + 0.114*b
+			}
+		}
+	})
+	parallelRows(ch, func(startY, endY int) {
+		for cy := startY; cy < endY; cy++ {
+			for cx := 0; cx < cw; cx++ {
+				// Box-average the (up to) 2x2 source pixels of this chroma sample
+				sumCb, sumCr, count := 0.0, 0.0, 0.0
+				for py := 2 * cy; py < min(2*cy+2, height); py++ {
+					for px := 2 * cx; px < min(2*cx+2, width); px++ {
+						i := (py*width + px) * 4
+						r, g, b := float64(data[i]), float64(data[i+1]), float64(data[i+2])
+						sumCb += 128 - 0.168736*r - 0.331264*g + 0.5*b
+						sumCr += 128 + 0.5*r - 0.418688*g - 0.081312*b
+						count++
+					}
+				}
+				cb[cy*cw+cx], cr[cy*cw+cx] = sumCb/count, sumCr/count
+			}
+		}
+	})
+
+	statsPhase(phaseFill)
+
+	type plane struct {
+		values      []float64
+		rows, cols  int
+		rank        int
+		reconstruct []float32
+	}
+	planes := []*plane{
+		{values: y, rows: height, cols: width, rank: rank},
+		{values: cb, rows: ch, cols: cw, rank: chromaRank},
+		{values: cr, rows: ch, cols: cw, rank: chromaRank},
+	}
+	compressAlpha := opts.Channels[3] && !isConstantChannel(data, 3)
+	if compressAlpha {
+		alpha := float64Planes.get(n)
+		defer float64Planes.put(alpha)
+		for p := range alpha {
+			alpha[p] = float64(data[p*4+3])
+		}
+		planes = append(planes, &plane{values: alpha, rows: height, cols: width, rank: rank})
+	}
+
+	parallelItems(len(planes), func(i int) {
+		p := planes[i]
+		k := min(p.rank, min(p.rows, p.cols))
+		// Reconstructions never reach gonum, so they are float32
+		p.reconstruct = float32Planes.get(p.rows * p.cols)
+		f, ok := factorChannel(mat.NewDense(p.rows, p.cols, p.values), k, opts)
+		if !ok {
+			fmt.Printf("SVD Factorization failed for YCbCr plane %d, keeping it exact.\n", i)
+			for j, v := range p.values {
+				p.reconstruct[j] = float32(v)
+			}
+			return
+		}
+		reconstructPlaneInto(p.reconstruct, f, f.k)
+	})
+	statsPhase(phaseFactorize)
+
+	ry, rcb, rcr := planes[0].reconstruct, planes[1].reconstruct, planes[2].reconstruct
+	parallelRows(height, func(startY, endY int) {
+		for py := startY; py < endY; py++ {
+			// Bilinear chroma upsampling: sample (cx, cy) sits at pixel (2cx + 0.5, 2cy + 0.5)
+			fy := clampFloat64((float64(py)-0.5)/2, 0, float64(ch-1))
+			y0 := int(fy)
+			y1, wy := min(y0+1, ch-1), fy-float64(y0)
+			for px := 0; px < width; px++ {
+				fx := clampFloat64((float64(px)-0.5)/2, 0, float64(cw-1))
+				x0 := int(fx)
+				x1, wx := min(x0+1, cw-1), fx-float64(x0)
+				lerp := func(plane []float32) float64 {
+					top := float64(plane[y0*cw+x0])*(1-wx) + float64(plane[y0*cw+x1])*wx
+					bottom := float64(plane[y1*cw+x0])*(1-wx) + float64(plane[y1*cw+x1])*wx
+					return top*(1-wy) + bottom*wy
+				}
+				lum, cbv, crv := float64(ry[py*width+px]), lerp(rcb)-128, lerp(rcr)-128
+
+				i := (py*width + px) * 4
+				result[i] = uint8(clampFloat64(lum+1.402*crv+0.5, 0, 255))
+				result[i+1] = uint8(clampFloat64(lum-0.344136*cbv-0.714136*crv+0.5, 0, 255))
+				result[i+2] = uint8(clampFloat64(lum+1.772*cbv+0.5, 0, 255))
+				if compressAlpha {
+					result[i+3] = uint8(clampFloat64(float64(planes[3].reconstruct[py*width+px])+0.5, 0, 255))
+				} else {
+					result[i+3] = data[i+3]
+				}
+			}
+		}
+	})
+	statsPhase(phaseReconstruct)
+	for _, p := range planes {
+		float32Planes.put(p.reconstruct)
+	}
+}
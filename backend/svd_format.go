@@ -0,0 +1,460 @@
+package main
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"math"
+)
+
+// TSVD container: truncated SVD factors of an RGBA image, quantized for storage.
+//
+// Layout (all integers little-endian):
+//
+//	header   magic "TSVD" | version u8 | quantization u8 | flags u8 | reserved u8 | width u32 | height u32
+//	channels 4 x { mode u8 | fill u8 | rank u16 }          (R, G, B, A)
+//	raw      for each channel with mode raw: width*height bytes, row-major
+//	terms    for i in [0, maxRank): for each factored channel c with rank_c > i: term(c, i)
+//	term     σ f32 | u (height values) | v (width values)
+//
+// A vector is int8 with a leading f32 scale (value = q * scale) or raw float16.
+// Terms are stored rank-major and interleaved across channels, so any prefix of the
+// stream decodes to a complete lower-rank approximation of every channel. That is
+// what lets svdStreamDecoder render progressively while bytes are still arriving.
+// Channels that are not factored are stored exactly: as a fill byte when every pixel
+// holds it, otherwise as raw bytes ahead of the terms.
+
+const (
+	svdContainerMagic      = "TSVD"
+	svdContainerVersion    = 1
+	svdContainerHeaderSize = 16
+	svdChannelEntrySize    = 4
+)
+
+// Factor quantizations
+const (
+	svdQuantInt8    = 1 // Per-vector f32 scale + int8 values
+	svdQuantFloat16 = 2 // IEEE 754 half precision
+)
+
+// Channel modes
+const (
+	svdChannelConstant = 0 // Every pixel holds the fill byte
+	svdChannelFactored = 1 // Reconstructed from the stored terms
+	svdChannelRaw      = 2 // Stored uncompressed ahead of the terms
+)
+
+// svdQuantizationNames maps the JavaScript option values to quantization ids.
+var svdQuantizationNames = map[string]uint8{
+	"int8":    svdQuantInt8,
+	"float16": svdQuantFloat16,
+}
+
+// svdVectorSize returns the encoded size in bytes of an n-element vector.
+func svdVectorSize(n int, quant uint8) int {
+	if quant == svdQuantInt8 {
+		return 4 + n
+	}
+	return 2 * n
+}
+
+// svdTermSize returns the encoded size in bytes of one term of a rows x cols channel.
+func svdTermSize(rows, cols int, quant uint8) int {
+	return 4 + svdVectorSize(rows, quant) + svdVectorSize(cols, quant)
+}
+
+// svdChannelModes returns how each channel of the RGBA image data is stored: factored
+// where factors are given, else constant when every pixel agrees, else raw.
+func svdChannelModes(data []uint8, factors [4]*svdFactors) [4]uint8 {
+	var modes [4]uint8
+	for c, f := range factors {
+		switch {
+		case f != nil:
+			modes[c] = svdChannelFactored
+		case isConstantChannel(data, c):
+			modes[c] = svdChannelConstant
+		default:
+			modes[c] = svdChannelRaw
+		}
+	}
+	return modes
+}
+
+// svdContainerSize returns the encoded size in bytes of a container with the given
+// channel modes and per-channel ranks (ignored for channels that are not factored).
+func svdContainerSize(width, height int, modes [4]uint8, ranks [4]int, quant uint8) int {
+	size := svdContainerHeaderSize + 4*svdChannelEntrySize
+	for c, mode := range modes {
+		switch mode {
+		case svdChannelFactored:
+			size += ranks[c] * svdTermSize(height, width, quant)
+		case svdChannelRaw:
+			size += width * height
+		}
+	}
+	return size
+}
+
+// appendSVDVector quantizes the stride-spaced values x[0], x[stride], ... (n of them).
+func appendSVDVector(out []byte, x []float64, n, stride int, quant uint8) []byte {
+	if quant == svdQuantInt8 {
+		maxAbs := 0.0
+		for i := 0; i < n; i++ {
+			maxAbs = math.Max(maxAbs, math.Abs(x[i*stride]))
+		}
+		scale := float32(maxAbs / 127)
+		out = binary.LittleEndian.AppendUint32(out, math.Float32bits(scale))
+		for i := 0; i < n; i++ {
+			q := 0.0
+			if scale > 0 {
+				q = math.Round(x[i*stride] / float64(scale))
+			}
+			out = append(out, byte(int8(math.Max(-127, math.Min(127, q)))))
+		}
+		return out
+	}
+	for i := 0; i < n; i++ {
+		out = binary.LittleEndian.AppendUint16(out, float32ToHalf(float32(x[i*stride])))
+	}
+	return out
+}
+
+// decodeSVDVector expands an encoded vector of len(dst) values into dst.
+func decodeSVDVector(dst []float32, p []byte, quant uint8) {
+	if quant == svdQuantInt8 {
+		scale := math.Float32frombits(binary.LittleEndian.Uint32(p))
+		for i := range dst {
+			dst[i] = float32(int8(p[4+i])) * scale
+		}
+		return
+	}
+	for i := range dst {
+		dst[i] = halfToFloat32(binary.LittleEndian.Uint16(p[2*i:]))
+	}
+}
+
+// encodeSVDContainer serializes the RGBA image data: the leading ranks[c] triplets of
+// factors[c] for every channel with non-nil factors, the other channels exactly. A
+// selected channel without factors means its factorization failed, which is an error.
+func encodeSVDContainer(data []uint8, width, height int, factors [4]*svdFactors, ranks [4]int, selected [4]bool, quant uint8) ([]byte, error) {
+	modes := svdChannelModes(data, factors)
+	maxRank := 0
+	for c, f := range factors {
+		if f == nil {
+			if selected[c] && modes[c] == svdChannelRaw {
+				return nil, fmt.Errorf("SVD factorization of channel %d failed", c)
+			}
+			ranks[c] = 0
+			continue
+		}
+		ranks[c] = min(ranks[c], f.k)
+		maxRank = max(maxRank, ranks[c])
+	}
+
+	out := make([]byte, 0, svdContainerSize(width, height, modes, ranks, quant))
+	out = append(out, svdContainerMagic...)
+	out = append(out, svdContainerVersion, quant, 0, 0)
+	out = binary.LittleEndian.AppendUint32(out, uint32(width))
+	out = binary.LittleEndian.AppendUint32(out, uint32(height))
+	for c, mode := range modes {
+		var fill uint8
+		if len(data) >= 4 {
+			fill = data[c]
+		}
+		out = append(out, mode, fill)
+		out = binary.LittleEndian.AppendUint16(out, uint16(ranks[c]))
+	}
+	for c, mode := range modes {
+		if mode == svdChannelRaw {
+			for i := c; i < len(data); i += 4 {
+				out = append(out, data[i])
+			}
+		}
+	}
+
+	for i := 0; i < maxRank; i++ {
+		for c, f := range factors {
+			if f == nil || ranks[c] <= i {
+				continue
+			}
+			out = binary.LittleEndian.AppendUint32(out, math.Float32bits(float32(f.s[i])))
+			out = appendSVDVector(out, f.u[i:], f.rows, f.k, quant)
+			out = appendSVDVector(out, f.v[i:], f.cols, f.k, quant)
+		}
+	}
+	return out, nil
+}
+
+// encodeSVDImage factors the selected channels of the width x height RGBA image data,
+// chooses their ranks (capped by rank) and encodes the TSVD container. Constant
+// channels are never factored; they are stored as fill bytes.
+func encodeSVDImage(data []uint8, width, height, rank int, opts svdOptions, quant uint8) ([]byte, svdRankReport, error) {
+	if err := checkSVDContainerOptions(opts); err != nil {
+		return nil, svdRankReport{}, err
+	}
+	opts = skipConstantChannels(data, opts)
+	factors := factorImageChannels(data, width, height, rank, opts.Channels, opts)
+	report := selectSVDRanks(data, width, height, factors, rank, opts, quant)
+	logSVDRanks(report)
+	statsSVD(report)
+	statsPhase(phaseFactorize)
+	container, err := encodeSVDContainer(data, width, height, factors, report.ranks, opts.Channels, quant)
+	statsPhase(phaseEncode)
+	return container, report, err
+}
+
+// checkSVDContainerOptions rejects the modes a TSVD container cannot hold: its terms
+// are whole RGBA channels, so there are no block or YCbCr containers.
+func checkSVDContainerOptions(opts svdOptions) error {
+	if opts.BlockSize > 0 || opts.ColorSpace == svdColorSpaceYCbCr {
+		return errors.New("TSVD containers hold only whole-channel RGB factors (no block or YCbCr mode)")
+	}
+	return nil
+}
+
+// svdStreamDecoder incrementally decodes a TSVD container. Write accepts the stream
+// in arbitrary chunks; every complete term is folded into a per-channel float32
+// accumulator immediately, so Render always shows the best approximation so far.
+// Full-size buffers are allocated only once the data that fills them has arrived,
+// so a header alone (which nothing but its own checks vouches for) costs nothing.
+type svdStreamDecoder struct {
+	pending []byte // Bytes received but not yet consumed
+
+	headerDone    bool
+	width, height int
+	quant         uint8
+	modes         [4]uint8
+	fill          [4]uint8
+	ranks         [4]int
+	raw           [4][]uint8 // Planes of the raw channels, once received
+	rawDone       bool       // Whether the raw planes have arrived
+
+	order   []int // Channel of each term, in stream order
+	next    int   // Index into order of the next term to decode
+	decoded [4]int
+	acc     [4][]float32 // Allocated with the first term of each channel
+	u, v    []float32    // Dequantized vectors of the term being applied
+}
+
+var errSVDContainerTruncated = errors.New("TSVD stream ended before all terms were received")
+
+// Write consumes p, decoding the header and as many complete terms as possible.
+func (d *svdStreamDecoder) Write(p []byte) error {
+	d.pending = append(d.pending, p...)
+	if !d.headerDone {
+		if len(d.pending) < svdContainerHeaderSize+4*svdChannelEntrySize {
+			return nil
+		}
+		if err := d.parseHeader(); err != nil {
+			return err
+		}
+	}
+	if !d.rawDone {
+		// The raw planes precede the terms and are taken in one piece
+		planes := 0
+		for _, mode := range d.modes {
+			if mode == svdChannelRaw {
+				planes++
+			}
+		}
+		if len(d.pending) < planes*d.width*d.height {
+			return nil
+		}
+		for c, mode := range d.modes {
+			if mode == svdChannelRaw {
+				d.raw[c] = make([]uint8, d.width*d.height)
+				d.pending = d.pending[copy(d.raw[c], d.pending):]
+			}
+		}
+		d.rawDone = true
+	}
+
+	termSize := svdTermSize(d.height, d.width, d.quant)
+	consumed := 0
+	for d.next < len(d.order) && len(d.pending)-consumed >= termSize {
+		d.applyTerm(d.order[d.next], d.pending[consumed:consumed+termSize])
+		consumed += termSize
+		d.next++
+	}
+	// Keep only the partial tail; the copy is at most one term
+	d.pending = append(d.pending[:0], d.pending[consumed:]...)
+	return nil
+}
+
+func (d *svdStreamDecoder) parseHeader() error {
+	p := d.pending
+	if string(p[:4]) != svdContainerMagic {
+		return errors.New("not a TSVD stream: bad magic")
+	}
+	if p[4] != svdContainerVersion {
+		return fmt.Errorf("unsupported TSVD version %d", p[4])
+	}
+	d.quant = p[5]
+	if d.quant != svdQuantInt8 && d.quant != svdQuantFloat16 {
+		return fmt.Errorf("unsupported TSVD quantization %d", d.quant)
+	}
+	if p[6] != 0 {
+		return fmt.Errorf("unsupported TSVD flags 0x%02x", p[6])
+	}
+	d.width = int(binary.LittleEndian.Uint32(p[8:]))
+	d.height = int(binary.LittleEndian.Uint32(p[12:]))
+	if d.width <= 0 || d.height <= 0 || d.width > maxImagePixels || d.width*d.height > maxImagePixels {
+		return fmt.Errorf("invalid TSVD dimensions %dx%d", d.width, d.height)
+	}
+
+	maxRank := 0
+	for c := 0; c < 4; c++ {
+		entry := p[svdContainerHeaderSize+c*svdChannelEntrySize:]
+		d.modes[c], d.fill[c] = entry[0], entry[1]
+		if d.modes[c] == svdChannelFactored {
+			d.ranks[c] = int(binary.LittleEndian.Uint16(entry[2:]))
+			if d.ranks[c] > min(d.width, d.height) {
+				return fmt.Errorf("invalid TSVD rank %d for channel %d", d.ranks[c], c)
+			}
+			maxRank = max(maxRank, d.ranks[c])
+		} else if d.modes[c] != svdChannelRaw && d.modes[c] != svdChannelConstant {
+			return fmt.Errorf("invalid TSVD mode %d for channel %d", d.modes[c], c)
+		}
+	}
+	for i := 0; i < maxRank; i++ {
+		for c := 0; c < 4; c++ {
+			if d.modes[c] == svdChannelFactored && d.ranks[c] > i {
+				d.order = append(d.order, c)
+			}
+		}
+	}
+
+	d.pending = d.pending[svdContainerHeaderSize+4*svdChannelEntrySize:]
+	d.headerDone = true
+	return nil
+}
+
+// applyTerm adds σ u vᵀ of one encoded term to channel c's accumulator.
+func (d *svdStreamDecoder) applyTerm(c int, p []byte) {
+	if d.u == nil {
+		d.u, d.v = make([]float32, d.height), make([]float32, d.width)
+	}
+	if d.acc[c] == nil {
+		d.acc[c] = make([]float32, d.width*d.height)
+	}
+	sigma := math.Float32frombits(binary.LittleEndian.Uint32(p))
+	uSize := svdVectorSize(d.height, d.quant)
+	decodeSVDVector(d.u, p[4:], d.quant)
+	decodeSVDVector(d.v, p[4+uSize:], d.quant)
+
+	acc := d.acc[c]
+	parallelRows(d.height, func(startY, endY int) {
+		for y := startY; y < endY; y++ {
+			su := sigma * d.u[y]
+			row := acc[y*d.width : (y+1)*d.width]
+			for x, vx := range d.v {
+				row[x] += su * vx
+			}
+		}
+	})
+	d.decoded[c]++
+}
+
+// Rank returns the rank every channel has reached, and the rank of the full stream.
+func (d *svdStreamDecoder) Rank() (decoded, total int) {
+	decoded = math.MaxInt
+	for c := 0; c < 4; c++ {
+		if d.modes[c] != svdChannelFactored {
+			continue
+		}
+		total = max(total, d.ranks[c])
+		if d.decoded[c] < d.ranks[c] {
+			decoded = min(decoded, d.decoded[c])
+		}
+	}
+	return min(decoded, total), total
+}
+
+// Done reports whether every term has been decoded.
+func (d *svdStreamDecoder) Done() bool {
+	return d.headerDone && d.rawDone && d.next == len(d.order)
+}
+
+// Close checks that the stream was complete.
+func (d *svdStreamDecoder) Close() error {
+	if !d.Done() {
+		return errSVDContainerTruncated
+	}
+	return nil
+}
+
+// Render writes the current approximation as RGBA into dst (width*height*4 bytes).
+func (d *svdStreamDecoder) Render(dst []uint8) {
+	parallelRows(d.height, func(startY, endY int) {
+		for p := startY * d.width; p < endY*d.width; p++ {
+			for c := 0; c < 4; c++ {
+				if d.acc[c] != nil {
+					dst[p*4+c] = uint8(clampFloat64(float64(d.acc[c][p])+0.5, 0, 255))
+				} else if d.modes[c] == svdChannelFactored {
+					dst[p*4+c] = 0 // No term yet: the rank-0 approximation
+				} else if d.raw[c] != nil {
+					dst[p*4+c] = d.raw[c][p]
+				} else {
+					dst[p*4+c] = d.fill[c]
+				}
+			}
+		}
+	})
+}
+
+// float32ToHalf converts f to IEEE 754 half precision, rounding to nearest even.
+func float32ToHalf(f float32) uint16 {
+	bits := math.Float32bits(f)
+	sign := uint16(bits>>16) & 0x8000
+	rawExp := int(bits>>23) & 0xff
+	mant := bits & 0x7fffff
+	exp := rawExp - 127 + 15
+
+	switch {
+	case rawExp == 0xff: // Inf or NaN
+		if mant != 0 {
+			return sign | 0x7e00
+		}
+		return sign | 0x7c00
+	case exp >= 0x1f: // Overflow
+		return sign | 0x7c00
+	case exp <= 0: // Subnormal or zero
+		if exp < -10 {
+			return sign
+		}
+		mant |= 0x800000
+		shift := uint(14 - exp)
+		half := uint16(mant >> shift)
+		rem, halfway := mant&(1<<shift-1), uint32(1)<<(shift-1)
+		if rem > halfway || (rem == halfway && half&1 == 1) {
+			half++
+		}
+		return sign | half
+	default:
+		half := sign | uint16(exp)<<10 | uint16(mant>>13)
+		rem := mant & 0x1fff
+		if rem > 0x1000 || (rem == 0x1000 && half&1 == 1) {
+			half++ // A carry into the exponent is the correct rounding
+		}
+		return half
+	}
+}
+
+// halfToFloat32 converts an IEEE 754 half precision value to float32.
+func halfToFloat32(h uint16) float32 {
+	sign := uint32(h&0x8000) << 16
+	exp := uint32(h>>10) & 0x1f
+	mant := uint32(h & 0x3ff)
+	switch exp {
+	case 0:
+		v := float32(mant) / (1 << 24) // Subnormal (or zero): mant * 2^-24
+		if sign != 0 {
+			v = -v
+		}
+		return v
+	case 0x1f:
+		return math.Float32frombits(sign | 0x7f800000 | mant<<13)
+	default:
+		return math.Float32frombits(sign | (exp+112)<<23 | mant<<13)
+	}
+}
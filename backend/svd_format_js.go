@@ -0,0 +1,197 @@
+//go:build js && wasm
+// +build js,wasm
+
+package main
+
+import (
+	"fmt"
+	"syscall/js"
+	"time"
+)
+
+// JavaScript bindings for the TSVD container (see svd_format.go).
+
+// sharedContainerBuffer holds the last encoded container; sharedDecodeBuffer the
+// latest decoder rendering. Both follow the shared buffer rules of shared_buffer.go.
+const (
+	sharedContainerBuffer = "container"
+	sharedDecodeBuffer    = "decode"
+)
+
+// Active streaming decoders by caller-chosen stream id
+var svdDecoders = map[int]*svdStreamDecoder{}
+
+// parseSVDQuantization reads options.quantization ("int8" by default or "float16").
+func parseSVDQuantization(optsJS js.Value) (uint8, string) {
+	if optsJS.IsUndefined() || optsJS.IsNull() || optsJS.Type() != js.TypeObject {
+		return svdQuantInt8, ""
+	}
+	quantVal := optsJS.Get("quantization")
+	if quantVal.IsUndefined() {
+		return svdQuantInt8, ""
+	}
+	if quantVal.Type() != js.TypeString {
+		return 0, "Invalid options.quantization: expected a string"
+	}
+	quant, ok := svdQuantizationNames[quantVal.String()]
+	if !ok {
+		return 0, "Invalid options.quantization: expected 'int8' or 'float16'"
+	}
+	return quant, ""
+}
+
+// parseEncodeArgs validates (rank, options?) starting at args[i] for fn.
+func parseEncodeArgs(fn string, args []js.Value, i int) (int, svdOptions, uint8, interface{}) {
+	if len(args) <= i || args[i].Type() != js.TypeNumber || args[i].Int() <= 0 {
+		return 0, svdOptions{}, 0, createError(fmt.Sprintf("Invalid rank argument for %s: expected a positive number", fn))
+	}
+	rank := args[i].Int()
+	opts := defaultSVDOptions()
+	quant := uint8(svdQuantInt8)
+	if len(args) > i+1 {
+		var errMsg string
+		if opts, errMsg = parseSVDOptions(args[i+1]); errMsg != "" {
+			return 0, opts, 0, createError(errMsg)
+		}
+		if quant, errMsg = parseSVDQuantization(args[i+1]); errMsg != "" {
+			return 0, opts, 0, createError(errMsg)
+		}
+	}
+	if err := checkSVDContainerOptions(opts); err != nil {
+		return 0, opts, 0, createError(fmt.Sprintf("Invalid options for %s: %v", fn, err))
+	}
+	return rank, opts, quant, nil
+}
+
+// encodeSVDWrapper expects imageData { width, height, data }, rank and the compressSVD
+// options plus quantization: "int8" | "float16". It returns the TSVD container as a Uint8Array.
+func encodeSVDWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("encodeSVD")
+	defer endStats()
+	if len(args) < 2 {
+		return createError("Invalid number of arguments for encodeSVD: expected (imageData, rank, options?)")
+	}
+	dataJS, width, height, errObj := readImageDataArg("encodeSVD", args[0])
+	if errObj != nil {
+		return errObj
+	}
+	rank, opts, quant, errObj := parseEncodeArgs("encodeSVD", args, 1)
+	if errObj != nil {
+		return errObj
+	}
+	data := make([]uint8, dataJS.Length())
+	js.CopyBytesToGo(data, dataJS)
+	statsBytes(len(data), 0)
+	statsPhase(phaseCopyIn)
+	container, _, err := encodeSVDImage(data, width, height, rank, opts, quant)
+	if err != nil {
+		return createError(fmt.Sprintf("encodeSVD failed: %v", err))
+	}
+
+	result := js.Global().Get("Uint8Array").New(len(container))
+	js.CopyBytesToJS(result, container)
+	statsBytes(0, len(container))
+	statsPhase(phaseCopyOut)
+	logf("encodeSVDWrapper: %d bytes (%.1f%% of RGBA) in %v\n", len(container), 100*float64(len(container))/float64(len(data)), time.Since(startTime))
+	return result
+}
+
+// encodeSVDSharedWrapper expects (width, height, rank, options?) and encodes the shared
+// source buffer, reusing cached factors. It returns the container's { ptr, length }.
+func encodeSVDSharedWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("encodeSVDShared")
+	defer endStats()
+	src, _, width, height, errObj := sharedImageBuffers("encodeSVDShared", args)
+	if errObj != nil {
+		return errObj
+	}
+	rank, opts, quant, errObj := parseEncodeArgs("encodeSVDShared", args, 2)
+	if errObj != nil {
+		return errObj
+	}
+	rank = min(rank, min(width, height))
+	opts = skipConstantChannels(src, opts) // Stored exactly as fill bytes
+
+	ensureSVDFactors(src, width, height, rank, opts)
+	factors := cachedSVDFactors(opts)
+	report := selectSVDRanks(src, width, height, factors, rank, opts, quant)
+	logSVDRanks(report)
+	statsSVD(report)
+	statsPhase(phaseFactorize)
+	container, err := encodeSVDContainer(src, width, height, factors, report.ranks, opts.Channels, quant)
+	if err != nil {
+		return createError(fmt.Sprintf("encodeSVDShared failed: %v", err))
+	}
+	dst := ensureSharedBuffer(sharedContainerBuffer, len(container))
+	copy(dst, container)
+	statsPhase(phaseEncode)
+
+	logf("encodeSVDSharedWrapper: %d bytes (%.1f%% of RGBA) in %v\n", len(container), 100*float64(len(container))/float64(len(src)), time.Since(startTime))
+	return sharedBufferInfo(dst)
+}
+
+// svdDecoderPushWrapper expects (streamId, chunk: Uint8Array, final?: boolean). It feeds
+// the chunk to the stream's decoder (created on first use) and renders the current
+// approximation. It returns { ptr, length, width, height, rank, totalRank, done };
+// length is 0 until the header has arrived. A final push closes the stream.
+func svdDecoderPushWrapper(this js.Value, args []js.Value) interface{} {
+	if len(args) < 2 || args[0].Type() != js.TypeNumber || args[1].Type() != js.TypeObject {
+		return createError("Invalid arguments for svdDecoderPush: expected (streamId: number, chunk: Uint8Array, final?: boolean)")
+	}
+	beginStats("svdDecoderPush")
+	defer endStats()
+	// Decoder accumulators persist across pushes, so a push must never stop halfway
+	poll := cancelPoll
+	setCancelPoll(nil)
+	defer setCancelPoll(poll)
+	id := args[0].Int()
+	final := len(args) > 2 && args[2].Truthy()
+	d := svdDecoders[id]
+	if d == nil {
+		d = &svdStreamDecoder{}
+		svdDecoders[id] = d
+	}
+
+	chunk := make([]uint8, args[1].Length())
+	js.CopyBytesToGo(chunk, args[1])
+	statsBytes(len(chunk), 0)
+	statsPhase(phaseCopyIn)
+	err := d.Write(chunk)
+	statsPhase(phaseDecode)
+	if err == nil && final {
+		err = d.Close()
+	}
+	if err != nil || final {
+		delete(svdDecoders, id)
+	}
+	if err != nil {
+		return createError(fmt.Sprintf("svdDecoderPush failed: %v", err))
+	}
+
+	var info js.Value
+	if d.headerDone {
+		dst := ensureSharedBuffer(sharedDecodeBuffer, d.width*d.height*4)
+		d.Render(dst)
+		statsPhase(phaseRender)
+		info = sharedBufferInfo(dst)
+	} else {
+		info = sharedBufferInfo(nil)
+	}
+	decoded, total := d.Rank()
+	info.Set("width", d.width)
+	info.Set("height", d.height)
+	info.Set("rank", decoded)
+	info.Set("totalRank", total)
+	info.Set("done", d.Done())
+	return info
+}
+
+// svdDecoderCloseWrapper expects a streamId and discards that decoder.
+func svdDecoderCloseWrapper(this js.Value, args []js.Value) interface{} {
+	if len(args) > 0 && args[0].Type() == js.TypeNumber {
+		delete(svdDecoders, args[0].Int())
+	}
+	return nil
+}
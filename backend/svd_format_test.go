@@ -0,0 +1,201 @@
+package main
+
+import (
+	"encoding/binary"
+	"runtime"
+	"testing"
+)
+
+// rankOneImage returns a width x height RGBA image whose colour channels are exact
+// rank-1 outer products, with the given alpha function.
+func rankOneImage(width, height int, alpha func(x, y int) uint8) []uint8 {
+	data := make([]uint8, width*height*4)
+	for y := 0; y < height; y++ {
+		for x := 0; x < width; x++ {
+			i := (y*width + x) * 4
+			data[i] = uint8(255 * (x + 1) * (y + 1) / (width * height))
+			data[i+1] = uint8(200 * (width - x) / width)
+			data[i+2] = uint8(100 + 100*(y+1)/height)
+			data[i+3] = alpha(x, y)
+		}
+	}
+	return data
+}
+
+// decodeSVDContainer streams container into a decoder in chunks of chunk bytes and
+// returns the rendered RGBA image.
+func decodeSVDContainer(t *testing.T, container []byte, chunk int) ([]uint8, *svdStreamDecoder) {
+	t.Helper()
+	d := &svdStreamDecoder{}
+	for len(container) > 0 {
+		n := min(chunk, len(container))
+		if err := d.Write(container[:n]); err != nil {
+			t.Fatalf("Write: %v", err)
+		}
+		container = container[n:]
+	}
+	if err := d.Close(); err != nil {
+		t.Fatalf("Close: %v", err)
+	}
+	dst := make([]uint8, d.width*d.height*4)
+	d.Render(dst)
+	return dst, d
+}
+
+// checkChannels compares channel c of got and want, exactly when tolerance is 0.
+func checkChannels(t *testing.T, got, want []uint8, c, tolerance int) {
+	t.Helper()
+	for i := c; i < len(want); i += 4 {
+		if diff := int(got[i]) - int(want[i]); diff > tolerance || diff < -tolerance {
+			t.Fatalf("channel %d, pixel %d: got %d, want %d (tolerance %d)", c, i/4, got[i], want[i], tolerance)
+		}
+	}
+}
+
+func TestSVDContainerConstantChannel(t *testing.T) {
+	const width, height = 24, 16
+	data := rankOneImage(width, height, func(x, y int) uint8 { return 255 })
+	container, report, err := encodeSVDImage(data, width, height, 1, defaultSVDOptions(), svdQuantInt8)
+	if err != nil {
+		t.Fatalf("encodeSVDImage: %v", err)
+	}
+	if report.ranks[3] != 0 {
+		t.Errorf("constant alpha got rank %d, want 0", report.ranks[3])
+	}
+	if len(container) != report.bytes {
+		t.Errorf("container is %d bytes, report says %d", len(container), report.bytes)
+	}
+
+	got, d := decodeSVDContainer(t, container, len(container))
+	if d.modes[3] != svdChannelConstant {
+		t.Errorf("alpha stored in mode %d, want constant", d.modes[3])
+	}
+	checkChannels(t, got, data, 3, 0)
+	for c := 0; c < 3; c++ {
+		checkChannels(t, got, data, c, 3)
+	}
+}
+
+func TestSVDContainerDeselectedChannel(t *testing.T) {
+	const width, height = 24, 16
+	// Transparent edges: alpha varies, so it is neither constant nor factored
+	data := rankOneImage(width, height, func(x, y int) uint8 {
+		if x < 4 || y < 4 {
+			return 0
+		}
+		return uint8(128 + x)
+	})
+	opts := defaultSVDOptions()
+	opts.Channels = [4]bool{true, true, true, false}
+	container, report, err := encodeSVDImage(data, width, height, 1, opts, svdQuantFloat16)
+	if err != nil {
+		t.Fatalf("encodeSVDImage: %v", err)
+	}
+	if len(container) != report.bytes {
+		t.Errorf("container is %d bytes, report says %d", len(container), report.bytes)
+	}
+
+	// Small chunks split the raw plane and the terms across writes
+	got, d := decodeSVDContainer(t, container, 7)
+	if d.modes[3] != svdChannelRaw {
+		t.Errorf("alpha stored in mode %d, want raw", d.modes[3])
+	}
+	checkChannels(t, got, data, 3, 0)
+	for c := 0; c < 3; c++ {
+		checkChannels(t, got, data, c, 3)
+	}
+}
+
+func TestSVDContainerPrefix(t *testing.T) {
+	const width, height = 16, 16
+	data := rankOneImage(width, height, func(x, y int) uint8 { return uint8(x * y) })
+	container, _, err := encodeSVDImage(data, width, height, 4, defaultSVDOptions(), svdQuantInt8)
+	if err != nil {
+		t.Fatalf("encodeSVDImage: %v", err)
+	}
+	d := &svdStreamDecoder{}
+	if err := d.Write(container[:len(container)-1]); err != nil {
+		t.Fatalf("Write: %v", err)
+	}
+	if d.Done() {
+		t.Error("decoder done before the last byte")
+	}
+	if err := d.Close(); err != errSVDContainerTruncated {
+		t.Errorf("Close of a truncated stream: got %v, want %v", err, errSVDContainerTruncated)
+	}
+}
+
+func TestSVDContainerRejectsUnsupportedModes(t *testing.T) {
+	const width, height = 16, 16
+	data := rankOneImage(width, height, func(x, y int) uint8 { return 255 })
+	ycbcr := defaultSVDOptions()
+	ycbcr.ColorSpace = svdColorSpaceYCbCr
+	block := defaultSVDOptions()
+	block.BlockSize = 8
+	for name, opts := range map[string]svdOptions{"ycbcr": ycbcr, "block": block} {
+		if _, _, err := encodeSVDImage(data, width, height, 4, opts, svdQuantInt8); err == nil {
+			t.Errorf("%s: encodeSVDImage succeeded, want an error", name)
+		}
+	}
+}
+
+func TestSVDContainerFactorizationFailure(t *testing.T) {
+	const width, height = 16, 16
+	data := rankOneImage(width, height, func(x, y int) uint8 { return 255 })
+	// Red is selected and not constant, but has no factors
+	if _, err := encodeSVDContainer(data, width, height, [4]*svdFactors{}, [4]int{4}, [4]bool{true}, svdQuantInt8); err == nil {
+		t.Error("encodeSVDContainer succeeded without factors for a selected channel")
+	}
+}
+
+// svdHeader returns the header and channel table of a small container with its
+// dimensions replaced by width x height.
+func svdHeader(t *testing.T, width, height int) []byte {
+	t.Helper()
+	data := rankOneImage(16, 16, func(x, y int) uint8 { return uint8(x * y) })
+	opts := defaultSVDOptions()
+	opts.Channels = [4]bool{true, true, true, false}
+	container, _, err := encodeSVDImage(data, 16, 16, 4, opts, svdQuantInt8)
+	if err != nil {
+		t.Fatalf("encodeSVDImage: %v", err)
+	}
+	header := append([]byte(nil), container[:svdContainerHeaderSize+4*svdChannelEntrySize]...)
+	binary.LittleEndian.PutUint32(header[8:], uint32(width))
+	binary.LittleEndian.PutUint32(header[12:], uint32(height))
+	return header
+}
+
+func TestSVDContainerRejectsHugeHeader(t *testing.T) {
+	for _, size := range [][2]int{{maxImagePixels/1000 + 1, 1000}, {1 << 31, 1}, {1 << 20, 1 << 20}} {
+		d := &svdStreamDecoder{}
+		if err := d.Write(svdHeader(t, size[0], size[1])); err == nil {
+			t.Errorf("%dx%d: header accepted, want an error", size[0], size[1])
+		}
+	}
+}
+
+func TestSVDContainerHeaderAllocatesNothing(t *testing.T) {
+	// A valid header for a 6000x6000 image: full-size buffers would be 144 MB per channel
+	header := svdHeader(t, 6000, 6000)
+	d := &svdStreamDecoder{}
+	var before, after runtime.MemStats
+	runtime.ReadMemStats(&before)
+	if err := d.Write(header); err != nil {
+		t.Fatalf("Write: %v", err)
+	}
+	runtime.ReadMemStats(&after)
+	if d.modes[3] != svdChannelRaw {
+		t.Fatalf("alpha stored in mode %d, want raw", d.modes[3])
+	}
+	for c := 0; c < 4; c++ {
+		if d.acc[c] != nil || d.raw[c] != nil {
+			t.Errorf("channel %d has a buffer before any of its data arrived", c)
+		}
+	}
+	if n := after.TotalAlloc - before.TotalAlloc; n > 1<<20 {
+		t.Errorf("header allocated %d bytes", n)
+	}
+	if err := d.Close(); err != errSVDContainerTruncated {
+		t.Errorf("Close of a header-only stream: got %v, want %v", err, errSVDContainerTruncated)
+	}
+}
@@ -0,0 +1,183 @@
+package main
+
+import (
+	"math"
+)
+
+// Rank selection for whole-channel SVD compression.
+//
+// With options.target set, compressSVD and encodeSVD choose the rank of every channel
+// from its singular values; rank then only caps the choice. Truncating a channel A to
+// k terms leaves a squared error equal to the energy of the dropped terms,
+// ‖A − A_k‖²_F = ‖A‖²_F − Σ_{i<k} σ_i², so each target is met from the spectrum alone,
+// without trial reconstructions:
+//   - energy: the smallest k retaining the given fraction of ‖A‖²_F
+//   - psnr:   the smallest k keeping the channel's PSNR (dB) at or above the target
+//   - bytes:  the terms with the largest σ² across all channels that fit the TSVD
+//     container in the budget. Every term of an image costs the same, so this
+//     minimizes the total squared error for that size.
+//
+// ‖A‖²_F is summed from the pixels, so the energy beyond the factored triplets is
+// counted even when only the leading ones were computed (randomized method, cache).
+// The PSNR is that of the unrounded reconstruction; rounding to bytes only matters
+// above about 60 dB. Every factored channel keeps at least one term, so a byte budget
+// below one term per channel cannot be met; neither can an energy or PSNR target that
+// rank caps. The report then has met = false, and bytes holds the actual size.
+//
+// The energy is uncentered: ‖A‖²_F includes the channel's mean (DC), which the first
+// term nearly captures on its own. A photo often keeps 90% or more of its energy at
+// rank 1, so energy targets must be close to 1 (0.999 and above) to preserve detail.
+
+// Targets selectable from JavaScript via options.target.
+const (
+	svdTargetEnergy = "energy" // targetValue: fraction of ‖A‖²_F to retain, in (0, 1]
+	svdTargetPSNR   = "psnr"   // targetValue: minimum PSNR per channel in dB
+	svdTargetBytes  = "bytes"  // targetValue: TSVD container size budget in bytes
+)
+
+// svdRankReport describes the ranks of one whole-channel compression. Fixed-rank calls
+// report too, so the energy curve can guide the choice of a target.
+type svdRankReport struct {
+	target      string // "" when rank was used directly
+	targetValue float64
+	ranks       [4]int       // Terms kept per channel; 0 for channels copied unchanged
+	energy      [4][]float64 // Retained fraction of ‖A‖²_F after each factored term; nil for copied channels
+	psnr        float64      // Estimated PSNR of the compressed channels; +Inf when they are exact
+	bytes       int          // Size of a TSVD container holding these ranks
+	termBytes   int          // Size of one term in that container
+	ratio       float64      // Raw RGBA size over bytes
+	met         bool         // Whether the ranks reach the target; true without one
+}
+
+// channelSquares returns ‖A‖²_F of channel c of the RGBA image data.
+func channelSquares(data []uint8, c int) float64 {
+	var sum uint64
+	for i := c; i < len(data); i += 4 {
+		v := uint64(data[i])
+		sum += v * v
+	}
+	return float64(sum)
+}
+
+// rankForTail returns the smallest k in [1, maxRank] whose dropped energy
+// total − Σ_{i<k} s_i² is at most tail.
+func rankForTail(s []float64, total, tail float64, maxRank int) int {
+	kept := 0.0
+	for k := 0; k < maxRank; k++ {
+		if k > 0 && total-kept <= tail {
+			return k
+		}
+		kept += s[k] * s[k]
+	}
+	return maxRank
+}
+
+// selectSVDRanks chooses the rank of every channel with non-nil factors of the
+// width x height image data, capped by rank, as opts.Target asks (rank itself without
+// a target), and describes the result. Container sizes are those of quant.
+func selectSVDRanks(data []uint8, width, height int, factors [4]*svdFactors, rank int, opts svdOptions, quant uint8) svdRankReport {
+	report := svdRankReport{target: opts.Target, targetValue: opts.TargetValue, met: true}
+	modes := svdChannelModes(data, factors)
+	n := float64(width * height)
+	var totals [4]float64
+	var caps [4]int
+	for c, f := range factors {
+		if f != nil {
+			totals[c] = channelSquares(data, c)
+			caps[c] = max(1, min(rank, f.k))
+		}
+	}
+
+	switch opts.Target {
+	case svdTargetEnergy, svdTargetPSNR:
+		for c, f := range factors {
+			if f == nil {
+				continue
+			}
+			tail := (1 - opts.TargetValue) * totals[c]
+			if opts.Target == svdTargetPSNR {
+				tail = n * 255 * 255 / math.Pow(10, opts.TargetValue/10)
+			}
+			report.ranks[c] = rankForTail(f.s, totals[c], tail, caps[c])
+			kept := 0.0
+			for _, s := range f.s[:report.ranks[c]] {
+				kept += s * s
+			}
+			if totals[c]-kept > tail {
+				report.met = false // rank capped the channel short of the target
+			}
+		}
+	case svdTargetBytes:
+		// One term per channel, then the largest remaining σ² while the budget allows
+		terms := (int(opts.TargetValue) - svdContainerSize(width, height, modes, [4]int{}, quant)) / svdTermSize(height, width, quant)
+		for c, f := range factors {
+			if f != nil {
+				report.ranks[c] = 1
+				terms--
+			}
+		}
+		for ; terms > 0; terms-- {
+			best := -1
+			for c, f := range factors {
+				if f != nil && report.ranks[c] < caps[c] && (best < 0 || f.s[report.ranks[c]] > factors[best].s[report.ranks[best]]) {
+					best = c
+				}
+			}
+			if best < 0 {
+				break
+			}
+			report.ranks[best]++
+		}
+	default:
+		report.ranks = caps
+	}
+
+	// Energy curves and the error the chosen ranks leave
+	dropped, count := 0.0, 0
+	for c, f := range factors {
+		if f == nil {
+			continue
+		}
+		curve := make([]float64, f.k)
+		kept := 0.0
+		for i, s := range f.s {
+			kept += s * s
+			if totals[c] > 0 {
+				curve[i] = math.Min(kept/totals[c], 1)
+			} else {
+				curve[i] = 1
+			}
+		}
+		report.energy[c] = curve
+		keptAtRank := 0.0
+		for _, s := range f.s[:report.ranks[c]] {
+			keptAtRank += s * s
+		}
+		dropped += max(totals[c]-keptAtRank, 0)
+		count++
+	}
+	report.psnr = math.Inf(1)
+	if count > 0 && dropped > 0 {
+		report.psnr = 10 * math.Log10(255*255*n*float64(count)/dropped)
+	}
+	report.bytes = svdContainerSize(width, height, modes, report.ranks, quant)
+	report.termBytes = svdTermSize(height, width, quant)
+	report.ratio = float64(len(data)) / float64(report.bytes)
+	if opts.Target == svdTargetBytes && float64(report.bytes) > opts.TargetValue {
+		report.met = false
+	}
+	return report
+}
+
+// logSVDRanks prints the outcome of selectSVDRanks.
+func logSVDRanks(r svdRankReport) {
+	if r.target != "" {
+		logf("SVD ranks for target %s %g: ", r.target, r.targetValue)
+	} else {
+		logf("SVD ranks: ")
+	}
+	logf("%v, estimated PSNR %.2f dB, %d bytes (%.1fx)\n", r.ranks, r.psnr, r.bytes, r.ratio)
+	if !r.met {
+		logf("SVD target %s %g not reached: %d bytes, %.2f dB at these ranks\n", r.target, r.targetValue, r.bytes, r.psnr)
+	}
+}
@@ -0,0 +1,49 @@
+package main
+
+import (
+	"testing"
+)
+
+func TestSVDRanksByteTarget(t *testing.T) {
+	const width, height = 24, 16
+	data := rankOneImage(width, height, func(x, y int) uint8 { return uint8(x * y) })
+	factors := factorImageChannels(data, width, height, 8, [4]bool{true, true, true, true}, defaultSVDOptions())
+	termBytes := svdTermSize(height, width, svdQuantInt8)
+	header := svdContainerHeaderSize + 4*svdChannelEntrySize
+
+	opts := defaultSVDOptions()
+	opts.Target = svdTargetBytes
+	opts.TargetValue = float64(header + 6*termBytes)
+	report := selectSVDRanks(data, width, height, factors, 8, opts, svdQuantInt8)
+	if !report.met || report.bytes > int(opts.TargetValue) {
+		t.Errorf("budget of 6 terms: met %v, %d bytes for a %g byte target", report.met, report.bytes, opts.TargetValue)
+	}
+
+	// Below one term per channel the budget cannot be honoured, and the report says so
+	opts.TargetValue = float64(header + 2*termBytes)
+	report = selectSVDRanks(data, width, height, factors, 8, opts, svdQuantInt8)
+	if report.met {
+		t.Errorf("budget of 2 terms for 4 channels reported as met (%d bytes)", report.bytes)
+	}
+	if report.bytes != header+4*termBytes {
+		t.Errorf("got %d bytes, want one term per channel (%d)", report.bytes, header+4*termBytes)
+	}
+}
+
+func TestSVDRanksEnergyTargetCapped(t *testing.T) {
+	const width, height = 16, 16
+	data := make([]uint8, width*height*4)
+	for i := range data {
+		data[i] = uint8(i * 7919 % 251) // Far from low rank
+	}
+	factors := factorImageChannels(data, width, height, 16, [4]bool{true, true, true, true}, defaultSVDOptions())
+	opts := defaultSVDOptions()
+	opts.Target = svdTargetEnergy
+	opts.TargetValue = 0.9999
+	if report := selectSVDRanks(data, width, height, factors, 2, opts, svdQuantInt8); report.met {
+		t.Errorf("rank cap 2 reported as meeting %g energy (ranks %v)", opts.TargetValue, report.ranks)
+	}
+	if report := selectSVDRanks(data, width, height, factors, 16, opts, svdQuantInt8); !report.met {
+		t.Errorf("full rank reported as missing %g energy (ranks %v)", opts.TargetValue, report.ranks)
+	}
+}
@@ -0,0 +1,47 @@
+package main
+
+// Factor textures for reconstruction on the GPU.
+//
+// Instead of a rank-r RGBA frame (h·w·4 bytes), the frontend can fetch the truncated
+// factors of the current source and evaluate U_r Σ_r V_rᵀ per pixel in a fragment
+// shader (see frontend/src/lib/gpuSVD.ts); a rank change is then only a uniform change.
+// The factors of all four channels are interleaved into two RGBA float32 textures,
+// one channel per texel component, so one texture fetch serves every channel:
+//   - US: terms texels wide and height rows tall; texel (i, y) holds σ_i u_i[y]
+//   - V:  terms texels wide and width rows tall; texel (i, x) holds v_i[x]
+//
+// US precedes V in one buffer of (width+height)·terms·4 float32s, i.e. (h+w)·k floats
+// per channel. Terms a channel does not have (nil factors, k below terms) are zero.
+
+// svdTexelCount returns the number of float32s in the factor textures of a width x
+// height image with terms terms.
+func svdTexelCount(width, height, terms int) int {
+	return (width + height) * terms * 4
+}
+
+// packSVDTextures writes the leading terms triplets of factors into dst, laid out as
+// described above. dst must hold svdTexelCount(width, height, terms) values.
+func packSVDTextures(dst []float32, factors [4]*svdFactors, width, height, terms int) {
+	clear(dst)
+	us, v := dst[:height*terms*4], dst[height*terms*4:]
+	for c, f := range factors {
+		if f == nil {
+			continue
+		}
+		k := min(terms, f.k)
+		for y := 0; y < height; y++ {
+			urow := f.u[y*f.k : y*f.k+k]
+			texels := us[y*terms*4:]
+			for i, u := range urow {
+				texels[i*4+c] = float32(u * f.s[i])
+			}
+		}
+		for x := 0; x < width; x++ {
+			vrow := f.v[x*f.k : x*f.k+k]
+			texels := v[x*terms*4:]
+			for i, vi := range vrow {
+				texels[i*4+c] = float32(vi)
+			}
+		}
+	}
+}
@@ -0,0 +1,67 @@
+//go:build js && wasm
+// +build js,wasm
+
+package main
+
+import (
+	"fmt"
+	"syscall/js"
+	"time"
+	"unsafe"
+)
+
+// JavaScript binding for the factor textures (see svd_textures.go).
+
+// sharedFactorBuffer holds the last packed factor textures, following the shared
+// buffer rules of shared_buffer.go. Go aligns the allocation, so JS can view it as a
+// Float32Array at ptr.
+const sharedFactorBuffer = "factors"
+
+// svdFactorsSharedWrapper expects the arguments of compressSVDShared and packs the
+// factors of the shared source buffer into the factor buffer, terms = min(rank,
+// width, height) per channel. Factors come from (and fill) the SVD cache. rank caps the
+// ranks chosen with options.target as in compressSVDShared; channels that are
+// unselected or constant get no factors and rank 0, and are taken from the source.
+// It returns { ptr, length, terms, ranks } or an error object; length is in bytes.
+func svdFactorsSharedWrapper(this js.Value, args []js.Value) interface{} {
+	startTime := time.Now()
+	beginStats("svdFactorsShared")
+	defer endStats()
+	src, _, width, height, errObj := sharedImageBuffers("svdFactorsShared", args)
+	if errObj != nil {
+		return errObj
+	}
+	rank, opts, errObj := sharedSVDArgs("svdFactorsShared", args)
+	if errObj != nil {
+		return errObj
+	}
+	if opts.BlockSize > 0 || opts.ColorSpace == svdColorSpaceYCbCr {
+		return createError("svdFactorsShared: block and YCbCr modes have no whole-channel factors")
+	}
+	terms := min(rank, min(width, height))
+	if terms <= 0 {
+		return createError(fmt.Sprintf("Invalid rank for svdFactorsShared: %d", rank))
+	}
+	opts = skipConstantChannels(src, opts)
+
+	ensureSVDFactors(src, width, height, terms, opts)
+	factors := cachedSVDFactors(opts)
+	report := selectSVDRanks(src, width, height, factors, terms, opts, svdQuantInt8)
+	logSVDRanks(report)
+	statsSVD(report)
+	statsPhase(phaseFactorize)
+
+	dst := ensureSharedBuffer(sharedFactorBuffer, svdTexelCount(width, height, terms)*4)
+	packSVDTextures(unsafe.Slice((*float32)(unsafe.Pointer(&dst[0])), len(dst)/4), factors, width, height, terms)
+	statsPhase(phaseEncode)
+
+	info := sharedBufferInfo(dst)
+	info.Set("terms", terms)
+	ranks := js.Global().Get("Array").New(len(report.ranks))
+	for c, r := range report.ranks {
+		ranks.SetIndex(c, r)
+	}
+	info.Set("ranks", ranks)
+	logf("svdFactorsSharedWrapper: %d terms, %d bytes in %v\n", terms, len(dst), time.Since(startTime))
+	return info
+}
@@ -0,0 +1,36 @@
+package main
+
+// maxImagePixels is the largest image (width x height) the engine accepts from
+// untrusted input: the serve command's -max-pixels default and the bound on the
+// dimensions in a TSVD header.
+const maxImagePixels = 40_000_000
+
+// Helper function to clamp integer values to a specified range [minVal, maxVal].
+func clamp(value, minVal, maxVal int) int {
+	if value < minVal {
+		return minVal
+	}
+	if value > maxVal {
+		return maxVal
+	}
+	return value
+}
+
+// Helper function to clamp float64 values to a specified range [minVal, maxVal].
+func clampFloat64(v, minVal, maxVal float64) float64 {
+	if v < minVal {
+		return minVal
+	}
+	if v > maxVal {
+		return maxVal
+	}
+	return v
+}
+
+// Helper function to find the minimum of two integers.
+func min(a, b int) int {
+	if a < b {
+		return a
+	}
+	return b
+}
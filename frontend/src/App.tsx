@@ -1,6 +1,7 @@
-import React, { useState, useEffect, useRef } from 'react'; // Removed ScriptHTMLAttributes, not needed
-import { mat4, glMatrix } from 'gl-matrix';
-import WebGLCanvas, { WebGLCanvasRef } from './components/WebGLCanvas';
+import React, { useState, useEffect, useMemo, useRef } from 'react'; // Removed ScriptHTMLAttributes, not needed
+import { mat4 } from 'gl-matrix';
+import WebGLCanvas, { CanvasImage, WebGLCanvasRef } from './components/WebGLCanvas';
+import EngineStatsPanel from './components/EngineStatsPanel';
 import { Button } from "./components/ui/button";
 import { Slider } from "./components/ui/slider";
 import { Label } from "./components/ui/label";
@@ -8,18 +9,70 @@ import { Switch } from "./components/ui/switch";
 import { Card, CardContent, CardHeader, CardTitle } from "./components/ui/card";
 import { Tabs, TabsContent, TabsList, TabsTrigger } from "./components/ui/tabs";
 import { Github } from 'lucide-react'; // Import Github icon
-
-// Declare Go types on window for TypeScript
-declare global {
-  interface Window {
-    Go: any;
-    applyFilter?: (imageData: { width: number; height: number; data: Uint8ClampedArray }, filterType: string) => Promise<Uint8ClampedArray | { error: string }>; // More specific type
-    compressSVD?: (imageData: { width: number; height: number; data: Uint8ClampedArray }, rank: number) => Promise<Uint8ClampedArray | { error: string }>; // More specific type
+import { BUILTIN_FILTER_KERNELS, KernelSpec, makeGaussianKernel, parseKernelText } from './lib/kernels';
+import { EngineOp, EngineStats, PipelineStage, PointOpType, SVDOptions, SVDQuantization, SVDTarget } from './lib/engineProtocol';
+import { EngineImage, EnginePartial, isAbortError, WasmWorkerPool } from './lib/wasmWorkerPool';
+import { runTiled } from './lib/tileScheduler';
+import { buildPyramid, levelForDisplay } from './lib/imagePyramid';
+import { proxyOp, proxySVD } from './lib/proxyOps';
+import { DecodedFrame, decodeSVDStream, downloadTSVD, isTSVDFile } from './lib/svdContainer';
+import { bitmapPixels, decodeImageFile, IMAGE_FORMAT_EXTENSIONS, ImageFormat } from './lib/imageCodec';
+import { downloadURL, exportImageURL } from './lib/imageExport';
+import { downloadBatch, runBatch } from './lib/batchProcessor';
+import { TransformController, TransformSnapshot } from './lib/transformController';
+
+const SVD_BLOCK_SIZE = 64; // Block edge for block-wise SVD; small enough to stay in cache
+const SVD_PREVIEW_RANKS = [5, 10, 25]; // Intermediate ranks shown while a full SVD computes
+const SVD_PROGRESSIVE_MIN_PIXELS = 512 * 512; // Smaller images finish before a preview would help
+const GPU_SVD_TERMS = 100; // Terms fetched for GPU SVD, so every slider rank is a uniform change
+const EXPORT_QUALITY = 0.92; // WebP and JPEG quality of Download Image
+const DISPLAY_LANE = 'display'; // Pool lane of every request whose result replaces the canvas texture
+
+// Preview ranks for a progressive SVD of image at rank, or undefined when not worth it
+const svdPreviewRanks = (rank: number, image: { width: number; height: number }) => {
+  if (image.width * image.height < SVD_PROGRESSIVE_MIN_PIXELS) {
+    return undefined;
   }
-}
+  const ranks = SVD_PREVIEW_RANKS.filter(r => r < rank);
+  return ranks.length > 0 ? ranks : undefined;
+};
+
+// Label of an SVD rank target
+const formatSVDTarget = (target: SVDTarget, value: number) => target === 'energy'
+  ? `${(value * 100).toFixed(2)}% energy`
+  : target === 'psnr' ? `${value.toFixed(1)} dB PSNR` : `${Math.round(value / 1024)} KB`;
+
+// op as applied to one file of a batch: SVD ranks are clamped to that image and
+// progressive previews are dropped
+const batchOp = (op: EngineOp, image: { width: number; height: number }): EngineOp => op.op === 'compressSVD'
+  ? { ...op, rank: Math.max(1, Math.min(op.rank, image.width, image.height)), previewRanks: undefined }
+  : op;
+
+// Helper function to display a matrix with modern styling. Memoized at module scope:
+// the matrices are throttled snapshots, so slider ticks in between skip these cells.
+const MatrixDisplay = React.memo(({ matrix }: { matrix: mat4 }) => {
+  const formatNumber = (n: number) => n.toFixed(3);
+  // Flatten the matrix in column-major order as it's stored, then map to grid cells
+  const cells = [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15].map(index => (
+    <div key={index} className="p-1 text-center border border-border/50 rounded-sm bg-muted/50 text-xs font-mono ">
+      {formatNumber(matrix[index])}
+    </div>
+  ));
+
+  return (
+    <div className="grid grid-cols-4 gap-1 p-1 bg-muted/20 rounded">
+      {/* Render cells row by row for visual layout */}
+      {cells[0]} {cells[4]} {cells[8]} {cells[12]} {/* Row 1 */}
+      {cells[1]} {cells[5]} {cells[9]} {cells[13]} {/* Row 2 */}
+      {cells[2]} {cells[6]} {cells[10]} {cells[14]} {/* Row 3 */}
+      {cells[3]} {cells[7]} {cells[11]} {cells[15]} {/* Row 4 */}
+    </div>
+  );
+});
 
 function App() {
-  const [imageSrc, setImageSrc] = useState<string | null>(null); // Renamed from 'image' for clarity
+  const [imageSource, setImageSource] = useState<CanvasImage | null>(null); // Decoded image shown by WebGLCanvas
+  const bitmapRef = useRef<ImageBitmap | null>(null); // Bitmap behind imageSource, closed when replaced
   const [originalImageData, setOriginalImageData] = useState<{ data: Uint8ClampedArray; width: number; height: number } | null>(null); // State for original pixels
   const [imageWidth, setImageWidth] = useState(0);
   const [imageHeight, setImageHeight] = useState(0);
@@ -33,93 +86,150 @@ function App() {
   const [translationY, setTranslationY] = useState(0);
   const [flipHorizontal, setFlipHorizontal] = useState(false);
   const [flipVertical, setFlipVertical] = useState(false);
-  const [transformMatrix, setTransformMatrix] = useState<mat4>(mat4.create());
-  const [rotationMatrix, setRotationMatrix] = useState<mat4>(mat4.create());
-  const [scaleMatrix, setScaleMatrix] = useState<mat4>(mat4.create());
-  const [shearMatrixState, setShearMatrixState] = useState<mat4>(mat4.create()); // Renamed to avoid conflict
-  const [translationMatrix, setTranslationMatrix] = useState<mat4>(mat4.create());
+  const transform = useMemo(() => new TransformController(), []); // Composes the canvas matrix in place
+  const [transformView, setTransformView] = useState<TransformSnapshot>(() => transform.snapshot()); // Throttled copy for the matrix panels
   const [isDraggingOver, setIsDraggingOver] = useState(false);
   const canvasContainerRef = useRef<HTMLDivElement>(null);
   const webGLCanvasRef = useRef<WebGLCanvasRef>(null);
-  const goRef = useRef<any>(null);
+  const enginePoolRef = useRef<WasmWorkerPool | null>(null); // Worker-hosted WASM engines
 
   const [wasmLoading, setWasmLoading] = useState(true);
   const [wasmError, setWasmError] = useState<string | null>(null);
+  const [engineBusy, setEngineBusy] = useState(false); // Engine runs in flight; new requests supersede them
+  const busyRunsRef = useRef(0);
   const [svdRank, setSvdRank] = useState(50);
-  const [transformedArea, setTransformedArea] = useState<number | null>(null); // State for transformed area
-
-  // Function to get original pixel data from an image source
-  const getPixelDataFromImageSrc = (src: string): Promise<{ data: Uint8ClampedArray; width: number; height: number }> => {
-    return new Promise((resolve, reject) => {
-      const img = new Image();
-      img.onload = () => {
-        const canvas = document.createElement('canvas');
-        canvas.width = img.naturalWidth;
-        canvas.height = img.naturalHeight;
-        const ctx = canvas.getContext('2d');
-        if (!ctx) {
-          return reject(new Error("Could not get 2D context"));
-        }
-        ctx.drawImage(img, 0, 0);
-        try {
-          const imageData = ctx.getImageData(0, 0, img.naturalWidth, img.naturalHeight);
-          resolve({ data: imageData.data, width: imageData.width, height: imageData.height });
-        } catch (e) {
-          // Handle potential SecurityError if image is tainted (e.g., CORS)
-          reject(new Error(`Could not get image data: ${e}`));
-        }
-      };
-      img.onerror = (err) => {
-        reject(new Error(`Failed to load image for pixel extraction: ${err}`));
-      };
-      img.crossOrigin = "anonymous"; // Attempt to prevent tainting for CORS images/data URLs
-      img.src = src;
-    });
+  const [svdRandomized, setSvdRandomized] = useState(true); // Truncated randomized SVD instead of full factorization
+  const [svdBlockMode, setSvdBlockMode] = useState(false); // Factor 64x64 blocks with per-block adaptive rank
+  const [svdYCbCr, setSvdYCbCr] = useState(false); // Luma at full rank, subsampled chroma at a quarter of it
+  const [svdEnergy, setSvdEnergy] = useState(0.99); // Energy retained per block in block mode
+  const [svdTarget, setSvdTarget] = useState<SVDTarget | null>(null); // Pick per-channel ranks by quality or size; the rank slider then caps them
+  const [svdTargetValues, setSvdTargetValues] = useState<Record<SVDTarget, number>>({ energy: 0.999, psnr: 32, bytes: 64 * 1024 });
+  const [svdLive, setSvdLive] = useState(false); // Re-run SVD on every rank slider change
+  const [gpuFilters, setGpuFilters] = useState(true); // Run convolutions and SVD reconstruction as WebGL passes; WASM is the fallback
+  const [stackFilters, setStackFilters] = useState(false); // Each effect adds a stage to one pipeline run on the original
+  const [pipelineStages, setPipelineStages] = useState<PipelineStage[]>([]); // Current stack in stacking mode
+  const [engineStats, setEngineStats] = useState<EngineStats | null>(null); // Timings of the last engine call
+  const [engineLogging, setEngineLogging] = useState(true); // Per-call console logging inside the engines
+  const previewOpRef = useRef<EngineOp | null>(null); // Operation shown from the GPU or a proxy level, re-run on the full image for export
+  const [lastOp, setLastOp] = useState<EngineOp | null>(null); // Operation behind the displayed result, applied by batch runs
+  const [batchProgress, setBatchProgress] = useState<{ completed: number; total: number; failed: number } | null>(null); // Batch in progress
+  const batchAbortRef = useRef<AbortController | null>(null);
+  const batchInputRef = useRef<HTMLInputElement>(null);
+  const [proxyPreview, setProxyPreview] = useState(true); // Interactive engine runs use the display-resolution pyramid level
+  const [exportFormat, setExportFormat] = useState<ImageFormat>('image/png'); // File type of Download Image
+  const [exporting, setExporting] = useState(false);
+  const [svdQuantization, setSvdQuantization] = useState<SVDQuantization>('int8'); // Factor precision in exported .tsvd files
+  const pendingSvdRankRef = useRef<number | null>(null); // Latest rank requested while a live preview runs
+  const svdPreviewBusyRef = useRef(false);
+  // SVD factors loaded on the canvas: the image and options they were fetched for (with
+  // the rank cap in target mode), their term count and the engine's ranks
+  const gpuSVDRef = useRef<{ image: EngineImage; key: string; terms: number; ranks: number[] } | null>(null);
+  const [gaussianRadius, setGaussianRadius] = useState(5);
+  const [customKernelText, setCustomKernelText] = useState('0 -1 0\n-1 5 -1\n0 -1 0');
+
+  // Downscaled copies of the original, built once per image
+  const pyramid = useMemo(() => originalImageData ? buildPyramid(originalImageData) : null, [originalImageData]);
+
+  // Image interactive engine runs start from: the smallest pyramid level covering the canvas
+  const interactiveImage = () => {
+    if (!proxyPreview || !pyramid) {
+      return originalImageData;
+    }
+    const container = canvasContainerRef.current;
+    return levelForDisplay(pyramid, container?.clientWidth ?? 800, container?.clientHeight ?? 600);
   };
 
+  // Shows source on the canvas, releasing the previous upload's bitmap
+  const showImage = (source: CanvasImage | null) => {
+    setImageSource(source);
+    bitmapRef.current?.close(); // Already uploaded to the texture, no longer needed
+    bitmapRef.current = source instanceof ImageBitmap ? source : null;
+  };
 
-  const processImageFile = (file: File) => {
-    if (file && file.type.startsWith('image/')) {
-      const reader = new FileReader();
-      reader.onloadend = async () => {
-        const newImageSrc = reader.result as string;
-        try {
-          // Get original pixel data *before* setting state
-          const pixelData = await getPixelDataFromImageSrc(newImageSrc);
-
-          setImageWidth(pixelData.width);
-          setImageHeight(pixelData.height);
-          setOriginalImageData(pixelData); // Store original data
-          setImageSrc(newImageSrc); // Set the source for WebGLCanvas
-
-          // Reset transforms
-          setRotation(0);
-          setScaleX(1);
-          setScaleY(1);
-          setIsScaleLinked(true);
-          setShearX(0);
-          setShearY(0);
-          setTranslationX(0);
-          setTranslationY(0);
-          setFlipHorizontal(false);
-          setFlipVertical(false);
-          setSvdRank(Math.min(50, pixelData.width, pixelData.height)); // Reset SVD rank based on new image
 
-        } catch (error) {
-           console.error("Error processing image:", error);
-           setWasmError(`Error processing image: ${error instanceof Error ? error.message : String(error)}`);
-           // Clear potentially stale state
-           setImageSrc(null);
-           setOriginalImageData(null);
-           setImageWidth(0);
-           setImageHeight(0);
-        }
-      };
-      reader.onerror = () => {
-        console.error("FileReader error");
-        setWasmError("Error reading file.");
-      };
-      reader.readAsDataURL(file);
+  const resetTransforms = () => {
+    setRotation(0);
+    setScaleX(1);
+    setScaleY(1);
+    setIsScaleLinked(true);
+    setShearX(0);
+    setShearY(0);
+    setTranslationX(0);
+    setTranslationY(0);
+    setFlipHorizontal(false);
+    setFlipVertical(false);
+  };
+
+  // Decodes a .tsvd container progressively. The first frame becomes the displayed
+  // image, later frames only update the texture, and the final frame becomes the
+  // original image data that further operations start from.
+  const loadTSVDFile = async (file: File) => {
+    setWasmError(null);
+    let shown = false;
+    const showFrame = (frame: DecodedFrame) => {
+      if (!shown) {
+        shown = true;
+        setImageWidth(frame.width);
+        setImageHeight(frame.height);
+        showImage(new ImageData(frame.data, frame.width, frame.height));
+        resetTransforms();
+      } else {
+        webGLCanvasRef.current?.updateTexture(frame.data, frame.width, frame.height);
+      }
+      console.log(`TSVD progressive decode: rank ${frame.rank}/${frame.totalRank}`);
+    };
+
+    try {
+      const final = await decodeSVDStream(file.stream(), showFrame);
+      const pixelData = { data: final.data, width: final.width, height: final.height };
+      setImageWidth(final.width);
+      setImageHeight(final.height);
+      setOriginalImageData(pixelData);
+      previewOpRef.current = null;
+      setPipelineStages([]);
+      showImage(new ImageData(final.data, final.width, final.height));
+      if (!shown) {
+        resetTransforms();
+      }
+      setSvdRank(Math.min(50, final.width, final.height));
+    } catch (error) {
+      console.error("Error decoding TSVD file:", error);
+      setWasmError(`Error decoding TSVD file: ${error instanceof Error ? error.message : String(error)}`);
+    }
+  };
+
+  // Decodes an upload exactly once: the bitmap goes straight to the WebGL texture, and
+  // its pixels are read back once for the engine. No data URL is ever built.
+  const loadImageFile = async (file: File) => {
+    try {
+      const bitmap = await decodeImageFile(file);
+      const pixelData = bitmapPixels(bitmap);
+
+      setImageWidth(pixelData.width);
+      setImageHeight(pixelData.height);
+      setOriginalImageData(pixelData); // Store original data
+      previewOpRef.current = null;
+      setPipelineStages([]);
+      showImage(bitmap);
+
+      resetTransforms();
+      setSvdRank(Math.min(50, pixelData.width, pixelData.height)); // Reset SVD rank based on new image
+    } catch (error) {
+      console.error("Error processing image:", error);
+      setWasmError(`Error processing image: ${error instanceof Error ? error.message : String(error)}`);
+      // Clear potentially stale state
+      showImage(null);
+      setOriginalImageData(null);
+      setImageWidth(0);
+      setImageHeight(0);
+    }
+  };
+
+  const processImageFile = (file: File) => {
+    if (file && isTSVDFile(file)) {
+      loadTSVDFile(file);
+    } else if (file && file.type.startsWith('image/')) {
+      loadImageFile(file);
     } else {
       console.error("Invalid file type. Please upload an image.");
       setWasmError("Invalid file type. Please upload an image.");
@@ -157,81 +267,29 @@ function App() {
     }
   };
 
-  // --- WASM Loading Effect (remains the same) ---
+  // --- WASM Engine Pool: main.wasm is compiled once, every worker instantiates it ---
   useEffect(() => {
-    if (!document.getElementById('wasm-exec-script')) {
-      const script = document.createElement('script');
-      script.id = 'wasm-exec-script';
-      script.src = '/wasm_exec.js';
-      script.async = true;
-      script.onload = () => {
-        console.log("wasm_exec.js loaded.");
-        loadWasm();
-      };
-      script.onerror = () => {
-        console.error("Failed to load wasm_exec.js");
-        setWasmError("Failed to load wasm_exec.js");
-        setWasmLoading(false);
-      };
-      document.body.appendChild(script);
-    } else if (window.Go && !goRef.current) { // Check if Go exists but not instantiated yet
-        loadWasm();
-    } else if (goRef.current) {
-        console.log("WASM already loaded or loading.");
-        setWasmLoading(false); // Assume loaded if goRef exists
-    }
+    const pool = new WasmWorkerPool();
+    enginePoolRef.current = pool;
+    console.log(`Starting ${pool.size} WASM engine worker(s)...`);
+    setWasmLoading(true);
+    setWasmError(null);
 
-    async function loadWasm() {
-      if (!window.Go) {
-        console.error("Go runtime not available");
-        setWasmError("Go runtime not available");
+    pool.ready
+      .then(() => {
+        console.log("WASM engine workers ready.");
         setWasmLoading(false);
-        return;
-      }
-      if (goRef.current) {
-        console.log("WASM already instantiated.");
+      })
+      .catch((error) => {
+        console.error("Error loading WASM engine workers:", error);
+        setWasmError(`Error loading WASM: ${error.message || error}`);
         setWasmLoading(false);
-        return;
-      }
+      });
 
-      try {
-        console.log("Instantiating Go WASM...");
-        setWasmLoading(true);
-        setWasmError(null);
-        const go = new window.Go();
-        goRef.current = go;
-
-        const wasmPath = '/main.wasm';
-        const result = await WebAssembly.instantiateStreaming(fetch(wasmPath), go.importObject);
-
-        console.log("WASM instantiation successful. Running module...");
-        // Don't block, run in background
-        Promise.resolve(go.run(result.instance)).catch(err => {
-            // Catch errors from go.run if it rejects asynchronously
-            console.error("Error during WASM execution:", err);
-            setWasmError(`Error during WASM execution: ${err}`);
-            setWasmLoading(false); // Ensure loading state is reset on error
-        });
-
-        // Check for functions shortly after run starts
-        setTimeout(() => {
-            if (typeof window.applyFilter !== 'function' || typeof window.compressSVD !== 'function') {
-                console.warn("WASM functions not found shortly after run. Check Go registration.");
-                // Optionally set an error or warning state here if functions are critical
-            } else {
-                console.log("WASM functions found on window.");
-            }
-            // Consider WASM 'ready' even if functions aren't immediately found,
-            // as they might be registered slightly later. The handlers will check again.
-            setWasmLoading(false);
-        }, 100); // Adjust timeout if needed
-
-      } catch (error) {
-        console.error("Error loading or running WASM:", error);
-        setWasmError(`Error loading WASM: ${error}`);
-        setWasmLoading(false);
-      }
-    }
+    return () => {
+      pool.terminate();
+      enginePoolRef.current = null;
+    };
   }, []);
 
 
@@ -258,171 +316,384 @@ function App() {
   };
 
 
-  // Calculate transformation matrices
+  useEffect(() => transform.subscribe(setTransformView), [transform]);
+
+  // Recompose the transform matrix in place; the canvas picks it up on its next frame
   useEffect(() => {
-    // --- Calculate individual matrices ---
-    const rotMat = mat4.create();
-    mat4.rotateZ(rotMat, rotMat, glMatrix.toRadian(-rotation));
-    setRotationMatrix(rotMat);
-
-    const scaleMat = mat4.create();
-    const finalScaleX = scaleX * (flipHorizontal ? -1 : 1);
-    const finalScaleY = scaleY * (flipVertical ? -1 : 1);
-    mat4.scale(scaleMat, scaleMat, [finalScaleX, finalScaleY, 1]);
-    setScaleMatrix(scaleMat);
-
-    const shearMat = mat4.fromValues(
-      1,    shearY, 0, 0, // Col 1
-      shearX, 1,      0, 0, // Col 2
-      0,    0,      1, 0, // Col 3
-      0,    0,      0, 1  // Col 4
-    );
-    setShearMatrixState(shearMat); // Use the state setter
-
-    const transMat = mat4.create();
-    const containerWidth = canvasContainerRef.current?.clientWidth ?? imageWidth; // Use imageWidth as fallback
-    const containerHeight = canvasContainerRef.current?.clientHeight ?? imageHeight; // Use imageHeight as fallback
-    const tx = containerWidth > 0 ? (translationX / containerWidth) * 2 : 0;
-    const ty = containerHeight > 0 ? (-translationY / containerHeight) * 2 : 0; // Y is inverted in clip space
-    mat4.translate(transMat, transMat, [tx, ty, 0]);
-    setTranslationMatrix(transMat);
-
-    // --- Calculate combined matrix (Order: Scale -> Shear -> Rotate -> Translate) ---
-    // Note: Matrix multiplication is read right-to-left for application order
-    const combinedMatrix = mat4.create();
-    mat4.multiply(combinedMatrix, transMat, rotMat); // T * R
-    mat4.multiply(combinedMatrix, combinedMatrix, shearMat); // T * R * Sh
-    mat4.multiply(combinedMatrix, combinedMatrix, scaleMat); // T * R * Sh * Sc
-    setTransformMatrix(combinedMatrix);
-
-    // Calculate and set transformed area
-    const determinant = mat4.determinant(combinedMatrix);
-    const area = 4 * Math.abs(determinant); // Original clip space area is 4 (-1 to 1)
-    setTransformedArea(area);
-
-  }, [rotation, scaleX, scaleY, shearX, shearY, translationX, translationY, flipHorizontal, flipVertical, imageWidth, imageHeight, isScaleLinked]); // Added isScaleLinked dependency back
-
-  // Helper function to display a matrix with modern styling
-  const MatrixDisplay = ({ matrix }: { matrix: mat4 }) => {
-    const formatNumber = (n: number) => n.toFixed(3);
-    // Flatten the matrix in column-major order as it's stored, then map to grid cells
-    const cells = [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15].map(index => (
-      <div key={index} className="p-1 text-center border border-border/50 rounded-sm bg-muted/50 text-xs font-mono ">
-        {formatNumber(matrix[index])}
-      </div>
-    ));
-
-    return (
-      <div className="grid grid-cols-4 gap-1 p-1 bg-muted/20 rounded">
-        {/* Render cells row by row for visual layout */}
-        {cells[0]} {cells[4]} {cells[8]} {cells[12]} {/* Row 1 */}
-        {cells[1]} {cells[5]} {cells[9]} {cells[13]} {/* Row 2 */}
-        {cells[2]} {cells[6]} {cells[10]} {cells[14]} {/* Row 3 */}
-        {cells[3]} {cells[7]} {cells[11]} {cells[15]} {/* Row 4 */}
-      </div>
-    );
+    transform.update({
+      rotation, scaleX, scaleY, shearX, shearY, translationX, translationY, flipHorizontal, flipVertical,
+      viewportWidth: canvasContainerRef.current?.clientWidth ?? imageWidth, // Use imageWidth as fallback
+      viewportHeight: canvasContainerRef.current?.clientHeight ?? imageHeight, // Use imageHeight as fallback
+    });
+    webGLCanvasRef.current?.redraw();
+  }, [rotation, scaleX, scaleY, shearX, shearY, translationX, translationY, flipHorizontal, flipVertical, imageWidth, imageHeight, transform]);
+
+  // Handle Download: the displayed result is rendered offscreen at native resolution,
+  // read back and encoded in a worker (see lib/imageExport.ts)
+  const handleDownload = async () => {
+    if (!webGLCanvasRef.current || !imageSource) {
+      return;
+    }
+    setExporting(true);
+    try {
+      // GPU passes and proxy levels only approximate the engine's full-resolution result
+      await handleRenderFullResolution();
+      const image = await webGLCanvasRef.current?.readPixels();
+      if (!image) {
+        return;
+      }
+      const startTime = performance.now();
+      const url = await exportImageURL(image, exportFormat, exportFormat === 'image/png' ? undefined : EXPORT_QUALITY);
+      console.log(`Exported ${image.width}x${image.height} ${exportFormat} in ${(performance.now() - startTime).toFixed(0)} ms.`);
+      downloadURL(url, `transformed-image.${IMAGE_FORMAT_EXTENSIONS[exportFormat]}`);
+    } catch (error: any) {
+      console.error('Error exporting image:', error);
+      setWasmError(`Export error: ${error.message || error}`);
+    } finally {
+      setExporting(false);
+    }
   };
 
+  // --- WASM Processing Handlers (run in the worker pool, off the main thread) ---
+
+  // Cancels the engine run whose result would otherwise overwrite the texture
+  const supersedeDisplay = () => enginePoolRef.current?.supersede(DISPLAY_LANE);
+
+  // Runs one engine operation and uploads the result to the texture. Interactive runs use
+  // the proxy level (see interactiveImage) unless fullResolution is set or the operation
+  // has no equivalent there (see proxyOp). buildOp describes the full-resolution result,
+  // which is what the engine stats label, exports and batches apply. Last write wins:
+  // starting a run cancels the previous one, which leaves the texture to its
+  // replacement. onPartial receives progressive SVD previews.
+  const runEngineOperation = async (label: string, errorPrefix: string, buildOp: () => EngineOp,
+    { onPartial, fullResolution = false }: { onPartial?: (partial: EnginePartial) => void; fullResolution?: boolean } = {}) => {
+    const pool = enginePoolRef.current;
+    if (wasmLoading || !originalImageData || !webGLCanvasRef.current || !pool) {
+      console.warn(`WASM not ready, original image data missing, or canvas ref missing for ${label}.`);
+      setWasmError(`Cannot apply ${label}: prerequisites not met.`);
+      return;
+    }
+
+    console.log(`Applying ${label} via WASM worker to original data...`);
+    const signal = pool.supersede(DISPLAY_LANE);
+    busyRunsRef.current++;
+    setEngineBusy(true);
+    setWasmError(null);
 
-  // Handle Download
-  const handleDownload = () => {
-    const canvasElement = webGLCanvasRef.current?.getCanvasElement();
-    if (canvasElement && imageSrc) {
-      const dataURL = canvasElement.toDataURL('image/png');
-      const link = document.createElement('a');
-      link.download = 'transformed-image.png';
-      link.href = dataURL;
-      link.click();
+    try {
+      const op = buildOp();
+      const level = fullResolution ? originalImageData : interactiveImage()!;
+      const levelOp = proxyOp(op, originalImageData, level);
+      const image = levelOp ? level : originalImageData;
+      const result = await runTiled(pool, image, levelOp ?? op, { signal, onPartial });
+      setEngineStats(result.stats ?? null);
+      console.log(`${label} applied successfully at ${image.width}x${image.height} in ${result.elapsedMs.toFixed(1)} ms. Updating texture.`);
+      // A proxy result stands in for the full-resolution one until it is rendered
+      previewOpRef.current = image === originalImageData ? null : op;
+      setLastOp(op);
+      webGLCanvasRef.current?.updateTexture(result.data, result.width, result.height);
+    } catch (error: any) {
+      if (isAbortError(error)) {
+        console.log(`${label} cancelled by a newer request.`);
+        return;
+      }
+      console.error(`Error applying ${label}:`, error);
+      setWasmError(`${errorPrefix} error: ${error.message || error}`);
+    } finally {
+      if (--busyRunsRef.current === 0) {
+        setEngineBusy(false);
+      }
+    }
+  };
+
+  // Replaces an approximate result on screen (GPU pass or proxy level) by the engine's
+  // full-resolution one; runs lazily, on export or when the user commits the preview
+  const handleRenderFullResolution = async () => {
+    const previewOp = previewOpRef.current;
+    if (previewOp) {
+      await runEngineOperation('full-resolution render', 'Render', () => previewOp, { fullResolution: true });
+    }
+  };
+
+  // Convolutions run as WebGL passes when enabled and supported, otherwise in the WASM
+  // engine. buildKernels returns null when the operation is not a pure convolution chain.
+  const runConvolution = (label: string, errorPrefix: string, buildOp: () => EngineOp, buildKernels: () => KernelSpec[] | null) => {
+    if (gpuFilters && !wasmLoading && webGLCanvasRef.current) {
+      try {
+        const kernels = buildKernels();
+        if (kernels && webGLCanvasRef.current.applyGpuKernels(kernels)) {
+          supersedeDisplay();
+          previewOpRef.current = buildOp();
+          setLastOp(previewOpRef.current);
+          setWasmError(null);
+          return;
+        }
+        console.log(`GPU path unavailable for ${label}, using WASM.`);
+      } catch (error: any) {
+        setWasmError(`${errorPrefix} error: ${error.message || error}`);
+        return;
+      }
     }
+    return runEngineOperation(label, errorPrefix, buildOp);
   };
 
-  // --- Modified WASM Processing Handlers ---
-  const handleApplyFilter = async (filterType: string) => {
-    // Use originalImageData instead of reading from GL canvas
-    if (wasmLoading || !originalImageData || !webGLCanvasRef.current || typeof window.applyFilter !== 'function') {
-      console.warn("WASM not ready, original image data missing, canvas ref missing, or applyFilter function not available.");
-      setWasmError("Cannot apply filter: prerequisites not met.");
+  const stageKernel = (stage: PipelineStage): KernelSpec | null =>
+    stage.op === 'filter' ? BUILTIN_FILTER_KERNELS[stage.filterType] ?? null : stage.op === 'kernel' ? stage.kernel : null;
+
+  // Runs stage through applyPipeline: appended to the stack in stacking mode, otherwise
+  // on its own. The whole stack is re-run on the original image in a single engine call.
+  const runPipelineStage = (label: string, buildStage: () => PipelineStage) => {
+    let stages: PipelineStage[];
+    try {
+      stages = stackFilters ? [...pipelineStages, buildStage()] : [buildStage()];
+    } catch (error: any) {
+      setWasmError(`Pipeline error: ${error.message || error}`);
       return;
     }
+    if (stackFilters) {
+      setPipelineStages(stages);
+    }
+    const kernels = stages.map(stageKernel);
+    return runConvolution(`pipeline (${label})`, 'Pipeline', () => ({ op: 'applyPipeline', stages }), () =>
+      kernels.every(kernel => kernel !== null) ? kernels as KernelSpec[] : null);
+  };
 
-    const { data, width, height } = originalImageData;
+  const handleApplyFilter = (filterType: string) => stackFilters
+    ? runPipelineStage(filterType, () => ({ op: 'filter', filterType }))
+    : runConvolution(`filter '${filterType}'`, 'Filter', () => ({ op: 'applyFilter', filterType }), () => [BUILTIN_FILTER_KERNELS[filterType]]);
+
+  // Runs a user-supplied or generated kernel through applyKernel
+  const handleApplyKernel = (label: string, buildKernel: () => KernelSpec) => stackFilters
+    ? runPipelineStage(label, () => ({ op: 'kernel', kernel: buildKernel() }))
+    : runConvolution(`${label} kernel`, 'Kernel', () => ({ op: 'applyKernel', kernel: buildKernel() }), () => [buildKernel()]);
+
+  // Point operations always run in the engine's pipeline, fused with any stacked convolution
+  const handleApplyPointOp = (type: PointOpType, amount?: number) =>
+    runPipelineStage(type, () => ({ op: 'point', type, amount }));
+
+  const handleClearStack = () => {
+    supersedeDisplay();
+    setPipelineStages([]);
+    previewOpRef.current = null;
+    setLastOp(null);
+    if (originalImageData) {
+      webGLCanvasRef.current?.updateTexture(originalImageData.data, originalImageData.width, originalImageData.height);
+    }
+  };
 
-    console.log(`Applying filter '${filterType}' via WASM to original data...`);
-    setWasmLoading(true);
+  // Rank targets apply to whole-channel RGB factors only (compressSVD and encodeSVD)
+  const svdTargetOptions = (): SVDOptions => svdTarget ? { target: svdTarget, targetValue: svdTargetValues[svdTarget] } : {};
+  const buildSVDOptions = (): SVDOptions => svdBlockMode
+    ? { blockSize: SVD_BLOCK_SIZE, energy: svdEnergy }
+    : { method: svdRandomized ? 'randomized' : 'full', colorSpace: svdYCbCr ? 'ycbcr' : 'rgb', ...(svdYCbCr ? {} : svdTargetOptions()) };
+
+  // Progressive previews go straight to the texture; the final result replaces them
+  const showSVDPartial = (partial: EnginePartial) => {
+    webGLCanvasRef.current?.updateTexture(partial.data, partial.width, partial.height);
+    previewOpRef.current = null;
+  };
+
+  // SVD reconstruction on the GPU: the engine only factors (served from its cache after
+  // the first call) and the canvas sums the rank-1 terms of the factor textures in a
+  // shader. At a fixed rank, factors are fetched once per image and options, so later
+  // rank changes only change a uniform; targets need the engine's ranks for every cap.
+  // Returns false when the GPU path does not apply and the engine should reconstruct.
+  const runGpuSVD = async (rank: number, options: SVDOptions): Promise<boolean> => {
+    const pool = enginePoolRef.current;
+    if (!gpuFilters || wasmLoading || !pool || !originalImageData || !webGLCanvasRef.current || options.blockSize || options.colorSpace === 'ycbcr') {
+      return false;
+    }
+    // Factors of the proxy level, at the rank and options that match rank on the original
+    const image = interactiveImage()!;
+    const { rank: levelRank, options: levelOptions } = proxySVD(rank, options, originalImageData, image)!;
+    const key = JSON.stringify(levelOptions) + (levelOptions.target ? `@${levelRank}` : '');
+    let loaded = gpuSVDRef.current;
+    try {
+      if (!loaded || loaded.image !== image || loaded.key !== key || levelRank > loaded.terms) {
+        const terms = levelOptions.target ? levelRank : Math.max(levelRank, Math.min(image.width, image.height, GPU_SVD_TERMS));
+        const result = await runTiled(pool, image, { op: 'svdFactors', rank: terms, options: levelOptions }, { signal: pool.supersede(DISPLAY_LANE) });
+        gpuSVDRef.current = null;
+        const data = new Float32Array(result.data.buffer, result.data.byteOffset, result.data.length / 4);
+        if (!result.factors || !webGLCanvasRef.current?.setSVDFactors({ data, width: result.width, height: result.height, terms: result.factors.terms })) {
+          return false;
+        }
+        loaded = { image, key, ...result.factors };
+        gpuSVDRef.current = loaded;
+        // At a fixed rank the report describes the fetched terms, not the displayed rank
+        setEngineStats(result.stats ? { ...result.stats, svd: options.target ? result.stats.svd : undefined } : null);
+      }
+    } catch (error) {
+      if (isAbortError(error)) {
+        throw error;
+      }
+      console.warn('GPU SVD factors unavailable, using WASM:', error);
+      return false;
+    }
+
+    const ranks = levelOptions.target ? loaded.ranks : loaded.ranks.map(r => Math.min(r, levelRank));
+    if (!webGLCanvasRef.current?.showSVDRanks(ranks)) {
+      gpuSVDRef.current = null;
+      return false;
+    }
+    supersedeDisplay();
+    const op: EngineOp = { op: 'compressSVD', rank, options };
+    previewOpRef.current = op; // The shader's rounding differs slightly; exports re-run the engine
+    setLastOp(op);
     setWasmError(null);
+    return true;
+  };
 
+  // Live rank preview. The engine caches each channel's SVD factors, so after the first
+  // run a rank change only re-sums rank-1 terms. While one preview runs, slider moves
+  // overwrite the pending rank and cancel the run in flight, so only the latest rank
+  // is computed to the end.
+  const previewSVDRank = async (rank: number) => {
+    const pool = enginePoolRef.current;
+    if (!pool || !originalImageData || !webGLCanvasRef.current) {
+      return;
+    }
+    pendingSvdRankRef.current = Math.max(1, Math.min(rank, originalImageData.width, originalImageData.height));
+    if (svdPreviewBusyRef.current) {
+      supersedeDisplay();
+      return;
+    }
+    svdPreviewBusyRef.current = true;
     try {
-      // 1. Prepare data for Go (already have it)
-      const imageDataForGo = { width, height, data };
-
-      // 2. Call WASM function
-      const result = await window.applyFilter(imageDataForGo, filterType);
-
-      // 3. Handle result
-      if (result && 'error' in result) { // Check for error object
-        throw new Error(result.error);
-      } else if (result instanceof Uint8ClampedArray) {
-         console.log(`Filter '${filterType}' applied successfully. Updating texture.`);
-         // 4. Update WebGL Texture with the processed data
-         webGLCanvasRef.current.updateTexture(result, width, height);
+      while (pendingSvdRankRef.current !== null) {
+        const nextRank = pendingSvdRankRef.current;
+        pendingSvdRankRef.current = null;
+        const options = buildSVDOptions();
+        const op: EngineOp = { op: 'compressSVD', rank: nextRank, options, previewRanks: svdPreviewRanks(nextRank, originalImageData) };
+        try {
+          if (await runGpuSVD(nextRank, options)) {
+            continue;
+          }
+          const level = interactiveImage()!;
+          const levelOp = proxyOp(op, originalImageData, level);
+          const image = levelOp ? level : originalImageData;
+          const result = await runTiled(pool, image, levelOp ?? op, { signal: pool.supersede(DISPLAY_LANE), onPartial: showSVDPartial });
+          setEngineStats(result.stats ?? null);
+          webGLCanvasRef.current?.updateTexture(result.data, result.width, result.height);
+          previewOpRef.current = image === originalImageData ? null : op;
+          setLastOp(op);
+        } catch (error) {
+          if (!isAbortError(error)) {
+            throw error;
+          }
+        }
+      }
+    } catch (error: any) {
+      console.error('Error during live SVD preview:', error);
+      setWasmError(`SVD error: ${error.message || error}`);
+    } finally {
+      svdPreviewBusyRef.current = false;
+    }
+  };
+
+  // Applies the operation behind the displayed result to every selected file at full
+  // resolution and downloads the results as one ZIP archive
+  const handleBatchFiles = async (event: React.ChangeEvent<HTMLInputElement>) => {
+    const files = Array.from(event.target.files ?? []).filter(file => file.type.startsWith('image/'));
+    event.target.value = ''; // Picking the same files again must fire onChange
+    const pool = enginePoolRef.current;
+    const op = lastOp;
+    if (!pool || !op || files.length === 0) {
+      return;
+    }
+    const controller = new AbortController();
+    batchAbortRef.current = controller;
+    setBatchProgress({ completed: 0, total: files.length, failed: 0 });
+    setWasmError(null);
+    const startTime = performance.now();
+    let failed = 0;
+    try {
+      const items = await runBatch(pool, files, image => batchOp(op, image), {
+        signal: controller.signal,
+        onItem: (item, completed, total) => {
+          if (item.error) {
+            failed++;
+            console.error(`Batch: ${item.file.name} failed: ${item.error}`);
+          }
+          setBatchProgress({ completed, total, failed });
+        },
+      });
+      console.log(`Batch of ${files.length} file(s) processed in ${(performance.now() - startTime).toFixed(0)} ms.`);
+      if (failed < files.length) {
+        await downloadBatch(items, 'tinyimg-batch');
+      }
+      if (failed > 0) {
+        setWasmError(`Batch: ${failed} of ${files.length} file(s) failed (see console).`);
+      }
+    } catch (error: any) {
+      if (isAbortError(error)) {
+        console.log('Batch cancelled.');
       } else {
-         throw new Error("Invalid data returned from WASM applyFilter function.");
+        console.error('Error during batch processing:', error);
+        setWasmError(`Batch error: ${error.message || error}`);
       }
+    } finally {
+      batchAbortRef.current = null;
+      setBatchProgress(null);
+    }
+  };
 
+  // Exports the truncated factors as a .tsvd container instead of reconstructed pixels
+  const handleDownloadCompressed = async () => {
+    const pool = enginePoolRef.current;
+    if (!pool || !originalImageData) {
+      setWasmError("Cannot export compressed image: prerequisites not met.");
+      return;
+    }
+    const { width, height } = originalImageData;
+    const rank = Math.max(1, Math.min(svdRank, width, height));
+    setWasmLoading(true);
+    setWasmError(null);
+    try {
+      // The container stores whole-channel RGB factors, so YCbCr and block mode do not apply
+      const options = { method: svdRandomized ? 'randomized' : 'full', quantization: svdQuantization, ...svdTargetOptions() } as const;
+      const result = await pool.run(originalImageData, { op: 'encodeSVD', rank, options });
+      setEngineStats(result.stats ?? null);
+      const ratio = originalImageData.data.length / result.data.length;
+      const ranks = result.stats?.svd ? result.stats.svd.ranks.join('/') : rank;
+      console.log(`TSVD export: ranks ${ranks}, ${result.data.length} bytes (${ratio.toFixed(1)}x smaller than RGBA) in ${result.elapsedMs.toFixed(1)} ms`);
+      downloadTSVD(new Uint8Array(result.data.buffer, result.data.byteOffset, result.data.length), `compressed-rank${rank}`);
     } catch (error: any) {
-      console.error(`Error applying filter '${filterType}':`, error);
-      setWasmError(`Filter error: ${error.message || error}`);
+      console.error('Error exporting TSVD:', error);
+      setWasmError(`SVD export error: ${error.message || error}`);
     } finally {
       setWasmLoading(false);
     }
   };
 
   const handleApplySVD = async () => {
-     // Use originalImageData instead of reading from GL canvas
-     if (wasmLoading || !originalImageData || !webGLCanvasRef.current || typeof window.compressSVD !== 'function') {
-       console.warn("WASM not ready, original image data missing, canvas ref missing, or compressSVD function not available.");
-       setWasmError("Cannot apply SVD: prerequisites not met.");
-       return;
-     }
-
-     const { data, width, height } = originalImageData;
-
-     // Ensure rank is valid
-     const validRank = Math.max(1, Math.min(svdRank, width, height));
-     if (validRank !== svdRank) {
-        console.warn(`Adjusting SVD rank from ${svdRank} to ${validRank} based on image dimensions.`);
-        setSvdRank(validRank); // Update state for consistency
-     }
-
-
-     console.log(`Applying SVD compression (rank ${validRank}) via WASM to original data...`);
-     setWasmLoading(true);
-     setWasmError(null);
-
-     try {
-       // 1. Prepare data for Go (already have it)
-       const imageDataForGo = { width, height, data };
-
-       // 2. Call WASM function
-       const result = await window.compressSVD(imageDataForGo, validRank);
-
-       // 3. Handle result
-       if (result && 'error' in result) { // Check for error object
-         throw new Error(result.error);
-       } else if (result instanceof Uint8ClampedArray) {
-          console.log(`SVD (rank ${validRank}) applied successfully. Updating texture.`);
-          // 4. Update WebGL Texture with the processed data
-          webGLCanvasRef.current.updateTexture(result, width, height);
-       } else {
-          throw new Error("Invalid data returned from WASM compressSVD function.");
-       }
-
-     } catch (error: any) {
-       console.error(`Error applying SVD:`, error);
-       setWasmError(`SVD error: ${error.message || error}`);
-     } finally {
-       setWasmLoading(false);
-     }
+    if (!originalImageData) {
+      setWasmError("Cannot apply SVD: prerequisites not met.");
+      return;
+    }
+    const { width, height } = originalImageData;
+
+    // Ensure rank is valid
+    const validRank = Math.max(1, Math.min(svdRank, width, height));
+    if (validRank !== svdRank) {
+      console.warn(`Adjusting SVD rank from ${svdRank} to ${validRank} based on image dimensions.`);
+      setSvdRank(validRank); // Update state for consistency
+    }
+    const svdOptions = buildSVDOptions();
+    const modeLabel = svdBlockMode
+      ? `${SVD_BLOCK_SIZE}px blocks, ${(svdEnergy * 100).toFixed(1)}% energy`
+      : `${svdOptions.method}${svdYCbCr ? ', YCbCr' : ''}${svdOptions.target ? `, ${formatSVDTarget(svdOptions.target, svdOptions.targetValue!)}` : ''}`;
+
+    try {
+      if (await runGpuSVD(validRank, svdOptions)) {
+        console.log(`SVD (rank ${validRank}, ${modeLabel}) reconstructed on the GPU.`);
+        return;
+      }
+    } catch {
+      return; // runGpuSVD only throws when a newer request superseded it
+    }
+    const previewRanks = svdBlockMode ? undefined : svdPreviewRanks(validRank, originalImageData);
+    return runEngineOperation(`SVD compression (${svdOptions.target ? 'max ' : ''}rank ${validRank}, ${modeLabel})`, 'SVD',
+      () => ({ op: 'compressSVD', rank: validRank, options: svdOptions, previewRanks }), { onPartial: showSVDPartial });
   };
 
 
@@ -442,13 +713,13 @@ function App() {
                 <Label htmlFor="rotation-slider">Rotation</Label>
                 <span className="text-sm text-muted-foreground">{rotation}°</span>
               </div>
-              <Slider id="rotation-slider" min={-360} max={360} step={1} value={[rotation]} onValueChange={(v) => setRotation(v[0])} disabled={!imageSrc} />
+              <Slider id="rotation-slider" min={-360} max={360} step={1} value={[rotation]} onValueChange={(v) => setRotation(v[0])} disabled={!imageSource} />
             </div>
 
             {/* Scale Controls */}
             <div className="space-y-4">
               <div className="flex items-center space-x-2">
-                <Switch id="link-scale-switch" checked={isScaleLinked} onCheckedChange={handleLinkScaleChange} disabled={!imageSrc} />
+                <Switch id="link-scale-switch" checked={isScaleLinked} onCheckedChange={handleLinkScaleChange} disabled={!imageSource} />
                 <Label htmlFor="link-scale-switch">Link Scale X/Y</Label>
               </div>
               <div className="space-y-2">
@@ -456,14 +727,14 @@ function App() {
                   <Label htmlFor="scale-x-slider">Scale X</Label>
                   <span className="text-sm text-muted-foreground">{scaleX.toFixed(2)}x</span>
                 </div>
-                <Slider id="scale-x-slider" min={0.1} max={3} step={0.05} value={[scaleX]} onValueChange={(v) => handleScaleXChange(v[0])} disabled={!imageSrc} />
+                <Slider id="scale-x-slider" min={0.1} max={3} step={0.05} value={[scaleX]} onValueChange={(v) => handleScaleXChange(v[0])} disabled={!imageSource} />
               </div>
               <div className="space-y-2">
                 <div className="flex justify-between items-center">
                   <Label htmlFor="scale-y-slider">Scale Y</Label>
                   <span className="text-sm text-muted-foreground">{scaleY.toFixed(2)}x</span>
                 </div>
-                <Slider id="scale-y-slider" min={0.1} max={3} step={0.05} value={[scaleY]} onValueChange={(v) => handleScaleYChange(v[0])} disabled={!imageSrc || isScaleLinked} />
+                <Slider id="scale-y-slider" min={0.1} max={3} step={0.05} value={[scaleY]} onValueChange={(v) => handleScaleYChange(v[0])} disabled={!imageSource || isScaleLinked} />
               </div>
             </div>
 
@@ -474,14 +745,14 @@ function App() {
                     <Label htmlFor="shear-x-slider">Shear X</Label>
                     <span className="text-sm text-muted-foreground">{shearX.toFixed(2)}</span>
                   </div>
-                  <Slider id="shear-x-slider" min={-1} max={1} step={0.01} value={[shearX]} onValueChange={(v) => setShearX(v[0])} disabled={!imageSrc} />
+                  <Slider id="shear-x-slider" min={-1} max={1} step={0.01} value={[shearX]} onValueChange={(v) => setShearX(v[0])} disabled={!imageSource} />
                 </div>
                 <div className="space-y-2">
                   <div className="flex justify-between items-center">
                     <Label htmlFor="shear-y-slider">Shear Y</Label>
                     <span className="text-sm text-muted-foreground">{shearY.toFixed(2)}</span>
                   </div>
-                  <Slider id="shear-y-slider" min={-1} max={1} step={0.01} value={[shearY]} onValueChange={(v) => setShearY(v[0])} disabled={!imageSrc} />
+                  <Slider id="shear-y-slider" min={-1} max={1} step={0.01} value={[shearY]} onValueChange={(v) => setShearY(v[0])} disabled={!imageSource} />
                 </div>
               </div>
 
@@ -491,22 +762,22 @@ function App() {
                 <Label htmlFor="translate-x-slider">Translate X</Label>
                 <span className="text-sm text-muted-foreground">{translationX} px</span>
               </div>
-              <Slider id="translate-x-slider" min={-500} max={500} step={1} value={[translationX]} onValueChange={(v) => setTranslationX(v[0])} disabled={!imageSrc} />
+              <Slider id="translate-x-slider" min={-500} max={500} step={1} value={[translationX]} onValueChange={(v) => setTranslationX(v[0])} disabled={!imageSource} />
             </div>
             <div className="space-y-2">
               <div className="flex justify-between items-center">
                 <Label htmlFor="translate-y-slider">Translate Y</Label>
                 <span className="text-sm text-muted-foreground">{translationY} px</span>
               </div>
-              <Slider id="translate-y-slider" min={-500} max={500} step={1} value={[translationY]} onValueChange={(v) => setTranslationY(v[0])} disabled={!imageSrc} />
+              <Slider id="translate-y-slider" min={-500} max={500} step={1} value={[translationY]} onValueChange={(v) => setTranslationY(v[0])} disabled={!imageSource} />
             </div>
 
             {/* Flip Buttons */}
             <div className="space-y-2 pt-4">
-              <Button variant="outline" onClick={() => setFlipHorizontal(prev => !prev)} className="w-full" disabled={!imageSrc}>
+              <Button variant="outline" onClick={() => setFlipHorizontal(prev => !prev)} className="w-full" disabled={!imageSource}>
                 Flip Horizontal {flipHorizontal ? '(On)' : '(Off)'}
               </Button>
-              <Button variant="outline" onClick={() => setFlipVertical(prev => !prev)} className="w-full" disabled={!imageSrc}>
+              <Button variant="outline" onClick={() => setFlipVertical(prev => !prev)} className="w-full" disabled={!imageSource}>
                 Flip Vertical {flipVertical ? '(On)' : '(Off)'}
               </Button>
             </div>
@@ -536,20 +807,19 @@ function App() {
         onDrop={handleDrop}
       >
         {/* File Input */}
-        {!imageSrc && (
+        {!imageSource && (
           <div className="mb-4 w-full max-w-md flex justify-center">
-            <input type="file" accept="image/*" onChange={handleImageUpload} className="text-sm file:mr-4 file:py-2 file:px-4 file:rounded-full file:border-0 file:text-sm file:font-semibold file:bg-primary file:text-primary-foreground hover:file:bg-primary/90" />
+            <input type="file" accept="image/*,.tsvd" onChange={handleImageUpload} className="text-sm file:mr-4 file:py-2 file:px-4 file:rounded-full file:border-0 file:text-sm file:font-semibold file:bg-primary file:text-primary-foreground hover:file:bg-primary/90" />
           </div>
         )}
 
         {/* Canvas Container */}
         <div className={`w-full h-full flex items-center justify-center relative border rounded-lg ${isDraggingOver ? 'border-primary border-dashed border-2' : 'border-border'} bg-muted/40 overflow-hidden`}>
-          {imageSrc ? (
+          {imageSource ? (
             <WebGLCanvas
               ref={webGLCanvasRef}
-              imageSrc={imageSrc} // Use imageSrc state
-              transformMatrix={transformMatrix}
-              preserveDrawingBuffer={true}
+              image={imageSource}
+              transformMatrix={transform.matrix}
               // Use container dimensions for canvas sizing
               width={canvasContainerRef.current?.clientWidth ?? 800}
               height={canvasContainerRef.current?.clientHeight ?? 600}
@@ -572,14 +842,83 @@ function App() {
             {/* WASM Filters */}
             <div className="space-y-2 border-border">
               <Label className="text-sm font-medium">Filters</Label>
+              <div className="flex items-center space-x-2">
+                <Switch id="gpu-filters-switch" checked={gpuFilters} onCheckedChange={setGpuFilters} disabled={!imageSource} />
+                <Label htmlFor="gpu-filters-switch">GPU filters and SVD (exact WASM on export)</Label>
+              </div>
+              <div className="flex items-center space-x-2">
+                <Switch id="proxy-preview-switch" checked={proxyPreview} onCheckedChange={setProxyPreview} disabled={!imageSource} />
+                <Label htmlFor="proxy-preview-switch">Preview at display resolution</Label>
+              </div>
+              <Button variant="outline" size="sm" className="w-full" onClick={handleRenderFullResolution} disabled={wasmLoading || !imageSource}>
+                Render Full Resolution
+              </Button>
               <div className="grid grid-cols-2 gap-2">
                 {['blur', 'sharpen', 'edge', 'emboss'].map(filter => (
-                  <Button key={filter} variant="outline" size="sm" onClick={() => handleApplyFilter(filter)} disabled={wasmLoading || !imageSrc}>
+                  <Button key={filter} variant="outline" size="sm" onClick={() => handleApplyFilter(filter)} disabled={wasmLoading || !imageSource}>
                     {filter.charAt(0).toUpperCase() + filter.slice(1)}
                   </Button>
                 ))}
               </div>
-              {wasmLoading && <p className="text-xs text-muted-foreground">Processing...</p>}
+              {/* Point operations (lookup tables fused into the pipeline) */}
+              <div className="grid grid-cols-2 gap-2">
+                <Button variant="outline" size="sm" onClick={() => handleApplyPointOp('brightness', 20)} disabled={wasmLoading || !imageSource}>Brighten</Button>
+                <Button variant="outline" size="sm" onClick={() => handleApplyPointOp('contrast', 1.2)} disabled={wasmLoading || !imageSource}>Contrast</Button>
+                <Button variant="outline" size="sm" onClick={() => handleApplyPointOp('gamma', 1.2)} disabled={wasmLoading || !imageSource}>Gamma</Button>
+                <Button variant="outline" size="sm" onClick={() => handleApplyPointOp('invert')} disabled={wasmLoading || !imageSource}>Invert</Button>
+              </div>
+              <div className="flex items-center space-x-2">
+                <Switch id="stack-filters-switch" checked={stackFilters} onCheckedChange={(checked) => { setStackFilters(checked); setPipelineStages([]); }} disabled={!imageSource} />
+                <Label htmlFor="stack-filters-switch">Stack effects</Label>
+              </div>
+              {stackFilters && (
+                <div className="flex items-center justify-between gap-2">
+                  <span className="text-xs text-muted-foreground truncate">
+                    {pipelineStages.length > 0
+                      ? pipelineStages.map(stage => stage.op === 'filter' ? stage.filterType : stage.op === 'point' ? stage.type : stage.op).join(' → ')
+                      : 'Empty stack'}
+                  </span>
+                  <Button variant="outline" size="sm" onClick={handleClearStack} disabled={wasmLoading || pipelineStages.length === 0}>Clear</Button>
+                </div>
+              )}
+              {/* Gaussian blur (separable, any radius) */}
+              <div className="space-y-2 pt-2">
+                <div className="flex justify-between items-center">
+                  <Label htmlFor="gaussian-radius-slider">Gaussian Radius</Label>
+                  <span className="text-sm text-muted-foreground">{gaussianRadius} px</span>
+                </div>
+                <Slider
+                  id="gaussian-radius-slider" min={1} max={50} step={1} value={[gaussianRadius]}
+                  onValueChange={(v) => {
+                    setGaussianRadius(v[0]);
+                    // A Gaussian shown from the GPU or a proxy level follows the slider in real time
+                    const previewOp = previewOpRef.current;
+                    if (previewOp?.op === 'applyKernel' && 'row' in previewOp.kernel) {
+                      handleApplyKernel('gaussian', () => makeGaussianKernel(v[0]));
+                    }
+                  }}
+                  disabled={wasmLoading || !imageSource}
+                />
+                <Button variant="outline" size="sm" className="w-full" onClick={() => handleApplyKernel('gaussian', () => makeGaussianKernel(gaussianRadius))} disabled={wasmLoading || !imageSource}>
+                  Gaussian Blur
+                </Button>
+              </div>
+
+              {/* Custom kernel */}
+              <div className="space-y-2 pt-2">
+                <Label htmlFor="custom-kernel-input">Custom Kernel</Label>
+                <textarea
+                  id="custom-kernel-input"
+                  className="w-full h-20 p-2 text-xs font-mono border border-border rounded-md bg-background resize-y"
+                  value={customKernelText}
+                  onChange={(e) => setCustomKernelText(e.target.value)}
+                  disabled={wasmLoading || !imageSource}
+                />
+                <Button variant="outline" size="sm" className="w-full" onClick={() => handleApplyKernel('custom', () => parseKernelText(customKernelText))} disabled={wasmLoading || !imageSource}>
+                  Apply Custom Kernel
+                </Button>
+              </div>
+              {(wasmLoading || engineBusy) && <p className="text-xs text-muted-foreground">Processing...</p>}
               {wasmError && <p className="text-xs text-destructive">{wasmError}</p>}
             </div>
 
@@ -588,7 +927,7 @@ function App() {
                <Label className="text-sm font-medium">SVD Compression</Label>
                <div className="space-y-2">
                  <div className="flex justify-between items-center">
-                   <Label htmlFor="svd-rank-slider-right">Rank</Label> {/* Ensure unique ID if needed */}
+                   <Label htmlFor="svd-rank-slider-right">{svdTarget && !svdBlockMode && !svdYCbCr ? 'Max Rank' : 'Rank'}</Label> {/* Ensure unique ID if needed */}
                    <span className="text-sm text-muted-foreground">{svdRank}</span>
                  </div>
                  <Slider
@@ -597,21 +936,120 @@ function App() {
                    max={Math.max(1, Math.min(imageWidth, imageHeight, 100))}
                    step={1}
                    value={[svdRank]}
-                   onValueChange={(value) => setSvdRank(value[0])}
-                   disabled={wasmLoading || !imageSrc || imageWidth === 0 || imageHeight === 0}
+                   onValueChange={(value) => {
+                     setSvdRank(value[0]);
+                     if (svdLive) {
+                       previewSVDRank(value[0]);
+                     }
+                   }}
+                   disabled={(wasmLoading && !svdLive) || !imageSource || imageWidth === 0 || imageHeight === 0}
                  />
                </div>
-               <Button onClick={handleApplySVD} className="w-full" disabled={wasmLoading || !imageSrc}>
+               <div className="space-y-2">
+                 <Label className="text-xs text-muted-foreground">Choose ranks by</Label>
+                 <Tabs value={svdTarget ?? 'rank'} onValueChange={(value) => setSvdTarget(value === 'rank' ? null : value as SVDTarget)} className="w-full">
+                   <TabsList className="grid w-full grid-cols-4 h-auto">
+                     <TabsTrigger value="rank" className="text-xs px-1 py-1" disabled={wasmLoading || !imageSource}>Rank</TabsTrigger>
+                     <TabsTrigger value="energy" className="text-xs px-1 py-1" disabled={wasmLoading || !imageSource || svdBlockMode}>Energy</TabsTrigger>
+                     <TabsTrigger value="psnr" className="text-xs px-1 py-1" disabled={wasmLoading || !imageSource || svdBlockMode}>PSNR</TabsTrigger>
+                     <TabsTrigger value="bytes" className="text-xs px-1 py-1" disabled={wasmLoading || !imageSource || svdBlockMode}>Size</TabsTrigger>
+                   </TabsList>
+                 </Tabs>
+                 {svdTarget && !svdBlockMode && (
+                   <>
+                     <div className="flex justify-between items-center">
+                       <Label htmlFor="svd-target-slider">Target</Label>
+                       <span className="text-sm text-muted-foreground">{formatSVDTarget(svdTarget, svdTargetValues[svdTarget])}</span>
+                     </div>
+                     <Slider
+                       id="svd-target-slider"
+                       {...(svdTarget === 'energy'
+                         ? { min: 0.9, max: 0.9999, step: 0.0001 }
+                         : svdTarget === 'psnr'
+                           ? { min: 20, max: 50, step: 0.5 }
+                           : { min: 1024, max: Math.max(2048, Math.ceil(imageWidth * imageHeight / 1024) * 1024), step: 1024 })} // Size: up to a quarter of the RGBA bytes
+                       value={[svdTargetValues[svdTarget]]}
+                       onValueChange={(value) => setSvdTargetValues(values => ({ ...values, [svdTarget]: value[0] }))}
+                       disabled={wasmLoading || !imageSource}
+                     />
+                     {svdYCbCr && <p className="text-xs text-muted-foreground">YCbCr mode uses the rank; the target applies to .tsvd exports.</p>}
+                   </>
+                 )}
+               </div>
+               <div className="flex items-center space-x-2">
+                 <Switch id="svd-randomized-switch" checked={svdRandomized} onCheckedChange={setSvdRandomized} disabled={wasmLoading || !imageSource} />
+                 <Label htmlFor="svd-randomized-switch">Fast (randomized)</Label>
+               </div>
+               <div className="flex items-center space-x-2">
+                 <Switch id="svd-ycbcr-switch" checked={svdYCbCr} onCheckedChange={setSvdYCbCr} disabled={wasmLoading || !imageSource || svdBlockMode} />
+                 <Label htmlFor="svd-ycbcr-switch">Luma/chroma (YCbCr)</Label>
+               </div>
+               <div className="flex items-center space-x-2">
+                 <Switch id="svd-block-switch" checked={svdBlockMode} onCheckedChange={setSvdBlockMode} disabled={wasmLoading || !imageSource} />
+                 <Label htmlFor="svd-block-switch">Block mode (adaptive rank)</Label>
+               </div>
+               <div className="flex items-center space-x-2">
+                 <Switch id="svd-live-switch" checked={svdLive} onCheckedChange={setSvdLive} disabled={!imageSource} />
+                 <Label htmlFor="svd-live-switch">Live rank preview</Label>
+               </div>
+               {svdBlockMode && (
+                 <div className="space-y-2">
+                   <div className="flex justify-between items-center">
+                     <Label htmlFor="svd-energy-slider">Energy Retained</Label>
+                     <span className="text-sm text-muted-foreground">{(svdEnergy * 100).toFixed(1)}%</span>
+                   </div>
+                   <Slider
+                     id="svd-energy-slider"
+                     min={0.9}
+                     max={0.9999}
+                     step={0.0001}
+                     value={[svdEnergy]}
+                     onValueChange={(value) => setSvdEnergy(value[0])}
+                     disabled={wasmLoading || !imageSource}
+                   />
+                 </div>
+               )}
+               <Button onClick={handleApplySVD} className="w-full" disabled={wasmLoading || !imageSource}>
                  Apply SVD
                </Button>
+               <div className="flex items-center space-x-2">
+                 <Switch id="svd-float16-switch" checked={svdQuantization === 'float16'} onCheckedChange={(checked) => setSvdQuantization(checked ? 'float16' : 'int8')} disabled={wasmLoading || !imageSource} />
+                 <Label htmlFor="svd-float16-switch">Float16 factors (larger, more precise)</Label>
+               </div>
+               <Button onClick={handleDownloadCompressed} variant="outline" className="w-full" disabled={wasmLoading || !imageSource}>
+                 Download Compressed (.tsvd)
+               </Button>
+            </div>
+
+            {/* Batch Processing */}
+            <div className="space-y-2 pt-4 border-t border-border">
+              <Label className="text-sm font-medium">Batch Processing</Label>
+              <p className="text-xs text-muted-foreground">
+                {lastOp ? 'Applies the last operation to many files and downloads a ZIP.' : 'Apply an operation to the image first.'}
+              </p>
+              <input ref={batchInputRef} type="file" accept="image/*" multiple onChange={handleBatchFiles} className="hidden" />
+              {batchProgress ? (
+                <div className="space-y-2">
+                  <p className="text-xs text-muted-foreground">
+                    {batchProgress.completed} / {batchProgress.total} done{batchProgress.failed > 0 ? `, ${batchProgress.failed} failed` : ''}
+                  </p>
+                  <Button variant="outline" size="sm" className="w-full" onClick={() => batchAbortRef.current?.abort()}>
+                    Cancel Batch
+                  </Button>
+                </div>
+              ) : (
+                <Button variant="outline" size="sm" className="w-full" onClick={() => batchInputRef.current?.click()} disabled={wasmLoading || !lastOp}>
+                  Process Files...
+                </Button>
+              )}
             </div>
 
             {/* Transformed Area Display */}
-            {imageSrc && transformedArea !== null && (
+            {imageSource && (
               <div className="pb-4 mb-4"> {/* Add padding and bottom border for separation */}
                 <Label className="text-sm font-medium mb-1 block">Transformed Area</Label>
                 {/* Display the area, formatted to a few decimal places */}
-                <p className="text-lg font-semibold text-center">{transformedArea.toFixed(4)}</p>
+                <p className="text-lg font-semibold text-center">{transformView.area.toFixed(4)}</p>
                 {/* Add context about the calculation */}
                 <p className="text-xs text-muted-foreground text-center">Formula: Area = 4 × |det(M)|</p>
               </div>
@@ -629,27 +1067,43 @@ function App() {
                  <TabsTrigger value="shear" className="text-xs px-2 py-1">Shear</TabsTrigger>
                </TabsList>
                <TabsContent value="overall">
-                 <MatrixDisplay matrix={transformMatrix} />
+                 <MatrixDisplay matrix={transformView.overall} />
                </TabsContent>
                <TabsContent value="translate">
-                 <MatrixDisplay matrix={translationMatrix} />
+                 <MatrixDisplay matrix={transformView.translation} />
                </TabsContent>
                <TabsContent value="rotate">
-                 <MatrixDisplay matrix={rotationMatrix} />
+                 <MatrixDisplay matrix={transformView.rotation} />
                </TabsContent>
                <TabsContent value="scale">
-                 <MatrixDisplay matrix={scaleMatrix} />
+                 <MatrixDisplay matrix={transformView.scale} />
                </TabsContent>
                <TabsContent value="shear">
-                 <MatrixDisplay matrix={shearMatrixState} />
+                 <MatrixDisplay matrix={transformView.shear} />
                </TabsContent>
              </Tabs>
            </div>
+
+            <EngineStatsPanel
+              stats={engineStats}
+              logging={engineLogging}
+              onLoggingChange={(enabled) => {
+                setEngineLogging(enabled);
+                enginePoolRef.current?.setLogging(enabled);
+              }}
+            />
           </CardContent>
           {/* Download Button */}
-          <div className="p-4 border-t border-border">
-            <Button onClick={handleDownload} className="w-full" disabled={!imageSrc}>
-              Download Image
+          <div className="p-4 border-t border-border space-y-2">
+            <Tabs value={exportFormat} onValueChange={(value) => setExportFormat(value as ImageFormat)} className="w-full">
+              <TabsList className="grid w-full grid-cols-3">
+                <TabsTrigger value="image/png" className="text-xs px-1 py-1" disabled={exporting}>PNG</TabsTrigger>
+                <TabsTrigger value="image/webp" className="text-xs px-1 py-1" disabled={exporting}>WebP</TabsTrigger>
+                <TabsTrigger value="image/jpeg" className="text-xs px-1 py-1" disabled={exporting}>JPEG</TabsTrigger>
+              </TabsList>
+            </Tabs>
+            <Button onClick={handleDownload} className="w-full" disabled={!imageSource || exporting}>
+              {exporting ? 'Exporting...' : 'Download Image'}
             </Button>
           </div>
 
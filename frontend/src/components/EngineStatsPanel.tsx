@@ -0,0 +1,102 @@
+import React from 'react';
+import { Label } from './ui/label';
+import { Switch } from './ui/switch';
+import type { EngineStats, SVDRankReport } from '../lib/engineProtocol';
+
+interface EngineStatsPanelProps {
+  stats: EngineStats | null;
+  logging: boolean;
+  onLoggingChange: (enabled: boolean) => void;
+}
+
+const formatBytes = (bytes: number) => {
+  if (bytes >= 1024 * 1024) {
+    return `${(bytes / (1024 * 1024)).toFixed(1)} MB`;
+  }
+  if (bytes >= 1024) {
+    return `${(bytes / 1024).toFixed(1)} KB`;
+  }
+  return `${bytes} B`;
+};
+
+const CHANNEL_NAMES = ['R', 'G', 'B', 'A'];
+const CHANNEL_COLORS = ['#ef4444', '#22c55e', '#3b82f6', '#a3a3a3'];
+const CURVE_WIDTH = 200;
+const CURVE_HEIGHT = 60;
+
+// Cumulative energy of each factored channel against the number of terms, with the
+// chosen rank marked. The vertical axis starts at the lowest first-term energy, since
+// the leading term of a photograph already holds most of its energy.
+const EnergyCurves: React.FC<{ report: SVDRankReport }> = ({ report }) => {
+  const curves = report.energy.map((curve, c) => ({ curve, c })).filter(({ curve }) => curve && curve.length > 0);
+  if (curves.length === 0) {
+    return null;
+  }
+  const terms = Math.max(...curves.map(({ curve }) => curve!.length));
+  const floor = Math.min(...curves.map(({ curve }) => curve![0]));
+  const x = (i: number) => (terms > 1 ? (i / (terms - 1)) * CURVE_WIDTH : 0);
+  const y = (e: number) => CURVE_HEIGHT - ((e - floor) / Math.max(1 - floor, 1e-9)) * CURVE_HEIGHT;
+  return (
+    <svg viewBox={`0 0 ${CURVE_WIDTH} ${CURVE_HEIGHT}`} className="w-full h-16 bg-muted rounded" preserveAspectRatio="none">
+      {curves.map(({ curve, c }) => (
+        <g key={c} stroke={CHANNEL_COLORS[c]} fill="none" strokeWidth={1}>
+          <polyline points={curve!.map((e, i) => `${x(i)},${y(e)}`).join(' ')} vectorEffect="non-scaling-stroke" />
+          {report.ranks[c] > 0 && <line x1={x(report.ranks[c] - 1)} x2={x(report.ranks[c] - 1)} y1={0} y2={CURVE_HEIGHT} strokeDasharray="2 2" vectorEffect="non-scaling-stroke" />}
+        </g>
+      ))}
+    </svg>
+  );
+};
+
+// Chosen ranks, estimated quality and size of a whole-channel SVD call
+const SVDReport: React.FC<{ report: SVDRankReport }> = ({ report }) => (
+  <>
+    <div className="flex justify-between font-semibold pt-1">
+      <span>SVD ranks</span>
+      <span>{report.ranks.map((r, c) => (r > 0 ? `${CHANNEL_NAMES[c]}${r}` : null)).filter(Boolean).join(' ') || 'none'}</span>
+    </div>
+    <div className="flex justify-between"><span>est. PSNR</span><span>{Number.isFinite(report.psnr) ? `${report.psnr.toFixed(2)} dB` : 'exact'}</span></div>
+    <div className="flex justify-between"><span>.tsvd size</span><span>{formatBytes(report.bytes)} ({report.compressionRatio.toFixed(1)}x)</span></div>
+    {!report.met && (
+      <div className="text-destructive">
+        Target not reached{report.target === 'bytes' ? ': one term per channel exceeds the budget' : ' within the rank cap'}
+      </div>
+    )}
+    <EnergyCurves report={report} />
+  </>
+);
+
+// Stats of the last engine call (for tiled operations, the slowest tile)
+const EngineStatsPanel: React.FC<EngineStatsPanelProps> = ({ stats, logging, onLoggingChange }) => (
+  <div className="pt-4 border-t border-border space-y-2">
+    <Label className="text-sm font-medium block">Engine Performance</Label>
+    <div className="flex items-center space-x-2">
+      <Switch id="engine-logging-switch" checked={logging} onCheckedChange={onLoggingChange} />
+      <Label htmlFor="engine-logging-switch">Engine console logging</Label>
+    </div>
+    {stats ? (
+      <div className="text-xs font-mono space-y-1">
+        <div className="flex justify-between font-semibold">
+          <span>{stats.op}</span>
+          <span>{stats.totalMs.toFixed(1)} ms</span>
+        </div>
+        {stats.phases.map((phase, i) => (
+          <div key={i} className="flex justify-between text-muted-foreground">
+            <span>{phase.name}</span>
+            <span>{phase.ms.toFixed(1)} ms</span>
+          </div>
+        ))}
+        <div className="flex justify-between"><span>copied in / out</span><span>{formatBytes(stats.bytesIn)} / {formatBytes(stats.bytesOut)}</span></div>
+        <div className="flex justify-between"><span>allocations</span><span>{stats.mallocs} ({formatBytes(stats.allocBytes)})</span></div>
+        <div className="flex justify-between"><span>heap in use</span><span>{formatBytes(stats.heapInUse)}</span></div>
+        <div className="flex justify-between"><span>heap high-water</span><span>{formatBytes(stats.heapHighWater)}</span></div>
+        <div className="flex justify-between"><span>heap reserved</span><span>{formatBytes(stats.heapSys)}</span></div>
+        {stats.svd && <SVDReport report={stats.svd} />}
+      </div>
+    ) : (
+      <p className="text-xs text-muted-foreground">Run an operation to see its timings.</p>
+    )}
+  </div>
+);
+
+export default EngineStatsPanel;
@@ -1,9 +1,17 @@
 import { useRef, useEffect, forwardRef, useImperativeHandle } from 'react';
 import { mat4 } from 'gl-matrix';
+import type { KernelSpec } from '../lib/kernels';
+import { createTargetTexture, GpuConvolver, GpuPass, kernelToPasses } from '../lib/gpuConvolution';
+import { GpuSVDRenderer, SVDFactorTextures } from '../lib/gpuSVD';
+import { StreamingTexture } from '../lib/textureManager';
+import type { EngineImage } from '../lib/wasmWorkerPool';
+
+// Decoded image shown on the canvas: an ImageBitmap from an upload, or raw pixels
+export type CanvasImage = ImageBitmap | ImageData;
 
 interface WebGLCanvasProps {
-  imageSrc: string;
-  transformMatrix: mat4;
+  image: CanvasImage;
+  transformMatrix: mat4; // May be updated in place (see TransformController); call redraw afterwards
   width: number;
   height: number;
   preserveDrawingBuffer?: boolean; // Add prop for preserving buffer
@@ -12,8 +20,26 @@ interface WebGLCanvasProps {
 // Define the interface for the methods exposed via the ref
 export interface WebGLCanvasRef {
   getGL: () => WebGLRenderingContext | null;
+  // Schedules a draw for the next animation frame, e.g. after transformMatrix changed in place
+  redraw: () => void;
   updateTexture: (data: Uint8ClampedArray, width: number, height: number) => void;
+  // The canvas, with any frame still waiting for requestAnimationFrame drawn first, so
+  // its pixels can be read right away
   getCanvasElement: () => HTMLCanvasElement | null;
+  // Convolves the image passed as the image prop with the kernels, in order, on the GPU and
+  // displays the result. Returns false when a kernel is too large or WebGL cannot run
+  // the passes, in which case the caller should fall back to the WASM engine.
+  applyGpuKernels: (kernels: KernelSpec[]) => boolean;
+  // Loads SVD factor textures of the image prop (possibly at a smaller size) for
+  // showSVDRanks. Returns false when WebGL cannot reconstruct them on the GPU.
+  setSVDFactors: (factors: SVDFactorTextures) => boolean;
+  // Displays the loaded factors reconstructed at per-channel ranks (R, G, B, A); rank 0
+  // keeps the image prop's channel. Returns false when no factors are loaded.
+  showSVDRanks: (ranks: number[]) => boolean;
+  // Renders the displayed result with the current transform at the image prop's native
+  // size into an offscreen framebuffer and reads it back, top row first. Resolves with
+  // null when nothing is displayed. Needs no preserveDrawingBuffer.
+  readPixels: () => Promise<EngineImage | null>;
 }
 
 const vertexShaderSource = `
@@ -74,20 +100,115 @@ function createProgram(gl: WebGLRenderingContext, vertexShader: WebGLShader, fra
   return null;
 }
 
+// The final draw's program with everything it needs cached at init: its uniform
+// locations and the quad's attribute setup. With OES_vertex_array_object the setup is
+// recorded once in a vertex array object; otherwise bindQuad replays it.
+interface SceneState {
+  program: WebGLProgram;
+  matrixLocation: WebGLUniformLocation | null;
+  imageLocation: WebGLUniformLocation | null;
+  bindQuad: () => void;
+  // Restores the default attribute state, which the GPU passes set up for themselves
+  unbindQuad: () => void;
+}
+
+function createScene(gl: WebGLRenderingContext, program: WebGLProgram): SceneState {
+  // Set rectangle coordinates (clip space)
+  const positionBuffer = gl.createBuffer();
+  gl.bindBuffer(gl.ARRAY_BUFFER, positionBuffer);
+  const positions = [
+    -1.0, -1.0,
+     1.0, -1.0,
+    -1.0,  1.0,
+    -1.0,  1.0,
+     1.0, -1.0,
+     1.0,  1.0,
+  ];
+  gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(positions), gl.STATIC_DRAW);
+
+  // Set texture coordinates (flipped Y to match image data origin)
+  const texCoordBuffer = gl.createBuffer();
+  gl.bindBuffer(gl.ARRAY_BUFFER, texCoordBuffer);
+  const texCoords = [
+    0.0, 1.0, // Bottom-left vertex -> Top-left texture coord
+    1.0, 1.0, // Bottom-right vertex -> Top-right texture coord
+    0.0, 0.0, // Top-left vertex -> Bottom-left texture coord
+    0.0, 0.0, // Top-left vertex -> Bottom-left texture coord
+    1.0, 1.0, // Bottom-right vertex -> Top-right texture coord
+    1.0, 0.0, // Top-right vertex -> Bottom-right texture coord
+  ];
+  gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(texCoords), gl.STATIC_DRAW);
+
+  const positionLocation = gl.getAttribLocation(program, 'a_position');
+  const texCoordLocation = gl.getAttribLocation(program, 'a_texCoord');
+  const setupAttributes = () => {
+    gl.enableVertexAttribArray(positionLocation);
+    gl.bindBuffer(gl.ARRAY_BUFFER, positionBuffer);
+    gl.vertexAttribPointer(positionLocation, 2, gl.FLOAT, false, 0, 0);
+    gl.enableVertexAttribArray(texCoordLocation);
+    gl.bindBuffer(gl.ARRAY_BUFFER, texCoordBuffer);
+    gl.vertexAttribPointer(texCoordLocation, 2, gl.FLOAT, false, 0, 0);
+  };
+  const scene = {
+    program,
+    matrixLocation: gl.getUniformLocation(program, 'u_matrix'),
+    imageLocation: gl.getUniformLocation(program, 'u_image'),
+  };
+
+  const vaoExt = gl.getExtension('OES_vertex_array_object');
+  if (vaoExt) {
+    const vao = vaoExt.createVertexArrayOES()!;
+    vaoExt.bindVertexArrayOES(vao);
+    setupAttributes();
+    vaoExt.bindVertexArrayOES(null);
+    return { ...scene, bindQuad: () => vaoExt.bindVertexArrayOES(vao), unbindQuad: () => vaoExt.bindVertexArrayOES(null) };
+  }
+  return {
+    ...scene,
+    bindQuad: setupAttributes,
+    unbindQuad: () => {
+      gl.disableVertexAttribArray(positionLocation);
+      gl.disableVertexAttribArray(texCoordLocation);
+    },
+  };
+}
+
+// Draws texture on the quad transformed by matrix into the bound framebuffer
+function renderQuad(gl: WebGLRenderingContext, scene: SceneState, texture: WebGLTexture, matrix: mat4) {
+  gl.useProgram(scene.program);
+  scene.bindQuad();
+  gl.uniformMatrix4fv(scene.matrixLocation, false, matrix);
+
+  // Set the texture
+  gl.activeTexture(gl.TEXTURE0);
+  gl.bindTexture(gl.TEXTURE_2D, texture);
+  gl.uniform1i(scene.imageLocation, 0);
+
+  // Draw the rectangle
+  gl.drawArrays(gl.TRIANGLES, 0, 6);
+  scene.unbindQuad();
+}
+
+// Framebuffer rows are read back bottom-up; mirroring clip-space Y puts the top row first
+const READBACK_FLIP = mat4.fromScaling(mat4.create(), [1, -1, 1]);
+
 // Use forwardRef to pass the canvas ref up
 // The first generic should be the type of the exposed handle (WebGLCanvasRef)
 const WebGLCanvas = forwardRef<WebGLCanvasRef, WebGLCanvasProps>(
-  ({ imageSrc, transformMatrix, width, height, preserveDrawingBuffer = false }, ref) => {
+  ({ image, transformMatrix, width, height, preserveDrawingBuffer = false }, ref) => {
   // Use an internal ref for the actual canvas DOM element
   const internalCanvasRef = useRef<HTMLCanvasElement>(null);
   // Note: 'ref' passed to useImperativeHandle is the forwarded ref from the parent.
   // We use internalCanvasRef for direct DOM access within this component.
   const glRef = useRef<WebGLRenderingContext | null>(null);
-  const programRef = useRef<WebGLProgram | null>(null);
-  const imageRef = useRef<HTMLImageElement | null>(null);
-  const textureRef = useRef<WebGLTexture | null>(null);
-  const positionBufferRef = useRef<WebGLBuffer | null>(null);
-  const texCoordBufferRef = useRef<WebGLBuffer | null>(null);
+  const sceneRef = useRef<SceneState | null>(null); // Program, cached locations and quad attributes
+  const imageRef = useRef<CanvasImage | null>(null);
+  const textureRef = useRef<StreamingTexture | null>(null); // The image prop or the latest CPU result
+  const originalTextureRef = useRef<StreamingTexture | null>(null); // The image prop, input of GPU filters
+  const displayTextureRef = useRef<WebGLTexture | null>(null); // GPU filter output shown instead of textureRef
+  const convolverRef = useRef<GpuConvolver | null | undefined>(undefined); // null once GPU convolution proved unavailable
+  const svdRendererRef = useRef<GpuSVDRenderer | null | undefined>(undefined); // null once GPU SVD proved unavailable
+  const frameRef = useRef<number | null>(null); // Pending requestAnimationFrame draw
 
   // Initialize WebGL context, shaders, program, buffers
   useEffect(() => {
@@ -109,86 +230,55 @@ const WebGLCanvas = forwardRef<WebGLCanvasRef, WebGLCanvasProps>(
 
     const program = createProgram(gl, vertexShader, fragmentShader);
     if (!program) return;
-    programRef.current = program;
-
-    // Create buffers for position and texture coordinates
-    positionBufferRef.current = gl.createBuffer();
-    texCoordBufferRef.current = gl.createBuffer();
-
-    // Set rectangle coordinates (clip space)
-    gl.bindBuffer(gl.ARRAY_BUFFER, positionBufferRef.current);
-    const positions = [
-      -1.0, -1.0,
-       1.0, -1.0,
-      -1.0,  1.0,
-      -1.0,  1.0,
-       1.0, -1.0,
-       1.0,  1.0,
-    ];
-    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(positions), gl.STATIC_DRAW);
-
-    // Set texture coordinates (flipped Y to match image data origin)
-    gl.bindBuffer(gl.ARRAY_BUFFER, texCoordBufferRef.current);
-    const texCoords = [
-      0.0, 1.0, // Bottom-left vertex -> Top-left texture coord
-      1.0, 1.0, // Bottom-right vertex -> Top-right texture coord
-      0.0, 0.0, // Top-left vertex -> Bottom-left texture coord
-      0.0, 0.0, // Top-left vertex -> Bottom-left texture coord
-      1.0, 1.0, // Bottom-right vertex -> Top-right texture coord
-      1.0, 0.0, // Top-right vertex -> Bottom-right texture coord
-    ];
-    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(texCoords), gl.STATIC_DRAW);
-
-    // Create texture
-    textureRef.current = gl.createTexture();
-    gl.bindTexture(gl.TEXTURE_2D, textureRef.current);
-    // Fill the texture with a 1x1 blue pixel initially
-    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, 1, 1, 0, gl.RGBA, gl.UNSIGNED_BYTE, new Uint8Array([0, 0, 255, 255]));
-    // Set texture parameters
-    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
-    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
-    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.LINEAR);
-    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
+    sceneRef.current = createScene(gl, program);
 
+    textureRef.current = new StreamingTexture(gl);
+    // Fill the texture with a 1x1 blue pixel initially
+    textureRef.current.upload(new Uint8ClampedArray([0, 0, 255, 255]), 1, 1);
+    originalTextureRef.current = new StreamingTexture(gl, 1); // Only changes with the image prop
+
+    return () => {
+      convolverRef.current?.dispose();
+      convolverRef.current = undefined;
+      svdRendererRef.current?.dispose();
+      svdRendererRef.current = undefined;
+      textureRef.current?.dispose();
+      originalTextureRef.current?.dispose();
+      if (frameRef.current !== null) {
+        cancelAnimationFrame(frameRef.current);
+        frameRef.current = null;
+      }
+    };
   }, []);
 
-  // Load image and update texture
+  // Upload the already decoded image to both textures; no Image element or data URL involved
   useEffect(() => {
     const gl = glRef.current;
     if (!gl || !textureRef.current) return;
 
-    const img = new Image();
-    img.crossOrigin = "anonymous"; // Important for loading images from data URLs or other origins
-    img.onload = () => {
-      imageRef.current = img;
-      gl.bindTexture(gl.TEXTURE_2D, textureRef.current);
-      gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, gl.RGBA, gl.UNSIGNED_BYTE, img);
-      // Trigger a re-render after image loads
-      drawScene();
-    };
-    img.onerror = (err) => {
-        console.error("Error loading image:", err);
-    }
-    img.src = imageSrc;
-
-  }, [imageSrc]);
+    imageRef.current = image;
+    displayTextureRef.current = null;
+    svdRendererRef.current?.clearFactors(); // They describe the previous image
+    textureRef.current.upload(image, image.width, image.height);
+    originalTextureRef.current?.upload(image, image.width, image.height);
+    requestDraw();
+  }, [image]);
 
 
-  // Draw scene function
+  // Draws the current texture with the current props. Callers use requestDraw, which
+  // coalesces every update of one animation frame into a single draw.
   const drawScene = () => {
     const gl = glRef.current;
-    const program = programRef.current;
-    const positionBuffer = positionBufferRef.current;
-    const texCoordBuffer = texCoordBufferRef.current;
-    const texture = textureRef.current;
+    const scene = sceneRef.current;
+    const texture = displayTextureRef.current ?? textureRef.current?.texture;
 
-    if (!gl || !program || !positionBuffer || !texCoordBuffer || !texture || !imageRef.current) {
+    if (!gl || !scene || !texture || !imageRef.current) {
       return;
     }
 
     // Set canvas size based on image dimensions or props
-    const displayWidth = width || imageRef.current.naturalWidth;
-    const displayHeight = height || imageRef.current.naturalHeight;
+    const displayWidth = width || imageRef.current.width;
+    const displayHeight = height || imageRef.current.height;
 
     if (gl.canvas.width !== displayWidth || gl.canvas.height !== displayHeight) {
         gl.canvas.width = displayWidth;
@@ -200,94 +290,48 @@ const WebGLCanvas = forwardRef<WebGLCanvasRef, WebGLCanvasProps>(
     gl.clearColor(0.0, 0.0, 0.0, 0.0); // Clear to transparent black
     gl.clear(gl.COLOR_BUFFER_BIT);
 
-    gl.useProgram(program);
-
-    // Setup attributes
-    const positionLocation = gl.getAttribLocation(program, 'a_position');
-    gl.enableVertexAttribArray(positionLocation);
-    gl.bindBuffer(gl.ARRAY_BUFFER, positionBuffer);
-    gl.vertexAttribPointer(positionLocation, 2, gl.FLOAT, false, 0, 0);
-
-    const texCoordLocation = gl.getAttribLocation(program, 'a_texCoord');
-    gl.enableVertexAttribArray(texCoordLocation);
-    gl.bindBuffer(gl.ARRAY_BUFFER, texCoordBuffer);
-    gl.vertexAttribPointer(texCoordLocation, 2, gl.FLOAT, false, 0, 0);
-
-    // Setup uniforms
-    const matrixLocation = gl.getUniformLocation(program, 'u_matrix');
-    const imageLocation = gl.getUniformLocation(program, 'u_image');
-
-    // --- Transformation Matrix Calculation ---
-    // We need to map clip space (-1 to 1) to pixel space (0 to width/height)
-    // and then apply the user's transformMatrix.
-    // Finally, map back to clip space.
-
-    // Matrix to convert from pixels to clip space
-    const projectionMatrix = mat4.create();
-    mat4.ortho(projectionMatrix, 0, gl.canvas.width, gl.canvas.height, 0, -1, 1); // Use ortho for 2D
-
-    // The user's transformMatrix operates in a coordinate system where
-    // the image is centered at (0,0) and scaled to fit within -1 to 1.
-    // We need to adjust this. Let's assume the user matrix transforms
-    // coordinates from (-1, -1) to (1, 1) relative to the image center.
-
-    // 1. Translate image center to origin
-    const translateToOrigin = mat4.create();
-    mat4.translate(translateToOrigin, translateToOrigin, [-gl.canvas.width / 2, -gl.canvas.height / 2, 0]);
-
-    // 2. Scale image to fit canvas (this might need adjustment based on desired behavior)
-    // For now, let's assume the user matrix handles scaling relative to the original size.
-
-    // 3. Apply user's transformation (rotation, scale, translate)
-    // The user matrix expects coordinates in the -1 to 1 range.
-    // Our vertex positions are already in -1 to 1 clip space.
-    // Let's rethink: The vertex shader takes positions from -1 to 1.
-    // The transformMatrix should directly transform these clip space coordinates.
-
-    // Let's simplify: The transformMatrix passed in should already account
-    // for the desired rotation, scale, and translation in clip space.
-    // We might need to adjust how it's calculated in App.tsx.
-
-    // For now, pass the user's matrix directly. We'll refine in App.tsx.
-    // We still need the projection to map the final clip space coords correctly.
-    // gl_Position = u_projectionMatrix * u_modelViewMatrix * vec4(a_position, 0.0, 1.0);
-    // Let's combine projection and modelView into u_matrix for simplicity in the shader.
-
-    // The user matrix transforms from model space (-1 to 1 square) to world space (scaled, rotated, translated).
-    // The projection matrix transforms from world space to clip space.
-    // Let's adjust the vertex shader to take two matrices? Or combine them here.
-
-    // Let's assume transformMatrix transforms from the base quad (-1 to 1)
-    // to the desired position/orientation/scale *in clip space*.
-    // The ortho projection is usually for camera view, maybe not needed if we work directly in clip space.
-
-    // Revised approach:
-    // Vertices are -1 to 1.
-    // transformMatrix directly manipulates these vertices in clip space.
-    // Example: To scale by 0.5, the matrix would scale x and y by 0.5.
-    // Example: To translate right by 0.1 clip units, matrix translates x by 0.1.
-
-    gl.uniformMatrix4fv(matrixLocation, false, transformMatrix);
-
-
-    // Set the texture
-    gl.activeTexture(gl.TEXTURE0);
-    gl.bindTexture(gl.TEXTURE_2D, texture);
-    gl.uniform1i(imageLocation, 0);
-
-    // Draw the rectangle
-    gl.drawArrays(gl.TRIANGLES, 0, 6);
+    // The vertices span -1 to 1 and transformMatrix (see transformController.ts) applies
+    // the rotation, scale, shear and translation in clip space, so no projection is needed.
+    renderQuad(gl, scene, texture, transformMatrix);
   }
 
+  // Latest drawScene, so a scheduled frame draws with the props of the last render
+  const drawSceneRef = useRef(drawScene);
+  drawSceneRef.current = drawScene;
+
+  // Schedules a draw for the next animation frame. Slider drags change the transform on
+  // every React update; those updates and any texture uploads collapse into one draw.
+  const requestDraw = () => {
+    if (frameRef.current === null) {
+      frameRef.current = requestAnimationFrame(() => {
+        frameRef.current = null;
+        drawSceneRef.current();
+      });
+    }
+  };
+
+  // Draws a scheduled frame right away
+  const flushDraw = () => {
+    if (frameRef.current !== null) {
+      cancelAnimationFrame(frameRef.current);
+      frameRef.current = null;
+      drawSceneRef.current();
+    }
+  };
+
   // Redraw when transform matrix changes
   useEffect(() => {
-    drawScene();
+    requestDraw();
   }, [transformMatrix, width, height]); // Redraw also if canvas size props change
 
   // Expose methods to parent component via ref
   useImperativeHandle(ref, () => ({
     getGL: () => glRef.current,
-    getCanvasElement: () => internalCanvasRef.current ?? null,
+    redraw: requestDraw,
+    getCanvasElement: () => {
+      flushDraw();
+      return internalCanvasRef.current ?? null;
+    },
     updateTexture: (data: Uint8ClampedArray, texWidth: number, texHeight: number) => {
       const gl = glRef.current;
       const texture = textureRef.current;
@@ -296,35 +340,107 @@ const WebGLCanvas = forwardRef<WebGLCanvasRef, WebGLCanvasProps>(
         return;
       }
 
-      // Bind the texture
-      gl.bindTexture(gl.TEXTURE_2D, texture);
-
-      // Upload the new pixel data
-      // Use texImage2D to potentially resize the texture storage if dimensions changed,
-      // or texSubImage2D if dimensions are guaranteed to be the same.
-      // Let's use texImage2D for flexibility.
-      gl.texImage2D(
-        gl.TEXTURE_2D, // target
-        0,             // level
-        gl.RGBA,       // internalformat
-        texWidth,      // width
-        texHeight,     // height
-        0,             // border
-        gl.RGBA,       // format
-        gl.UNSIGNED_BYTE, // type
-        data           // pixels
-      );
-
-      // Update the imageRef dimensions if needed (though imageRef isn't strictly used after initial load now)
-      // if (imageRef.current) {
-      //   imageRef.current.width = texWidth;
-      //   imageRef.current.height = texHeight;
-      // }
+      // CPU results replace any GPU filter output on screen
+      displayTextureRef.current = null;
+
+      // Same-size results overwrite the idle buffer in place (see textureManager.ts)
+      texture.upload(data, texWidth, texHeight);
 
       console.log(`Texture updated with ${texWidth}x${texHeight} data.`);
 
       // Redraw the scene with the updated texture
-      drawScene();
+      requestDraw();
+    },
+    applyGpuKernels: (kernels: KernelSpec[]) => {
+      const gl = glRef.current;
+      const img = imageRef.current;
+      if (!gl || !img || !originalTextureRef.current || convolverRef.current === null) {
+        return false;
+      }
+      const passes: GpuPass[] = [];
+      for (const kernel of kernels) {
+        const kernelPasses = kernelToPasses(kernel);
+        if (!kernelPasses) {
+          return false;
+        }
+        passes.push(...kernelPasses);
+      }
+      try {
+        convolverRef.current ??= new GpuConvolver(gl);
+        displayTextureRef.current = passes.length > 0
+          ? convolverRef.current.run(originalTextureRef.current.texture, img.width, img.height, passes)
+          : null;
+      } catch (error) {
+        console.warn('GPU convolution unavailable, falling back to WASM:', error);
+        convolverRef.current = null;
+        return false;
+      }
+      requestDraw();
+      return true;
+    },
+    setSVDFactors: (factors: SVDFactorTextures) => {
+      const gl = glRef.current;
+      if (!gl || svdRendererRef.current === null) {
+        return false;
+      }
+      try {
+        svdRendererRef.current ??= new GpuSVDRenderer(gl);
+        return svdRendererRef.current.setFactors(factors);
+      } catch (error) {
+        console.warn('GPU SVD reconstruction unavailable, falling back to WASM:', error);
+        svdRendererRef.current?.dispose();
+        svdRendererRef.current = null;
+        return false;
+      }
+    },
+    showSVDRanks: (ranks: number[]) => {
+      const renderer = svdRendererRef.current;
+      if (!renderer?.hasFactors || !originalTextureRef.current) {
+        return false;
+      }
+      displayTextureRef.current = renderer.render(originalTextureRef.current.texture, ranks);
+      requestDraw();
+      return true;
+    },
+    readPixels: async () => {
+      const gl = glRef.current;
+      const scene = sceneRef.current;
+      const texture = displayTextureRef.current ?? textureRef.current?.texture;
+      const img = imageRef.current;
+      if (!gl || !scene || !texture || !img) {
+        return null;
+      }
+      const { width: exportWidth, height: exportHeight } = img;
+      const [maxWidth, maxHeight] = gl.getParameter(gl.MAX_VIEWPORT_DIMS) as Int32Array;
+      if (exportWidth > maxWidth || exportHeight > maxHeight) {
+        throw new Error(`Cannot render ${exportWidth}x${exportHeight} for export: the GPU viewport is limited to ${maxWidth}x${maxHeight}`);
+      }
+
+      const target = createTargetTexture(gl, exportWidth, exportHeight, gl.UNSIGNED_BYTE, gl.NEAREST);
+      const framebuffer = gl.createFramebuffer();
+      try {
+        gl.bindFramebuffer(gl.FRAMEBUFFER, framebuffer);
+        gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, target, 0);
+        gl.viewport(0, 0, exportWidth, exportHeight);
+        gl.clearColor(0.0, 0.0, 0.0, 0.0);
+        gl.clear(gl.COLOR_BUFFER_BIT);
+        renderQuad(gl, scene, texture, mat4.multiply(mat4.create(), READBACK_FLIP, transformMatrix));
+        gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+        gl.viewport(0, 0, gl.drawingBufferWidth, gl.drawingBufferHeight);
+        gl.flush();
+
+        // WebGL 1 has no fences or pixel buffer objects. Waiting a frame lets the GPU
+        // finish the pass, so readPixels copies right away instead of blocking on it.
+        await new Promise(resolve => requestAnimationFrame(resolve));
+        const pixels = new Uint8Array(exportWidth * exportHeight * 4);
+        gl.bindFramebuffer(gl.FRAMEBUFFER, framebuffer);
+        gl.readPixels(0, 0, exportWidth, exportHeight, gl.RGBA, gl.UNSIGNED_BYTE, pixels);
+        return { data: new Uint8ClampedArray(pixels.buffer), width: exportWidth, height: exportHeight };
+      } finally {
+        gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+        gl.deleteFramebuffer(framebuffer);
+        gl.deleteTexture(target);
+      }
     },
   }));
 
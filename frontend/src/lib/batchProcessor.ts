@@ -0,0 +1,104 @@
+import type { EngineOp } from './engineProtocol';
+import { bitmapPixels, decodeImageFile, encodePNG } from './imageCodec';
+import { EngineImage, isAbortError, WasmWorkerPool } from './wasmWorkerPool';
+import { createZip } from './zip';
+
+// Batch processing: one operation applied to many image files.
+// A fixed window of files is in flight at a time. Each slot of the window decodes a
+// file, runs it on the pool and encodes the result as PNG before taking the next
+// file, so while one image is being decoded or encoded, the others keep the engine
+// workers busy. Memory is bounded by the window: at most `window` source and result
+// images are alive at once, however many files the batch has. Each image runs as a
+// single job; different images already spread across the workers, so they are not
+// tiled.
+
+export interface BatchItem {
+  file: File;
+  name: string; // Output file name, unique within the batch
+  blob?: Blob; // PNG result, unless the file failed
+  error?: string;
+  width?: number;
+  height?: number;
+  elapsedMs?: number; // Engine time
+}
+
+export interface BatchOptions {
+  window?: number; // Files in flight at once. Default: twice the pool size
+  signal?: AbortSignal; // Aborting stops the batch and rejects with an AbortError
+  onItem?: (item: BatchItem, completed: number, total: number) => void; // Called as each file finishes
+}
+
+// Output name for file: its stem with a .png extension, suffixed on collisions
+function outputNames(files: File[]): string[] {
+  const used = new Set<string>();
+  return files.map(file => {
+    const stem = file.name.replace(/\.[^./]*$/, '') || 'image';
+    let name = `${stem}.png`;
+    for (let i = 2; used.has(name); i++) {
+      name = `${stem}-${i}.png`;
+    }
+    used.add(name);
+    return name;
+  });
+}
+
+// Applies the operation built by buildOp to every file and resolves with one item per
+// file, in input order. A file that fails to decode or process yields an item with
+// error set and does not stop the batch.
+export async function runBatch(pool: WasmWorkerPool, files: File[], buildOp: (image: EngineImage) => EngineOp,
+  { window = 2 * pool.size, signal, onItem }: BatchOptions = {}): Promise<BatchItem[]> {
+  const names = outputNames(files);
+  const items: BatchItem[] = new Array(files.length);
+  let next = 0;
+  let completed = 0;
+
+  const processFile = async (index: number): Promise<BatchItem> => {
+    const item: BatchItem = { file: files[index], name: names[index] };
+    try {
+      const bitmap = await decodeImageFile(item.file);
+      let image: EngineImage;
+      try {
+        image = bitmapPixels(bitmap);
+      } finally {
+        bitmap.close();
+      }
+      const result = await pool.run(image, buildOp(image), { signal });
+      item.blob = await encodePNG(result);
+      item.width = result.width;
+      item.height = result.height;
+      item.elapsedMs = result.elapsedMs;
+    } catch (error) {
+      if (isAbortError(error)) {
+        throw error;
+      }
+      item.error = error instanceof Error ? error.message : String(error);
+    }
+    return item;
+  };
+
+  // Each slot of the window takes the next file once its current one is encoded
+  const slot = async () => {
+    while (next < files.length) {
+      signal?.throwIfAborted();
+      const index = next++;
+      items[index] = await processFile(index);
+      onItem?.(items[index], ++completed, files.length);
+    }
+  };
+  await Promise.all(Array.from({ length: Math.max(1, Math.min(window, files.length)) }, slot));
+  return items;
+}
+
+// Packs the successful results of a batch into a ZIP archive
+export const zipBatch = (items: BatchItem[]): Promise<Blob> =>
+  createZip(items.filter(item => item.blob).map(item => ({ name: item.name, data: item.blob! })));
+
+// Saves the successful results of a batch as baseName.zip
+export async function downloadBatch(items: BatchItem[], baseName: string) {
+  const url = URL.createObjectURL(await zipBatch(items));
+  const link = document.createElement('a');
+  link.download = `${baseName}.zip`;
+  link.href = url;
+  link.click();
+  setTimeout(() => URL.revokeObjectURL(url), 0);
+}
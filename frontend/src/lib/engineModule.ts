@@ -0,0 +1,44 @@
+// Compiled WebAssembly modules shared by every engine worker.
+// Compiling main.wasm (several MB) dominates the engine's startup, so it happens once
+// per page on the main thread with compileStreaming, which compiles while the bytes
+// download. Workers receive the Module by postMessage and only instantiate it. Browsers
+// also keep the machine code of streamed compiles next to the HTTP cache entry, so
+// repeat visits with an unchanged main.wasm skip compilation entirely.
+
+export interface EngineModules {
+  engine: WebAssembly.Module; // main.wasm
+  simd: WebAssembly.Module | null; // simd_kernels.wasm, null without SIMD support
+}
+
+// Smallest module using a SIMD128 instruction (i8x16.splat, i8x16.popcnt); engines
+// without SIMD support reject it
+const SIMD_PROBE = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11,
+]);
+
+export const simdSupported = () => WebAssembly.validate(SIMD_PROBE);
+
+// The SIMD kernels are optional: any failure leaves the engine on its scalar loops
+async function compileSIMDKernels(): Promise<WebAssembly.Module | null> {
+  if (!simdSupported()) {
+    return null;
+  }
+  try {
+    return await WebAssembly.compileStreaming(fetch('/simd_kernels.wasm'));
+  } catch (error) {
+    console.warn('SIMD kernels unavailable, using scalar loops:', error);
+    return null;
+  }
+}
+
+let modules: Promise<EngineModules> | null = null;
+
+// Compiles the engine modules on first use; later calls (e.g. a recreated pool) share them
+export function loadEngineModules(): Promise<EngineModules> {
+  modules ??= Promise.all([WebAssembly.compileStreaming(fetch('/main.wasm')), compileSIMDKernels()])
+    .then(([engine, simd]) => ({ engine, simd }));
+  modules.catch(() => {
+    modules = null; // Let a later pool retry
+  });
+  return modules;
+}
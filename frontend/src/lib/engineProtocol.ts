@@ -0,0 +1,150 @@
+import type { KernelSpec } from './kernels';
+
+// Message protocol between the main thread (WasmWorkerPool) and wasmEngine.worker.ts.
+// Pixel buffers are always transferred, never structured-cloned.
+
+// Quality or size target that chooses each channel's rank from its singular values:
+// energy: fraction of the channel's energy (sum of squares) to retain, in (0, 1];
+// psnr: minimum PSNR per channel in dB; bytes: size budget of the TSVD container
+export type SVDTarget = 'energy' | 'psnr' | 'bytes';
+
+// Options accepted by the WASM compressSVD exports
+export interface SVDOptions {
+  method?: 'full' | 'randomized'; // 'randomized' computes only the top-rank triplets
+  oversampling?: number; // Extra sample vectors for the randomized range finder
+  powerIterations?: number; // Subspace iterations for the randomized range finder
+  channels?: number[]; // Channel indices (0 = R .. 3 = A) to compress; others are copied. Default: all
+  blockSize?: number; // Factor blockSize x blockSize blocks (8-512) instead of whole channels; rank caps each block
+  energy?: number; // Block mode: fraction of each block's energy (sum of σ²) to retain, in (0, 1]. Default 0.99
+  colorSpace?: 'rgb' | 'ycbcr'; // 'ycbcr' factors luma at rank and 2x2-subsampled chroma at chromaRank
+  chromaRank?: number; // YCbCr mode: rank of the Cb/Cr planes. Default rank / 4
+  target?: SVDTarget; // Whole-channel RGB only: choose per-channel ranks, with rank as the cap
+  targetValue?: number; // Value of target
+}
+
+// Storage precision of the factors in a TSVD container
+export type SVDQuantization = 'int8' | 'float16';
+
+// Options accepted by the WASM encodeSVD exports (block mode is not supported)
+export interface SVDEncodeOptions extends SVDOptions {
+  quantization?: SVDQuantization; // Default 'int8' (per-vector scale)
+}
+
+// Per-channel point operations of a pipeline, applied to RGB (alpha is kept)
+export type PointOpType = 'brightness' | 'contrast' | 'gamma' | 'invert' | 'threshold';
+
+// One stage of an applyPipeline operation. Stages run in order inside the module;
+// consecutive point ops are fused into one lookup table applied to the previous
+// convolution's output, and runs of convolutions stream through the image in bands.
+export type PipelineStage =
+  | { op: 'filter'; filterType: string }
+  | { op: 'kernel'; kernel: KernelSpec }
+  | { op: 'point'; type: PointOpType; amount?: number } // brightness: offset, contrast: factor, gamma: exponent, threshold: level
+  | { op: 'svd'; rank: number; options?: SVDOptions };
+
+// One processing operation on an RGBA image. encodeSVD returns a TSVD container
+// instead of pixels and svdFactors the factor textures for GPU reconstruction (see
+// SVDFactorsInfo); decodeSVD needs no source image and feeds one chunk of a TSVD
+// stream to the worker's decoder, returning the current progressive rendering.
+// compressSVD with previewRanks first streams approximate reconstructions at those
+// ranks as 'partial' responses, unless the engine already caches the needed factors.
+export type EngineOp =
+  | { op: 'applyFilter'; filterType: string }
+  | { op: 'applyKernel'; kernel: KernelSpec }
+  | { op: 'applyPipeline'; stages: PipelineStage[] }
+  | { op: 'compressSVD'; rank: number; options?: SVDOptions; previewRanks?: number[] }
+  | { op: 'encodeSVD'; rank: number; options?: SVDEncodeOptions }
+  | { op: 'svdFactors'; rank: number; options?: SVDOptions }
+  | { op: 'decodeSVD'; streamId: number; chunk: ArrayBuffer; final: boolean };
+
+// Main thread -> worker
+export type EngineRequest = EngineOp & {
+  id: number;
+  imageKey: number; // Identifies the source image held in the worker's shared source buffer
+  width: number;
+  height: number;
+  pixels?: ArrayBuffer; // RGBA source, only sent when the worker does not hold imageKey yet
+  logging?: boolean; // Per-call console logging inside the engine (setEngineLogging)
+};
+
+// Main thread -> worker: stop the in-flight request id. The worker answers with
+// 'cancelled', or with the request's normal reply if it finished first. Without a
+// cancel flag the message is only seen between progressive preview steps.
+export type EngineCancel = { op: 'cancel'; id: number };
+
+// Main thread -> worker, once: a one-element Int32Array on a SharedArrayBuffer (only
+// available when the page is cross-origin isolated). Writing a request id into it
+// cancels that request from inside the engine's row and channel loops.
+export type EngineCancelFlag = { op: 'setCancelFlag'; flag: Int32Array };
+
+// Main thread -> worker, once: the compiled engine modules (see engineModule.ts). The
+// worker starts its Go instance from them and answers 'ready' or 'initError'.
+export type EngineInit = { op: 'init'; module: WebAssembly.Module; simdModule: WebAssembly.Module | null };
+
+export type EngineMessage = EngineRequest | EngineCancel | EngineCancelFlag | EngineInit;
+
+// Worker -> main thread
+export type EngineResponse =
+  | { type: 'ready' }
+  | { type: 'initError'; error: string }
+  | { type: 'result'; id: number; pixels: ArrayBuffer; width: number; height: number; elapsedMs: number; progress?: SVDDecodeProgress; factors?: SVDFactorsInfo; stats?: EngineStats }
+  | { type: 'partial'; id: number; pixels: ArrayBuffer; width: number; height: number; rank: number } // Progressive SVD preview
+  | { type: 'cancelled'; id: number }
+  | { type: 'error'; id: number; error: string };
+
+// Location of a Go-owned buffer inside the WASM module's linear memory
+export interface SharedBufferInfo {
+  ptr: number;
+  length: number;
+}
+
+export type SharedBufferResult = SharedBufferInfo | { error: string };
+
+// Timing and memory statistics of one engine call (getEngineStats). Phases marked
+// "(js)" are measured by the worker around the WASM call, the others inside Go.
+export interface EngineStats {
+  op: string;
+  totalMs: number;
+  phases: { name: string; ms: number }[];
+  bytesIn: number; // Bytes copied into WASM memory
+  bytesOut: number; // Bytes copied out of WASM memory
+  mallocs: number; // Go heap objects allocated during the call
+  allocBytes: number; // Go heap bytes allocated during the call
+  heapInUse: number; // Live Go heap after the call
+  heapSys: number; // Heap memory the module has obtained; WASM memory never shrinks
+  heapHighWater: number; // Largest live Go heap seen since the worker started
+  svd?: SVDRankReport; // Set by whole-channel compressSVD and encodeSVD calls
+}
+
+// Ranks chosen by a whole-channel SVD call, by fixed rank or by options.target
+export interface SVDRankReport {
+  target?: SVDTarget;
+  targetValue?: number;
+  met: boolean; // Whether the ranks reach the target (always true without one)
+  ranks: number[]; // Terms kept per channel (R, G, B, A); 0 for channels copied unchanged
+  energy: (number[] | null)[]; // Per channel: energy fraction retained after each factored term
+  psnr: number; // Estimated PSNR of the compressed channels in dB; Infinity when exact
+  bytes: number; // Size of a TSVD container with these ranks (compressSVD: int8)
+  termBytes: number; // Size of one rank-1 term in that container
+  compressionRatio: number; // RGBA bytes / bytes
+}
+
+// Rank reached by a progressive TSVD decode
+export interface SVDDecodeProgress {
+  rank: number; // Rank every channel has reached so far
+  totalRank: number; // Rank of the complete stream
+  done: boolean;
+}
+
+// Shape of an svdFactors result, whose pixels are the float32 factor textures of
+// backend/svd_textures.go: US (terms x height RGBA texels) followed by V (terms x width)
+export interface SVDFactorsInfo {
+  terms: number; // Triplets packed per channel, min(rank, width, height)
+  ranks: number[]; // Ranks chosen per channel as compressSVD would; 0 for channels taken from the source
+}
+
+// Result of the WASM svdFactorsShared export
+export type SVDFactorsResult = (SharedBufferInfo & SVDFactorsInfo) | { error: string };
+
+// Result of the WASM svdDecoderPush export
+export type SVDDecodeResult = (SharedBufferInfo & SVDDecodeProgress & { width: number; height: number }) | { error: string };
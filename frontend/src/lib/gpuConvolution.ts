@@ -0,0 +1,248 @@
+import type { KernelSpec } from './kernels';
+
+// GPU convolution for WebGLCanvas: each kernel becomes one or two render-to-texture
+// passes (separable kernels run as a horizontal then a vertical pass), and chains of
+// passes ping-pong between two intermediate textures. Borders replicate edge pixels
+// through CLAMP_TO_EDGE and alpha is copied, matching the WASM engine; the results
+// can still differ from it by rounding, so exports that must be exact use WASM.
+
+// Taps per pass; kernels with more fall back to WASM. Weights are packed into vec4
+// uniforms, so a pass needs GPU_MAX_TAPS / 4 fragment uniform vectors.
+export const GPU_MAX_TAPS = 128;
+const MAX_GROUPS = GPU_MAX_TAPS / 4;
+
+// One pass: a row-major width x height kernel anchored at its center tap
+export interface GpuPass {
+  weights: number[];
+  width: number;
+  height: number;
+}
+
+// Full-screen pass shared by the render-to-texture passes of WebGLCanvas
+export const passVertexShaderSource = `
+  attribute vec2 a_position;
+  varying vec2 v_texCoord;
+
+  void main() {
+    // Texture row 0 maps to framebuffer row 0, so passes keep the image orientation
+    v_texCoord = a_position * 0.5 + 0.5;
+    gl_Position = vec4(a_position, 0.0, 1.0);
+  }
+`;
+
+const fragmentShaderSource = `
+  #ifdef GL_FRAGMENT_PRECISION_HIGH
+  precision highp float;
+  #else
+  precision mediump float;
+  #endif
+
+  #define MAX_GROUPS ${MAX_GROUPS}
+
+  uniform sampler2D u_image;
+  uniform vec2 u_texelSize;
+  uniform vec4 u_weights[MAX_GROUPS];
+  uniform int u_taps;
+  uniform float u_kernelWidth;
+  uniform vec2 u_anchor;
+  varying vec2 v_texCoord;
+
+  vec3 tap(float t) {
+    float ty = floor((t + 0.5) / u_kernelWidth);
+    float tx = t - ty * u_kernelWidth;
+    return texture2D(u_image, v_texCoord + (vec2(tx, ty) - u_anchor) * u_texelSize).rgb;
+  }
+
+  void main() {
+    vec3 sum = vec3(0.0);
+    for (int g = 0; g < MAX_GROUPS; g++) {
+      if (g * 4 >= u_taps) break;
+      vec4 w = u_weights[g];
+      float t = float(g * 4);
+      sum += w.x * tap(t) + w.y * tap(t + 1.0) + w.z * tap(t + 2.0) + w.w * tap(t + 3.0);
+    }
+    gl_FragColor = vec4(sum, texture2D(u_image, v_texCoord).a);
+  }
+`;
+
+// Splits a kernel spec into GPU passes with the same normalization as the WASM
+// module, or returns null if a pass would exceed GPU_MAX_TAPS.
+export function kernelToPasses(kernel: KernelSpec): GpuPass[] | null {
+  if ('weights' in kernel) {
+    const width = kernel.width ?? Math.round(Math.sqrt(kernel.weights.length));
+    const height = kernel.height ?? Math.round(kernel.weights.length / Math.max(width, 1));
+    if (width * height !== kernel.weights.length || width % 2 === 0 || height % 2 === 0 || kernel.weights.length > GPU_MAX_TAPS) {
+      return null;
+    }
+    const sum = kernel.weights.reduce((a, b) => a + b, 0);
+    const scale = kernel.normalize && sum !== 0 ? 1 / sum : 1;
+    return [{ weights: kernel.weights.map(w => w * scale), width, height }];
+  }
+
+  const { row, column } = kernel;
+  if (row.length % 2 === 0 || column.length % 2 === 0 || Math.max(row.length, column.length) > GPU_MAX_TAPS) {
+    return null;
+  }
+  // Fold the whole normalization into the vertical factor, as the module does
+  const sum = row.reduce((a, b) => a + b, 0) * column.reduce((a, b) => a + b, 0);
+  const scale = kernel.normalize && sum !== 0 ? 1 / sum : 1;
+  return [
+    { weights: row, width: row.length, height: 1 },
+    { weights: column.map(w => w * scale), width: 1, height: column.length },
+  ];
+}
+
+// Shared with the other GPU passes of WebGLCanvas (see gpuSVD.ts)
+export function compile(gl: WebGLRenderingContext, type: number, source: string): WebGLShader {
+  const shader = gl.createShader(type)!;
+  gl.shaderSource(shader, source);
+  gl.compileShader(shader);
+  if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) {
+    const log = gl.getShaderInfoLog(shader);
+    gl.deleteShader(shader);
+    throw new Error(`GPU shader failed to compile: ${log}`);
+  }
+  return shader;
+}
+
+export function createTargetTexture(gl: WebGLRenderingContext, width: number, height: number, type: number, filter: number): WebGLTexture {
+  const texture = gl.createTexture()!;
+  gl.bindTexture(gl.TEXTURE_2D, texture);
+  gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, width, height, 0, gl.RGBA, type, null);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, filter);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, filter);
+  return texture;
+}
+
+export class GpuConvolver {
+  private gl: WebGLRenderingContext;
+  private program: WebGLProgram;
+  private quad: WebGLBuffer;
+  private framebuffer: WebGLFramebuffer;
+  private locations: {
+    position: number;
+    image: WebGLUniformLocation | null;
+    texelSize: WebGLUniformLocation | null;
+    weights: WebGLUniformLocation | null;
+    taps: WebGLUniformLocation | null;
+    kernelWidth: WebGLUniformLocation | null;
+    anchor: WebGLUniformLocation | null;
+  };
+  private intermediateType: number; // FLOAT when float render targets work, else UNSIGNED_BYTE
+  private intermediates: WebGLTexture[] = []; // Ping-pong pair between passes
+  private output: WebGLTexture | null = null; // 8-bit result of the last pass, sampled with LINEAR
+  private width = 0;
+  private height = 0;
+
+  // Throws if the context cannot run the convolution shader
+  constructor(gl: WebGLRenderingContext) {
+    if (gl.getParameter(gl.MAX_FRAGMENT_UNIFORM_VECTORS) < MAX_GROUPS + 8) {
+      throw new Error('Not enough fragment uniform vectors for GPU convolution');
+    }
+    this.gl = gl;
+    const program = gl.createProgram()!;
+    gl.attachShader(program, compile(gl, gl.VERTEX_SHADER, passVertexShaderSource));
+    gl.attachShader(program, compile(gl, gl.FRAGMENT_SHADER, fragmentShaderSource));
+    gl.linkProgram(program);
+    if (!gl.getProgramParameter(program, gl.LINK_STATUS)) {
+      throw new Error(`GPU convolution program failed to link: ${gl.getProgramInfoLog(program)}`);
+    }
+    this.program = program;
+    this.locations = {
+      position: gl.getAttribLocation(program, 'a_position'),
+      image: gl.getUniformLocation(program, 'u_image'),
+      texelSize: gl.getUniformLocation(program, 'u_texelSize'),
+      weights: gl.getUniformLocation(program, 'u_weights'),
+      taps: gl.getUniformLocation(program, 'u_taps'),
+      kernelWidth: gl.getUniformLocation(program, 'u_kernelWidth'),
+      anchor: gl.getUniformLocation(program, 'u_anchor'),
+    };
+
+    this.quad = gl.createBuffer()!;
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.quad);
+    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array([-1, -1, 1, -1, -1, 1, -1, 1, 1, -1, 1, 1]), gl.STATIC_DRAW);
+    this.framebuffer = gl.createFramebuffer()!;
+    this.intermediateType = gl.getExtension('OES_texture_float') ? gl.FLOAT : gl.UNSIGNED_BYTE;
+  }
+
+  // Allocates the render targets for a width x height image
+  private ensureTargets(width: number, height: number) {
+    const gl = this.gl;
+    if (this.width === width && this.height === height && this.output) {
+      return;
+    }
+    this.dispose();
+    this.width = width;
+    this.height = height;
+    this.output = createTargetTexture(gl, width, height, gl.UNSIGNED_BYTE, gl.LINEAR);
+    for (let i = 0; i < 2; i++) {
+      this.intermediates.push(createTargetTexture(gl, width, height, this.intermediateType, gl.NEAREST));
+    }
+
+    if (this.intermediateType === gl.FLOAT) {
+      // Float textures are not always renderable; fall back to 8-bit intermediates
+      gl.bindFramebuffer(gl.FRAMEBUFFER, this.framebuffer);
+      gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, this.intermediates[0], 0);
+      const complete = gl.checkFramebufferStatus(gl.FRAMEBUFFER) === gl.FRAMEBUFFER_COMPLETE;
+      gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+      if (!complete) {
+        this.intermediateType = gl.UNSIGNED_BYTE;
+        this.width = 0;
+        this.ensureTargets(width, height);
+      }
+    }
+  }
+
+  // Runs passes over source (a width x height texture) and returns the texture holding
+  // the result. The returned texture is owned by the convolver and reused by later runs.
+  run(source: WebGLTexture, width: number, height: number, passes: GpuPass[]): WebGLTexture {
+    const gl = this.gl;
+    this.ensureTargets(width, height);
+
+    gl.useProgram(this.program);
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.quad);
+    gl.enableVertexAttribArray(this.locations.position);
+    gl.vertexAttribPointer(this.locations.position, 2, gl.FLOAT, false, 0, 0);
+    gl.uniform2f(this.locations.texelSize, 1 / width, 1 / height);
+    gl.uniform1i(this.locations.image, 0);
+    gl.activeTexture(gl.TEXTURE0);
+    gl.bindFramebuffer(gl.FRAMEBUFFER, this.framebuffer);
+    gl.viewport(0, 0, width, height);
+
+    const packed = new Float32Array(GPU_MAX_TAPS);
+    let input = source;
+    passes.forEach((pass, i) => {
+      const target = i === passes.length - 1 ? this.output! : this.intermediates[i % 2];
+      gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, target, 0);
+
+      packed.fill(0);
+      packed.set(pass.weights);
+      gl.uniform4fv(this.locations.weights, packed);
+      gl.uniform1i(this.locations.taps, pass.weights.length);
+      gl.uniform1f(this.locations.kernelWidth, pass.width);
+      gl.uniform2f(this.locations.anchor, (pass.width - 1) / 2, (pass.height - 1) / 2);
+
+      gl.bindTexture(gl.TEXTURE_2D, input);
+      gl.drawArrays(gl.TRIANGLES, 0, 6);
+      input = target;
+    });
+
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    gl.viewport(0, 0, gl.drawingBufferWidth, gl.drawingBufferHeight);
+    gl.disableVertexAttribArray(this.locations.position);
+    return this.output!;
+  }
+
+  dispose() {
+    const gl = this.gl;
+    for (const texture of [...this.intermediates, this.output]) {
+      if (texture) {
+        gl.deleteTexture(texture);
+      }
+    }
+    this.intermediates = [];
+    this.output = null;
+  }
+}
@@ -0,0 +1,195 @@
+import { compile, createTargetTexture, passVertexShaderSource } from './gpuConvolution';
+
+// GPU SVD reconstruction for WebGLCanvas. The engine's svdFactors op packs the factors
+// of every channel into two RGBA float textures (see backend/svd_textures.go): US with
+// texel (i, y) = σ_i u_i[y] and V with texel (i, x) = v_i[x]. One pass evaluates
+// Σ_{i<rank} US(i, y) · V(i, x) per pixel and channel, so only (h + w) · terms floats
+// per channel are uploaded once, and a rank change is a uniform change and a redraw.
+// Channels with rank 0 are sampled from the source texture. Summing in float32 can
+// round differently from the engine, so exports that must be exact use WASM.
+
+// Terms the shader can sum; factors with more fall back to WASM. GLSL ES 1.0 loops need
+// a constant bound, so the loop runs to this limit and breaks at the highest rank.
+export const GPU_SVD_MAX_TERMS = 256;
+
+// Factor textures of a width x height image, as returned by the svdFactors op
+export interface SVDFactorTextures {
+  data: Float32Array; // US (terms x height RGBA texels) followed by V (terms x width)
+  width: number;
+  height: number;
+  terms: number;
+}
+
+const fragmentShaderSource = `
+  precision highp float;
+
+  #define MAX_TERMS ${GPU_SVD_MAX_TERMS}
+
+  uniform sampler2D u_source;
+  uniform sampler2D u_us;
+  uniform sampler2D u_v;
+  uniform float u_terms;
+  uniform vec4 u_ranks;
+  uniform int u_maxRank;
+  varying vec2 v_texCoord;
+
+  void main() {
+    // Fragment centers are texel centers: row y of US and row x of V
+    vec4 sum = vec4(0.0);
+    for (int i = 0; i < MAX_TERMS; i++) {
+      if (i >= u_maxRank) break;
+      float t = float(i);
+      float s = (t + 0.5) / u_terms;
+      sum += texture2D(u_us, vec2(s, v_texCoord.y)) * texture2D(u_v, vec2(s, v_texCoord.x)) * step(t + 0.5, u_ranks);
+    }
+    vec4 source = texture2D(u_source, v_texCoord);
+    gl_FragColor = mix(source, clamp(sum / 255.0, 0.0, 1.0), step(0.5, u_ranks));
+  }
+`;
+
+function createFactorTexture(gl: WebGLRenderingContext): WebGLTexture {
+  // NEAREST: float textures are not filterable without OES_texture_float_linear
+  return createTargetTexture(gl, 1, 1, gl.FLOAT, gl.NEAREST);
+}
+
+export class GpuSVDRenderer {
+  private gl: WebGLRenderingContext;
+  private program: WebGLProgram;
+  private quad: WebGLBuffer;
+  private framebuffer: WebGLFramebuffer;
+  private locations: {
+    position: number;
+    source: WebGLUniformLocation | null;
+    us: WebGLUniformLocation | null;
+    v: WebGLUniformLocation | null;
+    terms: WebGLUniformLocation | null;
+    ranks: WebGLUniformLocation | null;
+    maxRank: WebGLUniformLocation | null;
+  };
+  private us: WebGLTexture;
+  private v: WebGLTexture;
+  private output: WebGLTexture | null = null; // 8-bit reconstruction, sampled with LINEAR
+  private width = 0;
+  private height = 0;
+  private terms = 0; // 0 while no factors are loaded
+
+  // Throws if the context cannot sample float textures at full precision
+  constructor(gl: WebGLRenderingContext) {
+    if (!gl.getExtension('OES_texture_float')) {
+      throw new Error('Float textures (OES_texture_float) are not supported');
+    }
+    if (!gl.getShaderPrecisionFormat(gl.FRAGMENT_SHADER, gl.HIGH_FLOAT)?.precision) {
+      throw new Error('Fragment shaders lack highp float precision');
+    }
+    this.gl = gl;
+    const program = gl.createProgram()!;
+    gl.attachShader(program, compile(gl, gl.VERTEX_SHADER, passVertexShaderSource));
+    gl.attachShader(program, compile(gl, gl.FRAGMENT_SHADER, fragmentShaderSource));
+    gl.linkProgram(program);
+    if (!gl.getProgramParameter(program, gl.LINK_STATUS)) {
+      throw new Error(`GPU SVD program failed to link: ${gl.getProgramInfoLog(program)}`);
+    }
+    this.program = program;
+    this.locations = {
+      position: gl.getAttribLocation(program, 'a_position'),
+      source: gl.getUniformLocation(program, 'u_source'),
+      us: gl.getUniformLocation(program, 'u_us'),
+      v: gl.getUniformLocation(program, 'u_v'),
+      terms: gl.getUniformLocation(program, 'u_terms'),
+      ranks: gl.getUniformLocation(program, 'u_ranks'),
+      maxRank: gl.getUniformLocation(program, 'u_maxRank'),
+    };
+
+    this.quad = gl.createBuffer()!;
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.quad);
+    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array([-1, -1, 1, -1, -1, 1, -1, 1, 1, -1, 1, 1]), gl.STATIC_DRAW);
+    this.framebuffer = gl.createFramebuffer()!;
+    this.us = createFactorTexture(gl);
+    this.v = createFactorTexture(gl);
+  }
+
+  get hasFactors(): boolean {
+    return this.terms > 0;
+  }
+
+  // Uploads the factor textures; the output target is resized to the factored image.
+  // Returns false, loading nothing, when the textures exceed the shader or the context.
+  setFactors({ data, width, height, terms }: SVDFactorTextures): boolean {
+    const gl = this.gl;
+    const maxSize = gl.getParameter(gl.MAX_TEXTURE_SIZE) as number;
+    this.terms = 0;
+    if (terms < 1 || terms > GPU_SVD_MAX_TERMS || Math.max(width, height) > maxSize || data.length < (width + height) * terms * 4) {
+      return false;
+    }
+    const split = height * terms * 4;
+    gl.bindTexture(gl.TEXTURE_2D, this.us);
+    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, terms, height, 0, gl.RGBA, gl.FLOAT, data.subarray(0, split));
+    gl.bindTexture(gl.TEXTURE_2D, this.v);
+    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, terms, width, 0, gl.RGBA, gl.FLOAT, data.subarray(split, split + width * terms * 4));
+
+    if (!this.output || this.width !== width || this.height !== height) {
+      if (this.output) {
+        gl.deleteTexture(this.output);
+      }
+      this.output = createTargetTexture(gl, width, height, gl.UNSIGNED_BYTE, gl.LINEAR);
+      this.width = width;
+      this.height = height;
+    }
+    this.terms = terms;
+    return true;
+  }
+
+  // Forgets the loaded factors, e.g. when the source image changes
+  clearFactors() {
+    this.terms = 0;
+  }
+
+  // Reconstructs the loaded factors at ranks (R, G, B, A; each capped by terms) over
+  // source and returns the texture holding the result, owned by the renderer and
+  // reused by later renders. Channels with rank 0 are copied from source.
+  render(source: WebGLTexture, ranks: number[]): WebGLTexture {
+    const gl = this.gl;
+    if (!this.output || this.terms === 0) {
+      throw new Error('No SVD factors loaded');
+    }
+    const capped = [0, 1, 2, 3].map(c => Math.max(0, Math.min(ranks[c] ?? 0, this.terms)));
+
+    gl.useProgram(this.program);
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.quad);
+    gl.enableVertexAttribArray(this.locations.position);
+    gl.vertexAttribPointer(this.locations.position, 2, gl.FLOAT, false, 0, 0);
+    gl.uniform1f(this.locations.terms, this.terms);
+    gl.uniform4f(this.locations.ranks, capped[0], capped[1], capped[2], capped[3]);
+    gl.uniform1i(this.locations.maxRank, Math.max(...capped));
+    [source, this.us, this.v].forEach((texture, unit) => {
+      gl.activeTexture(gl.TEXTURE0 + unit);
+      gl.bindTexture(gl.TEXTURE_2D, texture);
+    });
+    gl.uniform1i(this.locations.source, 0);
+    gl.uniform1i(this.locations.us, 1);
+    gl.uniform1i(this.locations.v, 2);
+
+    gl.bindFramebuffer(gl.FRAMEBUFFER, this.framebuffer);
+    gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, this.output, 0);
+    gl.viewport(0, 0, this.width, this.height);
+    gl.drawArrays(gl.TRIANGLES, 0, 6);
+
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    gl.viewport(0, 0, gl.drawingBufferWidth, gl.drawingBufferHeight);
+    gl.disableVertexAttribArray(this.locations.position);
+    gl.activeTexture(gl.TEXTURE0); // drawScene binds its texture to unit 0
+    return this.output;
+  }
+
+  // Releases the textures; the renderer cannot be used afterwards
+  dispose() {
+    const gl = this.gl;
+    for (const texture of [this.us, this.v, this.output]) {
+      if (texture) {
+        gl.deleteTexture(texture);
+      }
+    }
+    this.output = null;
+    this.terms = 0;
+  }
+}
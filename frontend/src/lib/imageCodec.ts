@@ -0,0 +1,45 @@
+import type { EngineImage } from './wasmWorkerPool';
+
+// Conversions between encoded image files, decoded bitmaps and engine pixel buffers.
+// Decoding runs off the main thread inside createImageBitmap; the 2D canvases used to
+// move pixels in and out are offscreen and never touch the DOM.
+
+// Decodes file without premultiplying alpha, so the engine sees the file's pixel values
+export const decodeImageFile = (file: Blob): Promise<ImageBitmap> =>
+  createImageBitmap(file, { premultiplyAlpha: 'none' });
+
+// Reads the pixels of a decoded bitmap, for the engine
+export function bitmapPixels(bitmap: ImageBitmap): EngineImage {
+  const canvas = new OffscreenCanvas(bitmap.width, bitmap.height);
+  const ctx = canvas.getContext('2d');
+  if (!ctx) {
+    throw new Error("Could not get 2D context");
+  }
+  ctx.drawImage(bitmap, 0, 0);
+  const imageData = ctx.getImageData(0, 0, bitmap.width, bitmap.height);
+  return { data: imageData.data, width: imageData.width, height: imageData.height };
+}
+
+// File formats pixels can be exported as
+export type ImageFormat = 'image/png' | 'image/webp' | 'image/jpeg';
+
+export const IMAGE_FORMAT_EXTENSIONS: Record<ImageFormat, string> = {
+  'image/png': 'png',
+  'image/webp': 'webp',
+  'image/jpeg': 'jpg',
+};
+
+// Encodes engine pixels as an image file; quality (0-1) applies to WebP and JPEG.
+// Works on the main thread and in workers.
+export async function encodeImage(image: EngineImage, type: ImageFormat, quality?: number): Promise<Blob> {
+  const canvas = new OffscreenCanvas(image.width, image.height);
+  const ctx = canvas.getContext('2d');
+  if (!ctx) {
+    throw new Error("Could not get 2D context");
+  }
+  ctx.putImageData(new ImageData(image.data, image.width, image.height), 0, 0);
+  return canvas.convertToBlob({ type, quality });
+}
+
+// Encodes engine pixels as a PNG file
+export const encodePNG = (image: EngineImage): Promise<Blob> => encodeImage(image, 'image/png');
@@ -0,0 +1,93 @@
+import type { EngineImage } from './wasmWorkerPool';
+import { encodeImage, ImageFormat } from './imageCodec';
+
+// Image export without canvas.toDataURL: the pixels read back from WebGLCanvas are
+// transferred (not copied) to an encoder worker, which encodes them with
+// OffscreenCanvas.convertToBlob and answers with the Blob. The main thread never
+// holds a base64 string or a second copy of the pixels, and the UI keeps running
+// while large images encode. Where the worker cannot start, encoding falls back to
+// the same code on the main thread.
+
+// Main thread -> encoder worker
+export interface EncodeRequest {
+  id: number;
+  pixels: ArrayBuffer; // RGBA, transferred
+  width: number;
+  height: number;
+  type: ImageFormat;
+  quality?: number;
+}
+
+// Encoder worker -> main thread
+export type EncodeResponse = { id: number; blob: Blob } | { id: number; error: string };
+
+let encoder: Worker | null | undefined; // Started on first use; null once it proved unavailable
+const pending = new Map<number, { resolve: (blob: Blob) => void; reject: (error: Error) => void }>();
+let nextId = 1;
+
+function startEncoder(): Worker | null {
+  if (encoder !== undefined) {
+    return encoder;
+  }
+  try {
+    const worker = new Worker(new URL('../workers/imageEncoder.worker.ts', import.meta.url), { type: 'module' });
+    worker.onmessage = (event: MessageEvent<EncodeResponse>) => {
+      const message = event.data;
+      const job = pending.get(message.id);
+      pending.delete(message.id);
+      if ('blob' in message) {
+        job?.resolve(message.blob);
+      } else {
+        job?.reject(new Error(message.error));
+      }
+    };
+    worker.onerror = (event) => {
+      // The worker is gone; fail its jobs and encode on the main thread from now on
+      const error = new Error(`Encoder worker error: ${event.message}`);
+      pending.forEach(job => job.reject(error));
+      pending.clear();
+      worker.terminate();
+      encoder = null;
+    };
+    encoder = worker;
+  } catch (error) {
+    console.warn('Encoder worker unavailable, encoding on the main thread:', error);
+    encoder = null;
+  }
+  return encoder;
+}
+
+// Encodes image off the main thread; quality (0-1) applies to WebP and JPEG. The
+// pixel buffer is transferred to the worker, so image.data is detached afterwards.
+export function encodeImageOffThread(image: EngineImage, type: ImageFormat, quality?: number): Promise<Blob> {
+  const worker = startEncoder();
+  if (!worker) {
+    return encodeImage(image, type, quality);
+  }
+  const { data, width, height } = image;
+  // Only a view covering its whole buffer can be handed over as is
+  const pixels = data.byteOffset === 0 && data.byteLength === data.buffer.byteLength
+    ? data.buffer as ArrayBuffer
+    : data.slice().buffer;
+  return new Promise<Blob>((resolve, reject) => {
+    const id = nextId++;
+    pending.set(id, { resolve, reject });
+    const request: EncodeRequest = { id, pixels, width, height, type, quality };
+    worker.postMessage(request, [pixels]);
+  });
+}
+
+// Encodes image off the main thread and returns a Blob URL of the file. The caller
+// revokes it (downloadURL does) to release the Blob.
+export async function exportImageURL(image: EngineImage, type: ImageFormat, quality?: number): Promise<string> {
+  return URL.createObjectURL(await encodeImageOffThread(image, type, quality));
+}
+
+// Saves the file behind a Blob URL as fileName and revokes the URL
+export function downloadURL(url: string, fileName: string) {
+  const link = document.createElement('a');
+  link.download = fileName;
+  link.href = url;
+  link.click();
+  setTimeout(() => URL.revokeObjectURL(url), 0);
+}
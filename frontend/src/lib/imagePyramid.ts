@@ -0,0 +1,57 @@
+import type { EngineImage } from './wasmWorkerPool';
+
+// Multi-resolution copies of an uploaded image for interactive previews.
+// The canvas only shows about a container's worth of pixels, so interactive engine
+// runs use the smallest level that still covers the canvas: their cost follows the
+// display size instead of the source megapixels. Full-resolution runs happen only
+// when the exact result is needed (export or an explicit commit).
+
+// Levels stop halving once the longer edge would drop below this
+const MIN_LEVEL_EDGE = 256;
+
+// levels[0] is the source image; each further level halves both dimensions (rounding up)
+export interface ImagePyramid {
+  levels: EngineImage[];
+}
+
+export function buildPyramid(image: EngineImage): ImagePyramid {
+  const levels = [image];
+  let level = image;
+  while (Math.max(level.width, level.height) / 2 >= MIN_LEVEL_EDGE) {
+    level = halve(level);
+    levels.push(level);
+  }
+  return { levels };
+}
+
+// 2x2 box filter; a trailing odd row or column averages with itself
+function halve(image: EngineImage): EngineImage {
+  const { data, width, height } = image;
+  const w = Math.ceil(width / 2);
+  const h = Math.ceil(height / 2);
+  const out = new Uint8ClampedArray(w * h * 4);
+  for (let y = 0; y < h; y++) {
+    const row0 = 2 * y * width * 4;
+    const row1 = Math.min(2 * y + 1, height - 1) * width * 4;
+    for (let x = 0; x < w; x++) {
+      const col0 = 2 * x * 4;
+      const col1 = Math.min(2 * x + 1, width - 1) * 4;
+      const o = (y * w + x) * 4;
+      for (let c = 0; c < 4; c++) {
+        out[o + c] = (data[row0 + col0 + c] + data[row0 + col1 + c] + data[row1 + col0 + c] + data[row1 + col1 + c] + 2) >> 2;
+      }
+    }
+  }
+  return { data: out, width: w, height: h };
+}
+
+// Smallest level at least displayWidth x displayHeight pixels, or the source image
+export function levelForDisplay(pyramid: ImagePyramid, displayWidth: number, displayHeight: number): EngineImage {
+  const { levels } = pyramid;
+  for (let i = levels.length - 1; i > 0; i--) {
+    if (levels[i].width >= displayWidth && levels[i].height >= displayHeight) {
+      return levels[i];
+    }
+  }
+  return levels[0];
+}
@@ -0,0 +1,45 @@
+// Kernel specs accepted by the WASM applyKernel export.
+// Dense kernels are row-major and odd-sized; separable kernels pass their 1D factors.
+export type KernelSpec =
+  | { weights: number[]; width?: number; height?: number; normalize?: boolean; method?: ConvMethod }
+  | { row: number[]; column: number[]; normalize?: boolean; method?: ConvMethod };
+
+// 'auto' lets the module choose between direct, separable, summed-area table and FFT convolution
+export type ConvMethod = 'auto' | 'direct' | 'separable' | 'sat' | 'fft';
+
+// Builds a normalized separable Gaussian with the given radius (sigma = radius / 3).
+export function makeGaussianKernel(radius: number): KernelSpec {
+  const r = Math.max(1, Math.round(radius));
+  const sigma = r / 3;
+  const taps: number[] = [];
+  let sum = 0;
+  for (let i = -r; i <= r; i++) {
+    const w = Math.exp(-(i * i) / (2 * sigma * sigma));
+    taps.push(w);
+    sum += w;
+  }
+  const row = taps.map(w => w / sum);
+  return { row, column: [...row] };
+}
+
+// Parses a kernel typed as whitespace/comma separated rows, e.g. "0 -1 0\n-1 5 -1\n0 -1 0".
+// Throws if the rows are ragged; size validation (odd dimensions) happens in the WASM module.
+export function parseKernelText(text: string): KernelSpec {
+  const rows = text
+    .trim()
+    .split(/\n+/)
+    .map(line => line.trim().split(/[\s,]+/).filter(Boolean).map(Number));
+  const width = rows[0]?.length ?? 0;
+  if (width === 0 || rows.some(row => row.length !== width || row.some(Number.isNaN))) {
+    throw new Error('Kernel rows must all contain the same number of numeric values');
+  }
+  return { weights: rows.flat(), width, height: rows.length };
+}
+
+// Kernels of the WASM module's built-in filters (backend/convolve.go), for the GPU path
+export const BUILTIN_FILTER_KERNELS: Record<string, KernelSpec> = {
+  blur: { row: [1, 1, 1], column: [1, 1, 1], normalize: true },
+  sharpen: { weights: [0, -1, 0, -1, 5, -1, 0, -1, 0], width: 3, height: 3 },
+  edge: { weights: [-1, -1, -1, -1, 8, -1, -1, -1, -1], width: 3, height: 3 },
+  emboss: { weights: [-2, -1, 0, -1, 1, 1, 0, 1, 2], width: 3, height: 3 },
+};
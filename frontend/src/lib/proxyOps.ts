@@ -0,0 +1,141 @@
+import type { EngineOp, PipelineStage, SVDOptions } from './engineProtocol';
+import type { KernelSpec } from './kernels';
+import { BUILTIN_FILTER_KERNELS } from './kernels';
+
+// Operations adapted to a pyramid level. Operations are specified in source pixels: a
+// Gaussian radius, a kernel's taps and an SVD rank mean something else on an image a
+// quarter the size, so a proxy preview that ran them unchanged would not match Apply
+// or the export. proxyOp rescales what scales and refuses what does not, and the
+// caller then runs the operation on the source image instead:
+//   - point operations are per-pixel and run unchanged
+//   - smoothing kernels (no negative weights) are resampled to the level's pixel size
+//   - sharpening and edge kernels (and filters built from them) are defined at the
+//     pixel scale and have no proxy equivalent
+//   - whole-channel SVD keeps rank / min(width, height); byte targets scale with the area
+//   - block SVD has a fixed block size in pixels and has no proxy equivalent
+
+interface Size {
+  width: number;
+  height: number;
+}
+
+// Spreads each tap at position i onto the level's grid at i * scale, linearly between
+// the two nearest level taps. The sum of the weights and the symmetry are kept.
+function resampleTaps(taps: number[], scale: number): number[] {
+  const radius = (taps.length - 1) / 2;
+  const levelRadius = Math.ceil(radius * scale);
+  const out = new Array<number>(2 * levelRadius + 1).fill(0);
+  taps.forEach((w, i) => {
+    const p = (i - radius) * scale + levelRadius;
+    const j = Math.floor(p);
+    const f = p - j;
+    out[j] += w * (1 - f);
+    if (f > 0) {
+      out[j + 1] += w * f;
+    }
+  });
+  return out;
+}
+
+// kernel resampled to a level scale times the source size, or null for kernels with
+// negative weights
+export function proxyKernel(kernel: KernelSpec, scale: number): KernelSpec | null {
+  if ('row' in kernel) {
+    if ([...kernel.row, ...kernel.column].some(w => w < 0)) {
+      return null;
+    }
+    return { ...kernel, row: resampleTaps(kernel.row, scale), column: resampleTaps(kernel.column, scale) };
+  }
+  const width = kernel.width ?? Math.round(Math.sqrt(kernel.weights.length));
+  const height = kernel.height ?? width;
+  if (kernel.weights.some(w => w < 0) || width * height !== kernel.weights.length) {
+    return null;
+  }
+  // Resample the rows, then the columns of the result
+  const rows = Array.from({ length: height }, (_, y) => resampleTaps(kernel.weights.slice(y * width, (y + 1) * width), scale));
+  const levelWidth = rows[0].length;
+  const columns = Array.from({ length: levelWidth }, (_, x) => resampleTaps(rows.map(row => row[x]), scale));
+  const levelHeight = columns[0].length;
+  const weights: number[] = [];
+  for (let y = 0; y < levelHeight; y++) {
+    for (let x = 0; x < levelWidth; x++) {
+      weights.push(columns[x][y]);
+    }
+  }
+  return { ...kernel, weights, width: levelWidth, height: levelHeight };
+}
+
+// SVD rank and options for level, or null in block mode; scaleRank maps further ranks.
+// A rank that compresses the source stays below the level's full rank, so the preview
+// is never exact where the result is not.
+export function proxySVD(rank: number, options: SVDOptions = {}, source: Size, level: Size) {
+  if (options?.blockSize) {
+    return null;
+  }
+  const scale = level.width / source.width;
+  const sourceFull = Math.min(source.width, source.height);
+  const levelFull = Math.min(level.width, level.height);
+  const scaleRank = (r: number) => Math.max(1, Math.min(Math.round(r * scale), r < sourceFull ? levelFull - 1 : levelFull));
+  const levelOptions: SVDOptions = {
+    ...options,
+    chromaRank: options.chromaRank && scaleRank(options.chromaRank),
+    // Every term spans a row and a column, so the terms a budget buys shrink with both
+    targetValue: options.target === 'bytes' && options.targetValue !== undefined
+      ? Math.round(options.targetValue * scale * scale)
+      : options.targetValue,
+  };
+  return { rank: scaleRank(rank), options: levelOptions, scaleRank };
+}
+
+function proxyStage(stage: PipelineStage, source: Size, level: Size): PipelineStage | null {
+  const scale = level.width / source.width;
+  switch (stage.op) {
+    case 'point':
+      return stage;
+    case 'filter': {
+      const kernel = BUILTIN_FILTER_KERNELS[stage.filterType];
+      const levelKernel = kernel && proxyKernel(kernel, scale);
+      return levelKernel ? { op: 'kernel', kernel: levelKernel } : null;
+    }
+    case 'kernel': {
+      const kernel = proxyKernel(stage.kernel, scale);
+      return kernel && { op: 'kernel', kernel };
+    }
+    case 'svd': {
+      const svd = proxySVD(stage.rank, stage.options, source, level);
+      return svd && { op: 'svd', rank: svd.rank, options: svd.options };
+    }
+  }
+}
+
+// op as run on level, a downscaled copy of source, or null when op has no equivalent there
+export function proxyOp(op: EngineOp, source: Size, level: Size): EngineOp | null {
+  const scale = level.width / source.width;
+  if (scale >= 1) {
+    return op;
+  }
+  switch (op.op) {
+    case 'applyFilter': {
+      const stage = proxyStage({ op: 'filter', filterType: op.filterType }, source, level);
+      return stage && stage.op === 'kernel' ? { op: 'applyKernel', kernel: stage.kernel } : null;
+    }
+    case 'applyKernel': {
+      const kernel = proxyKernel(op.kernel, scale);
+      return kernel && { op: 'applyKernel', kernel };
+    }
+    case 'applyPipeline': {
+      const stages = op.stages.map(stage => proxyStage(stage, source, level));
+      return stages.every(stage => stage !== null) ? { op: 'applyPipeline', stages: stages as PipelineStage[] } : null;
+    }
+    case 'compressSVD': {
+      const svd = proxySVD(op.rank, op.options, source, level);
+      if (!svd) {
+        return null;
+      }
+      const previewRanks = op.previewRanks && [...new Set(op.previewRanks.map(svd.scaleRank))].filter(r => r < svd.rank);
+      return { op: 'compressSVD', rank: svd.rank, options: svd.options, previewRanks: previewRanks?.length ? previewRanks : undefined };
+    }
+    default:
+      return null;
+  }
+}
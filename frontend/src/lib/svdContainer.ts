@@ -0,0 +1,108 @@
+import type { EngineInit, EngineRequest, EngineResponse, SVDDecodeProgress } from './engineProtocol';
+import { loadEngineModules } from './engineModule';
+
+// Progressive decoding of TSVD containers (see backend/svd_format.go).
+// Terms are stored rank-major, so every received prefix renders as a complete
+// lower-rank image; callers see a sharper frame each time more bytes arrive.
+
+export const TSVD_EXTENSION = '.tsvd';
+
+export interface DecodedFrame extends SVDDecodeProgress {
+  data: Uint8ClampedArray;
+  width: number;
+  height: number;
+}
+
+// Chunks are batched up to this size before each render, so a fast local stream does
+// not pay for one full-image render per small read.
+const MIN_PUSH_BYTES = 256 * 1024;
+
+export const isTSVDFile = (file: File) => file.name.toLowerCase().endsWith(TSVD_EXTENSION);
+
+// Decodes a TSVD byte stream in a dedicated engine worker, calling onFrame with every
+// intermediate rendering, and resolves with the final frame.
+export async function decodeSVDStream(stream: ReadableStream<Uint8Array>, onFrame: (frame: DecodedFrame) => void): Promise<DecodedFrame> {
+  const worker = new Worker(new URL('../workers/wasmEngine.worker.ts', import.meta.url), { type: 'classic' });
+  let pending: { resolve: (frame: DecodedFrame) => void; reject: (error: Error) => void } | null = null;
+  const ready = new Promise<void>((resolve, reject) => {
+    worker.onmessage = (event: MessageEvent<EngineResponse>) => {
+      const message = event.data;
+      switch (message.type) {
+        case 'ready':
+          resolve();
+          return;
+        case 'initError':
+          reject(new Error(message.error));
+          return;
+        case 'result':
+          pending?.resolve({ data: new Uint8ClampedArray(message.pixels), width: message.width, height: message.height, ...message.progress! });
+          return;
+        case 'error':
+          pending?.reject(new Error(message.error));
+          return;
+      }
+    };
+    worker.onerror = (event) => {
+      const error = new Error(`Worker error: ${event.message}`);
+      reject(error);
+      pending?.reject(error);
+    };
+    loadEngineModules().then(({ engine, simd }) => {
+      const init: EngineInit = { op: 'init', module: engine, simdModule: simd };
+      worker.postMessage(init);
+    }, reject);
+  });
+
+  let nextId = 1;
+  const push = (chunk: Uint8Array, final: boolean) => new Promise<DecodedFrame>((resolve, reject) => {
+    pending = { resolve, reject };
+    const buffer = chunk.slice().buffer;
+    const request: EngineRequest = { op: 'decodeSVD', streamId: 1, chunk: buffer, final, id: nextId++, imageKey: 0, width: 0, height: 0 };
+    worker.postMessage(request, [buffer]);
+  });
+
+  try {
+    await ready;
+    const reader = stream.getReader();
+    let batch: Uint8Array[] = [];
+    let batchBytes = 0;
+    const flush = async (final: boolean) => {
+      const chunk = new Uint8Array(batchBytes);
+      let offset = 0;
+      for (const part of batch) {
+        chunk.set(part, offset);
+        offset += part.length;
+      }
+      batch = [];
+      batchBytes = 0;
+      return push(chunk, final);
+    };
+
+    for (;;) {
+      const { done, value } = await reader.read();
+      if (done) {
+        return await flush(true);
+      }
+      batch.push(value);
+      batchBytes += value.length;
+      if (batchBytes >= MIN_PUSH_BYTES) {
+        const frame = await flush(false);
+        if (frame.width > 0) {
+          onFrame(frame);
+        }
+      }
+    }
+  } finally {
+    worker.terminate();
+  }
+}
+
+// Saves a TSVD container under the given base name
+export function downloadTSVD(container: Uint8Array, baseName: string) {
+  const url = URL.createObjectURL(new Blob([container], { type: 'application/octet-stream' }));
+  const link = document.createElement('a');
+  link.download = `${baseName}${TSVD_EXTENSION}`;
+  link.href = url;
+  link.click();
+  setTimeout(() => URL.revokeObjectURL(url), 0);
+}
@@ -0,0 +1,79 @@
+// Streaming textures for WebGLCanvas. Engine results replace the displayed pixels many
+// times per second (live SVD ranks, progressive previews and decodes), nearly always at
+// the same size, so an upload must neither reallocate GPU storage nor wait for the GPU
+// to finish sampling the frame on screen. A StreamingTexture keeps its storage and
+// overwrites it with texSubImage2D; texImage2D only runs when the size changes. With
+// two buffers, an upload writes the texture that is not displayed and then swaps them,
+// so the draw of the previous frame never stalls it. WebGL 1 has no pixel buffer
+// objects; alternating textures gives drivers the same freedom to pipeline the copy.
+
+// Pixels a texture can be filled from: raw RGBA bytes or a decoded image
+export type TexturePixels = Uint8ClampedArray | ImageBitmap | ImageData;
+
+export class StreamingTexture {
+  private gl: WebGLRenderingContext;
+  private textures: WebGLTexture[];
+  private sizes: { width: number; height: number }[];
+  private front = 0; // Index of the texture returned by `texture`
+
+  // buffers: 2 for textures updated while displayed, 1 for rarely changed inputs
+  constructor(gl: WebGLRenderingContext, buffers: 1 | 2 = 2) {
+    this.gl = gl;
+    this.textures = [];
+    this.sizes = [];
+    for (let i = 0; i < buffers; i++) {
+      const texture = gl.createTexture()!;
+      gl.bindTexture(gl.TEXTURE_2D, texture);
+      gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+      gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+      gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.LINEAR);
+      gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
+      this.textures.push(texture);
+      this.sizes.push({ width: 0, height: 0 });
+    }
+  }
+
+  // The texture holding the latest upload
+  get texture(): WebGLTexture {
+    return this.textures[this.front];
+  }
+
+  get width(): number {
+    return this.sizes[this.front].width;
+  }
+
+  get height(): number {
+    return this.sizes[this.front].height;
+  }
+
+  // Makes pixels (width x height) the content of `texture`
+  upload(pixels: TexturePixels, width: number, height: number) {
+    const gl = this.gl;
+    const target = (this.front + 1) % this.textures.length;
+    const size = this.sizes[target];
+    gl.bindTexture(gl.TEXTURE_2D, this.textures[target]);
+    if (size.width === width && size.height === height) {
+      if (pixels instanceof Uint8ClampedArray) {
+        gl.texSubImage2D(gl.TEXTURE_2D, 0, 0, 0, width, height, gl.RGBA, gl.UNSIGNED_BYTE, pixels);
+      } else {
+        gl.texSubImage2D(gl.TEXTURE_2D, 0, 0, 0, gl.RGBA, gl.UNSIGNED_BYTE, pixels);
+      }
+    } else {
+      if (pixels instanceof Uint8ClampedArray) {
+        gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, width, height, 0, gl.RGBA, gl.UNSIGNED_BYTE, pixels);
+      } else {
+        gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, gl.RGBA, gl.UNSIGNED_BYTE, pixels);
+      }
+      size.width = width;
+      size.height = height;
+    }
+    this.front = target;
+  }
+
+  dispose() {
+    for (const texture of this.textures) {
+      this.gl.deleteTexture(texture);
+    }
+    this.textures = [];
+  }
+}
@@ -0,0 +1,229 @@
+import type { EngineOp, SVDRankReport } from './engineProtocol';
+import type { KernelSpec } from './kernels';
+import type { EngineImage, EnginePartial, EngineResult, RunOptions, WasmWorkerPool } from './wasmWorkerPool';
+
+// Splits one operation across the workers of a pool and stitches the partial results.
+// Convolutions run on full-width horizontal bands padded with halo rows taken from the
+// real image, so every kept output row sees exactly the neighbourhood it would see in a
+// single-instance run and the stitched image matches the untiled one (FFT tiles are
+// anchored per band, so that path may differ by float rounding in rare pixels).
+// Whole-channel SVD is not separable over pixels, so it is split by channel instead;
+// block-wise SVD is split into bands aligned to the block grid, which needs no halo.
+// Pipelines without SVD stages are banded with the sum of their stages' halos.
+// Progressive SVD previews of channel jobs are stitched once every channel has
+// reported the same preview rank. A byte budget (options.target 'bytes') is shared by
+// all channels, so such jobs are not split.
+
+// Cancellation and progressive output of a tiled run; every tile job shares the signal
+export type TiledRunOptions = Pick<RunOptions, 'signal' | 'onPartial'>;
+
+// Images below this many pixels run as a single job; scheduling overhead would dominate
+const MIN_TILED_PIXELS = 512 * 512;
+// Bands narrower than this spend most of their time on halo rows
+const MIN_BAND_ROWS = 64;
+// Header and channel table of a TSVD container (backend/svd_format.go)
+const TSVD_HEADER_BYTES = 32;
+
+// A band of output rows [start, end) and the padded input rows [padStart, padEnd) it reads
+interface Band {
+  start: number;
+  end: number;
+  padStart: number;
+  padEnd: number;
+}
+
+// Band sub-images are cached per source image so repeated operations reuse the same
+// buffers and the pool's affinity dispatch keeps each band on the worker that holds it.
+const bandCache = new WeakMap<Uint8ClampedArray, Map<string, EngineImage>>();
+
+// Rows of context a convolution needs above and below each output row
+export function haloForOp(op: EngineOp): number {
+  switch (op.op) {
+    case 'applyFilter':
+      return 1; // Built-in filters are 3x3
+    case 'applyKernel':
+      return kernelRadiusY(op.kernel);
+    case 'applyPipeline':
+      // Every stage widens the neighbourhood of the final rows by its own radius
+      return op.stages.reduce((halo, stage) =>
+        halo + (stage.op === 'filter' ? 1 : stage.op === 'kernel' ? kernelRadiusY(stage.kernel) : 0), 0);
+    case 'compressSVD':
+    case 'encodeSVD':
+    case 'svdFactors':
+    case 'decodeSVD':
+      return 0;
+  }
+}
+
+function kernelRadiusY(kernel: KernelSpec): number {
+  if ('weights' in kernel) {
+    const width = kernel.width ?? Math.round(Math.sqrt(kernel.weights.length));
+    const height = kernel.height ?? Math.round(kernel.weights.length / Math.max(width, 1));
+    return Math.floor(height / 2);
+  }
+  return Math.floor(kernel.column.length / 2);
+}
+
+// align rounds band heights up to a multiple (the SVD block size) so bands never split a block
+function planBands(height: number, halo: number, count: number, align = 1): Band[] {
+  let rows = Math.max(MIN_BAND_ROWS, 4 * halo, Math.ceil(height / count));
+  rows = Math.ceil(rows / align) * align;
+  const bands: Band[] = [];
+  for (let start = 0; start < height; start += rows) {
+    const end = Math.min(start + rows, height);
+    bands.push({ start, end, padStart: Math.max(0, start - halo), padEnd: Math.min(height, end + halo) });
+  }
+  return bands;
+}
+
+function bandImage(image: EngineImage, band: Band): EngineImage {
+  let bands = bandCache.get(image.data);
+  if (!bands) {
+    bands = new Map();
+    bandCache.set(image.data, bands);
+  }
+  const key = `${band.padStart}:${band.padEnd}`;
+  let sub = bands.get(key);
+  if (!sub) {
+    const rowBytes = image.width * 4;
+    sub = {
+      data: image.data.subarray(band.padStart * rowBytes, band.padEnd * rowBytes),
+      width: image.width,
+      height: band.padEnd - band.padStart,
+    };
+    bands.set(key, sub);
+  }
+  return sub;
+}
+
+// Runs op on image, tiled across the pool when the image is large enough.
+// elapsedMs and stats of the result are those of the slowest tile.
+export async function runTiled(pool: WasmWorkerPool, image: EngineImage, op: EngineOp, options: TiledRunOptions = {}): Promise<EngineResult> {
+  if (pool.size < 2 || image.width * image.height < MIN_TILED_PIXELS || op.op === 'encodeSVD' || op.op === 'svdFactors' || op.op === 'decodeSVD') {
+    return pool.run(image, op, options);
+  }
+  if (op.op === 'applyPipeline' && op.stages.some(stage => stage.op === 'svd')) {
+    return pool.run(image, op, options); // SVD stages need the whole image
+  }
+  if (op.op === 'compressSVD' && op.options?.colorSpace === 'ycbcr') {
+    return pool.run(image, op, options); // Luma/chroma conversion mixes channels, so it cannot be split by channel
+  }
+  if (op.op === 'compressSVD' && op.options?.target === 'bytes') {
+    return pool.run(image, op, options); // The budget is spread over all channels at once
+  }
+  if (op.op === 'compressSVD' && !op.options?.blockSize) {
+    return runSVDByChannel(pool, image, op, options);
+  }
+  return runBands(pool, image, op, options);
+}
+
+// Combines tile results: elapsedMs and stats are those of the slowest tile
+function slowestOf(results: EngineResult[], data: Uint8ClampedArray, image: EngineImage): EngineResult {
+  const slowest = results.reduce((a, b) => (b.elapsedMs > a.elapsedMs ? b : a));
+  return { data, width: image.width, height: image.height, elapsedMs: slowest.elapsedMs, stats: slowest.stats };
+}
+
+async function runBands(pool: WasmWorkerPool, image: EngineImage, op: EngineOp, options: TiledRunOptions): Promise<EngineResult> {
+  const align = op.op === 'compressSVD' ? op.options?.blockSize ?? 1 : 1;
+  const bands = planBands(image.height, haloForOp(op), pool.size, align);
+  if (bands.length < 2) {
+    return pool.run(image, op, options);
+  }
+
+  // Banded operations produce no partial results
+  const results = await Promise.all(bands.map(band => pool.run(bandImage(image, band), op, { signal: options.signal })));
+
+  // Stitch: keep only each band's own rows, dropping the halo
+  const rowBytes = image.width * 4;
+  const data = new Uint8ClampedArray(image.data.length);
+  bands.forEach((band, i) => {
+    const offset = (band.start - band.padStart) * rowBytes;
+    data.set(results[i].data.subarray(offset, offset + (band.end - band.start) * rowBytes), band.start * rowBytes);
+  });
+  return slowestOf(results, data, image);
+}
+
+async function runSVDByChannel(pool: WasmWorkerPool, image: EngineImage, op: Extract<EngineOp, { op: 'compressSVD' }>, options: TiledRunOptions): Promise<EngineResult> {
+  const channels = op.options?.channels ?? [0, 1, 2, 3];
+  if (channels.length < 2) {
+    return pool.run(image, op, options);
+  }
+
+  // Preview frames being assembled, by rank. A rank is shown once all channels reported
+  // it, and never after a higher one; ranks some channel skipped (cached factors) are
+  // never shown.
+  const previews = new Map<number, { data: Uint8ClampedArray; count: number }>();
+  let shownRank = 0;
+  const onChannelPartial = (c: number) => (partial: EnginePartial) => {
+    let preview = previews.get(partial.rank);
+    if (!preview) {
+      preview = { data: image.data.slice(), count: 0 };
+      previews.set(partial.rank, preview);
+    }
+    copyChannel(preview.data, partial.data, c);
+    if (++preview.count === channels.length) {
+      previews.delete(partial.rank);
+      if (partial.rank > shownRank) {
+        shownRank = partial.rank;
+        options.onPartial?.({ data: preview.data, width: image.width, height: image.height, rank: partial.rank });
+      }
+    }
+  };
+
+  // One job per channel; each worker copies the channels it does not compress. The
+  // affinity tag keeps a channel on the worker that already cached its SVD factors.
+  const results = await Promise.all(channels.map(c =>
+    pool.run(image, { ...op, options: { ...op.options, channels: [c] } }, {
+      affinity: `svd-channel-${c}`,
+      signal: options.signal,
+      onPartial: options.onPartial && onChannelPartial(c),
+    })));
+
+  const data = image.data.slice();
+  channels.forEach((c, i) => copyChannel(data, results[i].data, c));
+  const result = slowestOf(results, data, image);
+  const svd = mergeSVDReports(channels, results.map(r => r.stats?.svd));
+  return svd && result.stats ? { ...result, stats: { ...result.stats, svd } } : result;
+}
+
+// Combines the rank reports of single-channel jobs into the report of one whole-image
+// run: per-channel ranks and curves, the PSNR of the mean squared error, and the size
+// of one container holding every channel's terms
+function mergeSVDReports(channels: number[], reports: (SVDRankReport | undefined)[]): SVDRankReport | undefined {
+  if (reports.some(report => !report)) {
+    return undefined;
+  }
+  const first = reports[0]!;
+  const merged: SVDRankReport = { ...first, ranks: [0, 0, 0, 0], energy: [null, null, null, null] };
+  let mse = 0;
+  let factored = 0;
+  let terms = 0;
+  channels.forEach((c, i) => {
+    const report = reports[i]!;
+    merged.ranks[c] = report.ranks[c];
+    merged.energy[c] = report.energy[c];
+    terms += report.ranks[c];
+    if (report.ranks[c] > 0) {
+      mse += 255 * 255 / 10 ** (report.psnr / 10); // 0 for exact channels (Infinity dB)
+      factored++;
+    }
+  });
+  // A job's container also stores every other non-constant channel raw (one plane each);
+  // the whole image's container stores raw only the non-constant channels no job factored
+  const rgbaBytes = first.compressionRatio * first.bytes;
+  const plane = rgbaBytes / 4;
+  const firstRaw = Math.round((first.bytes - TSVD_HEADER_BYTES - first.termBytes * first.ranks.reduce((sum, r) => sum + r, 0)) / plane);
+  const nonConstant = firstRaw + (first.ranks[channels[0]] > 0 ? 1 : 0);
+  merged.psnr = factored > 0 && mse > 0 ? 10 * Math.log10(255 * 255 * factored / mse) : Infinity;
+  merged.bytes = TSVD_HEADER_BYTES + merged.termBytes * terms + (nonConstant - factored) * plane;
+  merged.compressionRatio = rgbaBytes / merged.bytes;
+  merged.met = reports.every(report => report!.met);
+  return merged;
+}
+
+// Copies channel c of the RGBA image src into dst
+function copyChannel(dst: Uint8ClampedArray, src: Uint8ClampedArray, c: number) {
+  for (let p = c; p < dst.length; p += 4) {
+    dst[p] = src[p];
+  }
+}
@@ -0,0 +1,123 @@
+import { mat4, vec3, glMatrix } from 'gl-matrix';
+
+// Composes the canvas transform from the transform sliders. A slider tick used to allocate
+// five matrices and set six pieces of React state, so every tick rendered the whole app
+// twice and redrew the matrix panels. The controller instead writes into matrices it
+// allocated once: `matrix` is handed to WebGLCanvas, which reads it into its u_matrix
+// uniform on the next animation frame. The matrix panels and the transformed area are
+// React state fed from throttled snapshots, at most every DISPLAY_INTERVAL_MS.
+
+const DISPLAY_INTERVAL_MS = 100;
+
+export interface TransformParams {
+  rotation: number; // Degrees, clockwise on screen
+  scaleX: number;
+  scaleY: number;
+  shearX: number;
+  shearY: number;
+  translationX: number; // Pixels
+  translationY: number;
+  flipHorizontal: boolean;
+  flipVertical: boolean;
+  viewportWidth: number; // Canvas size that turns pixel translations into clip space
+  viewportHeight: number;
+}
+
+// Copies of the matrices for display; a new object each time, so React re-renders
+export interface TransformSnapshot {
+  overall: mat4;
+  translation: mat4;
+  rotation: mat4;
+  scale: mat4;
+  shear: mat4;
+  area: number; // 4 × |det(overall)|: the clip-space area of the transformed -1..1 quad
+}
+
+export class TransformController {
+  // Overall transform, updated in place; its identity never changes
+  readonly matrix = mat4.create();
+  private translation = mat4.create();
+  private rotation = mat4.create();
+  private scale = mat4.create();
+  private shear = mat4.create();
+  private scratch = vec3.create();
+  private listener: ((snapshot: TransformSnapshot) => void) | null = null;
+  private lastDisplay = 0;
+  private displayTimer: ReturnType<typeof setTimeout> | null = null;
+
+  // Recomputes matrix from params and schedules a display snapshot
+  update(params: TransformParams) {
+    const { scratch } = this;
+    mat4.fromZRotation(this.rotation, glMatrix.toRadian(-params.rotation));
+
+    vec3.set(scratch, params.scaleX * (params.flipHorizontal ? -1 : 1), params.scaleY * (params.flipVertical ? -1 : 1), 1);
+    mat4.fromScaling(this.scale, scratch);
+
+    mat4.set(this.shear,
+      1,    params.shearY, 0, 0, // Col 1
+      params.shearX, 1,      0, 0, // Col 2
+      0,    0,      1, 0, // Col 3
+      0,    0,      0, 1  // Col 4
+    );
+
+    const { viewportWidth, viewportHeight } = params;
+    const tx = viewportWidth > 0 ? (params.translationX / viewportWidth) * 2 : 0;
+    const ty = viewportHeight > 0 ? (-params.translationY / viewportHeight) * 2 : 0; // Y is inverted in clip space
+    vec3.set(scratch, tx, ty, 0);
+    mat4.fromTranslation(this.translation, scratch);
+
+    // --- Combined matrix (Order: Scale -> Shear -> Rotate -> Translate) ---
+    // Note: Matrix multiplication is read right-to-left for application order
+    mat4.multiply(this.matrix, this.translation, this.rotation); // T * R
+    mat4.multiply(this.matrix, this.matrix, this.shear); // T * R * Sh
+    mat4.multiply(this.matrix, this.matrix, this.scale); // T * R * Sh * Sc
+
+    this.scheduleDisplay();
+  }
+
+  snapshot(): TransformSnapshot {
+    return {
+      overall: mat4.clone(this.matrix),
+      translation: mat4.clone(this.translation),
+      rotation: mat4.clone(this.rotation),
+      scale: mat4.clone(this.scale),
+      shear: mat4.clone(this.shear),
+      area: 4 * Math.abs(mat4.determinant(this.matrix)), // Original clip space area is 4 (-1 to 1)
+    };
+  }
+
+  // Sends throttled snapshots to listener (the first right away); returns an unsubscribe
+  subscribe(listener: (snapshot: TransformSnapshot) => void): () => void {
+    this.listener = listener;
+    listener(this.snapshot());
+    return () => {
+      this.listener = null;
+      if (this.displayTimer !== null) {
+        clearTimeout(this.displayTimer);
+        this.displayTimer = null;
+      }
+    };
+  }
+
+  // Leading and trailing edge: a drag shows its first and its final matrix, and at most
+  // one snapshot per interval in between
+  private scheduleDisplay() {
+    if (!this.listener || this.displayTimer !== null) {
+      return;
+    }
+    const wait = this.lastDisplay + DISPLAY_INTERVAL_MS - performance.now();
+    if (wait <= 0) {
+      this.emitDisplay();
+      return;
+    }
+    this.displayTimer = setTimeout(() => {
+      this.displayTimer = null;
+      this.emitDisplay();
+    }, wait);
+  }
+
+  private emitDisplay() {
+    this.lastDisplay = performance.now();
+    this.listener?.(this.snapshot());
+  }
+}
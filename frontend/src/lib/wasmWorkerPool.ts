@@ -0,0 +1,304 @@
+import type { EngineCancel, EngineCancelFlag, EngineInit, EngineOp, EngineRequest, EngineResponse, EngineStats, SVDDecodeProgress, SVDFactorsInfo } from './engineProtocol';
+import { loadEngineModules } from './engineModule';
+
+// RGBA image handed to the pool. The pool never takes ownership of `data`:
+// it transfers a copy to a worker only when that worker does not hold the image yet.
+export interface EngineImage {
+  data: Uint8ClampedArray;
+  width: number;
+  height: number;
+}
+
+export interface EngineResult {
+  data: Uint8ClampedArray;
+  width: number;
+  height: number;
+  elapsedMs: number; // Time spent inside the worker
+  progress?: SVDDecodeProgress; // Set by decodeSVD
+  factors?: SVDFactorsInfo; // Set by svdFactors; data then holds the float32 factor textures
+  stats?: EngineStats; // Phase timings and memory of the engine call
+}
+
+// Approximate reconstruction streamed while a progressive compressSVD job runs
+export interface EnginePartial {
+  data: Uint8ClampedArray;
+  width: number;
+  height: number;
+  rank: number;
+}
+
+export interface RunOptions {
+  // Jobs sharing an affinity tag prefer the worker that last ran that tag on the same
+  // image, e.g. so a worker that cached one channel's SVD factors keeps receiving it
+  affinity?: string;
+  // Aborting rejects the job with an AbortError. A queued job is dropped; an in-flight
+  // one is asked to stop (within one row chunk when the page is cross-origin isolated,
+  // otherwise at its next preview boundary) and its worker stays busy until it
+  // acknowledges, but no further callbacks are made.
+  signal?: AbortSignal;
+  onPartial?: (partial: EnginePartial) => void;
+}
+
+interface PendingJob {
+  image: EngineImage;
+  op: EngineOp;
+  options: RunOptions;
+  id?: number; // Request id, assigned at dispatch
+  settled: boolean; // Resolved, rejected or aborted; later worker replies are ignored
+  resolve: (result: EngineResult) => void;
+  reject: (error: Error) => void;
+}
+
+export const isAbortError = (error: unknown) => error instanceof DOMException && error.name === 'AbortError';
+
+const abortError = () => new DOMException('Engine job aborted', 'AbortError');
+
+interface WorkerSlot {
+  worker: Worker;
+  ready: boolean;
+  imageKey: number | null; // Image currently held in the worker's shared source buffer
+  affinities: Set<string>; // Affinity tags served for that image (e.g. state cached in the engine)
+  job: PendingJob | null; // In-flight job, null when idle
+  cancelFlag: Int32Array | null; // Shared with the worker; receives the id of a cancelled job
+}
+
+// Default pool size: one worker per core, capped because every worker hosts its own Go heap
+export const defaultPoolSize = () => Math.max(1, Math.min(navigator.hardwareConcurrency || 2, 8));
+
+// Pool of worker-hosted WASM engines. Jobs run off the main thread, at most one per
+// worker, and are dispatched preferring a worker that already holds the job's image.
+// main.wasm is compiled once and shared, so each worker only instantiates it.
+export class WasmWorkerPool {
+  readonly size: number;
+  readonly ready: Promise<void>;
+  private slots: WorkerSlot[] = [];
+  private queue: PendingJob[] = [];
+  private imageKeys = new WeakMap<Uint8ClampedArray, number>();
+  private nextImageKey = 1;
+  private nextRequestId = 1;
+  private logging = true;
+  private lanes = new Map<string, AbortController>();
+
+  constructor(size: number = defaultPoolSize()) {
+    this.size = size;
+    const modules = loadEngineModules();
+    const readiness: Promise<void>[] = [];
+    for (let i = 0; i < size; i++) {
+      const worker = new Worker(new URL('../workers/wasmEngine.worker.ts', import.meta.url), { type: 'classic' });
+      // Shared memory needs cross-origin isolation; without it cancellation is coarser
+      const cancelFlag = typeof SharedArrayBuffer !== 'undefined' && self.crossOriginIsolated
+        ? new Int32Array(new SharedArrayBuffer(4)) : null;
+      const slot: WorkerSlot = { worker, ready: false, imageKey: null, affinities: new Set(), job: null, cancelFlag };
+      this.slots.push(slot);
+      if (cancelFlag) {
+        const message: EngineCancelFlag = { op: 'setCancelFlag', flag: cancelFlag };
+        worker.postMessage(message);
+      }
+      readiness.push(new Promise<void>((resolve, reject) => {
+        worker.onmessage = (event: MessageEvent<EngineResponse>) => this.handleMessage(slot, event.data, resolve, reject);
+        worker.onerror = (event) => {
+          const error = new Error(`Worker error: ${event.message}`);
+          reject(error);
+          this.failSlot(slot, error);
+        };
+        modules.then(({ engine, simd }) => {
+          const init: EngineInit = { op: 'init', module: engine, simdModule: simd };
+          worker.postMessage(init);
+        }, (error) => {
+          const compileError = new Error(`Error compiling WASM: ${error instanceof Error ? error.message : error}`);
+          reject(compileError);
+          this.failSlot(slot, compileError);
+        });
+      }));
+    }
+    // Jobs can start as soon as one engine is up; the others join as they finish starting
+    this.ready = new Promise<void>((resolve, reject) => {
+      let failed = 0;
+      for (const started of readiness) {
+        started.then(resolve, (error) => {
+          if (++failed === readiness.length) {
+            reject(error);
+          }
+        });
+      }
+    });
+  }
+
+  // Queues op on image and resolves with the processed pixels
+  run(image: EngineImage, op: EngineOp, options: RunOptions = {}): Promise<EngineResult> {
+    return new Promise<EngineResult>((resolve, reject) => {
+      const { signal } = options;
+      if (signal?.aborted) {
+        reject(abortError());
+        return;
+      }
+      const onAbort = () => this.abort(job);
+      const job: PendingJob = {
+        image, op, options, settled: false,
+        resolve: (result) => {
+          signal?.removeEventListener('abort', onAbort);
+          resolve(result);
+        },
+        reject: (error) => {
+          signal?.removeEventListener('abort', onAbort);
+          reject(error);
+        },
+      };
+      signal?.addEventListener('abort', onAbort);
+      this.queue.push(job);
+      this.dispatch();
+    });
+  }
+
+  // Returns the signal for a new request on lane, aborting the previous request's signal.
+  // Requests whose results replace each other (e.g. everything shown on the canvas)
+  // share a lane, so rapid invocations cost one computation instead of queueing.
+  supersede(lane: string): AbortSignal {
+    this.lanes.get(lane)?.abort();
+    const controller = new AbortController();
+    this.lanes.set(lane, controller);
+    return controller.signal;
+  }
+
+  // Turns the engines' per-call console logging on or off; applies from each worker's next job
+  setLogging(enabled: boolean) {
+    this.logging = enabled;
+  }
+
+  terminate() {
+    const error = new Error('Worker pool terminated');
+    for (const slot of this.slots) {
+      slot.worker.terminate();
+      if (slot.job) {
+        this.settle(slot.job)?.reject(error);
+      }
+      slot.job = null;
+      slot.ready = false;
+    }
+    for (const job of this.queue) {
+      this.settle(job)?.reject(error);
+    }
+    this.queue = [];
+  }
+
+  // Marks job settled, returning it if it was not settled before
+  private settle(job: PendingJob): PendingJob | null {
+    if (job.settled) {
+      return null;
+    }
+    job.settled = true;
+    return job;
+  }
+
+  private abort(job: PendingJob) {
+    if (!this.settle(job)) {
+      return;
+    }
+    const queued = this.queue.indexOf(job);
+    if (queued >= 0) {
+      this.queue.splice(queued, 1);
+    } else {
+      const slot = this.slots.find(s => s.job === job);
+      if (slot) {
+        if (slot.cancelFlag) {
+          Atomics.store(slot.cancelFlag, 0, job.id!);
+        }
+        const cancel: EngineCancel = { op: 'cancel', id: job.id! };
+        slot.worker.postMessage(cancel);
+      }
+    }
+    job.reject(abortError());
+  }
+
+  private keyFor(image: EngineImage): number {
+    let key = this.imageKeys.get(image.data);
+    if (key === undefined) {
+      key = this.nextImageKey++;
+      this.imageKeys.set(image.data, key);
+    }
+    return key;
+  }
+
+  private dispatch() {
+    while (this.queue.length > 0) {
+      const idle = this.slots.filter(slot => slot.ready && !slot.job);
+      if (idle.length === 0) {
+        return;
+      }
+      const job = this.queue.shift()!;
+      const imageKey = this.keyFor(job.image);
+      const holders = idle.filter(s => s.imageKey === imageKey);
+      const { affinity } = job.options;
+      const slot = (affinity !== undefined ? holders.find(s => s.affinities.has(affinity)) : undefined)
+        ?? holders[0] ?? idle[0];
+
+      job.id = this.nextRequestId++;
+      const request: EngineRequest = { ...job.op, id: job.id, imageKey, width: job.image.width, height: job.image.height, logging: this.logging };
+      const transfer: Transferable[] = [];
+      if (slot.imageKey !== imageKey) {
+        request.pixels = job.image.data.slice().buffer;
+        transfer.push(request.pixels);
+        slot.imageKey = imageKey;
+        slot.affinities.clear();
+      }
+      if (affinity !== undefined) {
+        slot.affinities.add(affinity);
+      }
+      slot.job = job;
+      slot.worker.postMessage(request, transfer);
+    }
+  }
+
+  private handleMessage(slot: WorkerSlot, message: EngineResponse, resolveReady: () => void, rejectReady: (error: Error) => void) {
+    switch (message.type) {
+      case 'ready':
+        slot.ready = true;
+        resolveReady();
+        this.dispatch();
+        return;
+      case 'initError':
+        rejectReady(new Error(message.error));
+        this.failSlot(slot, new Error(message.error));
+        return;
+      case 'partial':
+        if (slot.job && !slot.job.settled) {
+          slot.job.options.onPartial?.({ data: new Uint8ClampedArray(message.pixels), width: message.width, height: message.height, rank: message.rank });
+        }
+        return;
+      case 'cancelled':
+        slot.job = null; // Already rejected by abort
+        this.dispatch();
+        return;
+      case 'result':
+      case 'error': {
+        const job = slot.job && this.settle(slot.job);
+        slot.job = null;
+        if (message.type === 'result') {
+          job?.resolve({ data: new Uint8ClampedArray(message.pixels), width: message.width, height: message.height, elapsedMs: message.elapsedMs, progress: message.progress, factors: message.factors, stats: message.stats });
+        } else {
+          slot.imageKey = null; // The worker may not hold the image after a failure
+          slot.affinities.clear();
+          job?.reject(new Error(message.error));
+        }
+        this.dispatch();
+        return;
+      }
+    }
+  }
+
+  // Takes a broken worker out of rotation and fails its in-flight job
+  private failSlot(slot: WorkerSlot, error: Error) {
+    slot.ready = false;
+    if (slot.job) {
+      this.settle(slot.job)?.reject(error);
+    }
+    slot.job = null;
+    if (!this.slots.some(s => s.ready)) {
+      // No worker left to run queued jobs
+      for (const job of this.queue) {
+        this.settle(job)?.reject(error);
+      }
+      this.queue = [];
+    }
+  }
+}
@@ -0,0 +1,109 @@
+// Minimal ZIP archive writer for batch downloads.
+// Entries are stored uncompressed: PNG data is already deflated, so compressing it
+// again would cost time for almost no size. One local header precedes each entry's
+// bytes and the central directory follows the last entry. Without ZIP64, archives are
+// limited to 4 GiB and 65535 entries; createZip throws rather than write a corrupt one.
+// Entry data stays in its Blob: it is read once for the CRC, and the archive Blob
+// references the entry Blobs instead of copies of their bytes.
+
+export interface ZipEntry {
+  name: string; // Path inside the archive, '/'-separated
+  data: Blob;
+}
+
+const CRC_TABLE = (() => {
+  const table = new Uint32Array(256);
+  for (let n = 0; n < 256; n++) {
+    let c = n;
+    for (let k = 0; k < 8; k++) {
+      c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+    }
+    table[n] = c >>> 0;
+  }
+  return table;
+})();
+
+function crc32(bytes: Uint8Array): number {
+  let crc = 0xffffffff;
+  for (let i = 0; i < bytes.length; i++) {
+    crc = CRC_TABLE[(crc ^ bytes[i]) & 0xff] ^ (crc >>> 8);
+  }
+  return (crc ^ 0xffffffff) >>> 0;
+}
+
+const UTF8_NAMES = 1 << 11; // General purpose flag: names are UTF-8
+const MAX_ENTRIES = 0xffff;
+const MAX_OFFSET = 0xffffffff;
+
+// MS-DOS time and date fields (local time, 2-second resolution, years from 1980)
+function dosDateTime(date: Date): { time: number; day: number } {
+  const year = Math.max(1980, Math.min(date.getFullYear(), 2107));
+  return {
+    time: (date.getHours() << 11) | (date.getMinutes() << 5) | (date.getSeconds() >> 1),
+    day: ((year - 1980) << 9) | ((date.getMonth() + 1) << 5) | date.getDate(),
+  };
+}
+
+// Builds a ZIP archive of entries
+export async function createZip(entries: ZipEntry[]): Promise<Blob> {
+  if (entries.length > MAX_ENTRIES) {
+    throw new Error(`ZIP archives hold at most ${MAX_ENTRIES} entries, got ${entries.length}`);
+  }
+  const encoder = new TextEncoder();
+  const { time, day } = dosDateTime(new Date());
+  const parts: BlobPart[] = [];
+  const directory: Uint8Array[] = [];
+  let offset = 0;
+
+  for (const entry of entries) {
+    const name = encoder.encode(entry.name);
+    const size = entry.data.size;
+    if (offset + 30 + name.length + size > MAX_OFFSET) {
+      throw new Error('ZIP archive would exceed 4 GiB; download fewer files at once');
+    }
+    const crc = crc32(new Uint8Array(await entry.data.arrayBuffer())); // The copy is dropped right away
+
+    const local = new DataView(new ArrayBuffer(30 + name.length));
+    local.setUint32(0, 0x04034b50, true); // Local file header signature
+    local.setUint16(4, 20, true); // Version needed to extract (2.0)
+    local.setUint16(6, UTF8_NAMES, true);
+    // Method 0 (stored) at offset 8
+    local.setUint16(10, time, true);
+    local.setUint16(12, day, true);
+    local.setUint32(14, crc, true);
+    local.setUint32(18, size, true); // Compressed size
+    local.setUint32(22, size, true); // Uncompressed size
+    local.setUint16(26, name.length, true);
+    new Uint8Array(local.buffer).set(name, 30);
+
+    const central = new DataView(new ArrayBuffer(46 + name.length));
+    central.setUint32(0, 0x02014b50, true); // Central directory header signature
+    central.setUint16(4, 20, true); // Version made by
+    central.setUint16(6, 20, true); // Version needed to extract
+    central.setUint16(8, UTF8_NAMES, true);
+    central.setUint16(12, time, true);
+    central.setUint16(14, day, true);
+    central.setUint32(16, crc, true);
+    central.setUint32(20, size, true);
+    central.setUint32(24, size, true);
+    central.setUint16(28, name.length, true);
+    central.setUint32(42, offset, true); // Offset of the local header
+    new Uint8Array(central.buffer).set(name, 46);
+
+    parts.push(local.buffer, entry.data);
+    directory.push(new Uint8Array(central.buffer));
+    offset += local.byteLength + size;
+  }
+
+  const directorySize = directory.reduce((sum, header) => sum + header.length, 0);
+  if (offset + directorySize > MAX_OFFSET) {
+    throw new Error('ZIP archive would exceed 4 GiB; download fewer files at once');
+  }
+  const end = new DataView(new ArrayBuffer(22));
+  end.setUint32(0, 0x06054b50, true); // End of central directory signature
+  end.setUint16(8, entries.length, true); // Entries on this disk
+  end.setUint16(10, entries.length, true); // Total entries
+  end.setUint32(12, directorySize, true);
+  end.setUint32(16, offset, true); // Offset of the central directory
+  return new Blob([...parts, ...directory, end.buffer], { type: 'application/zip' });
+}
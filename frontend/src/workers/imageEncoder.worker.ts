@@ -0,0 +1,21 @@
+// Encodes exported pixels into image files off the main thread (see lib/imageExport.ts).
+// Loaded as a module worker; OffscreenCanvas.convertToBlob does the encoding.
+import { encodeImage } from '../lib/imageCodec';
+import type { EncodeRequest, EncodeResponse } from '../lib/imageExport';
+
+interface EncoderScope {
+  postMessage: (message: EncodeResponse) => void;
+  onmessage: ((event: MessageEvent<EncodeRequest>) => void) | null;
+}
+
+const scope = self as unknown as EncoderScope;
+
+scope.onmessage = async (event) => {
+  const { id, pixels, width, height, type, quality } = event.data;
+  try {
+    const blob = await encodeImage({ data: new Uint8ClampedArray(pixels), width, height }, type, quality);
+    scope.postMessage({ id, blob }); // Blobs are passed by handle, the bytes are not copied
+  } catch (error) {
+    scope.postMessage({ id, error: error instanceof Error ? error.message : String(error) });
+  }
+};
@@ -0,0 +1,271 @@
+// Worker-hosted TinyIMG engine: owns one Go WASM instance and processes EngineRequests.
+// Loaded as a classic worker so the Go runtime (wasm_exec.js) can be pulled in with
+// importScripts; only type imports are allowed here.
+import type { EngineInit, EngineMessage, EngineRequest, EngineResponse, EngineStats, PipelineStage, SharedBufferInfo, SharedBufferResult, SVDDecodeProgress, SVDDecodeResult, SVDEncodeOptions, SVDFactorsInfo, SVDFactorsResult, SVDOptions } from '../lib/engineProtocol';
+import type { KernelSpec } from '../lib/kernels';
+
+declare function importScripts(...urls: string[]): void;
+
+// Globals installed by wasm_exec.js and registered by main.wasm
+interface EngineScope {
+  Go: any;
+  getSharedBuffer?: (name: 'source' | 'result', byteLength: number) => SharedBufferResult;
+  applyFilterShared?: (width: number, height: number, filterType: string) => SharedBufferResult;
+  applyKernelShared?: (width: number, height: number, kernel: KernelSpec) => SharedBufferResult;
+  applyPipelineShared?: (width: number, height: number, stages: PipelineStage[]) => SharedBufferResult;
+  compressSVDShared?: (width: number, height: number, rank: number, options?: SVDOptions) => SharedBufferResult;
+  compressSVDPreviewShared?: (width: number, height: number, rank: number, options?: SVDOptions) => SharedBufferResult;
+  svdCacheReady?: (width: number, height: number, rank: number, options?: SVDOptions) => boolean | { error: string };
+  encodeSVDShared?: (width: number, height: number, rank: number, options?: SVDEncodeOptions) => SharedBufferResult;
+  svdFactorsShared?: (width: number, height: number, rank: number, options?: SVDOptions) => SVDFactorsResult;
+  svdDecoderPush?: (streamId: number, chunk: Uint8Array, final: boolean) => SVDDecodeResult;
+  getEngineStats?: () => EngineStats | null;
+  setEngineLogging?: (enabled: boolean) => void;
+  setCancelToken?: (flag: Int32Array | null, id?: number) => void;
+  setSIMDKernels?: (kernels: WebAssembly.Exports | null) => void | { error: string };
+  postMessage: (message: EngineResponse, options?: { transfer?: Transferable[] }) => void;
+  onmessage: ((event: MessageEvent<EngineMessage>) => void) | null;
+}
+
+const scope = self as unknown as EngineScope;
+
+let memory: WebAssembly.Memory | null = null;
+let sourceKey: number | null = null; // imageKey currently held in the shared source buffer
+let logging = true; // Mirrors the engine's setEngineLogging state
+let activeId: number | null = null; // Request currently being processed
+let cancelRequested = false; // A cancel message for activeId arrived
+let cancelFlag: Int32Array | null = null; // Shared with the pool, holds the id of a cancelled request
+
+const isCancelled = () =>
+  cancelRequested || (cancelFlag !== null && activeId !== null && Atomics.load(cancelFlag, 0) === activeId);
+
+// Views are rebuilt on every use: Go heap growth replaces memory.buffer
+const view = (info: { ptr: number; length: number }) =>
+  new Uint8ClampedArray(memory!.buffer, info.ptr, info.length);
+
+const unwrap = <T extends SharedBufferInfo>(result: T | { error: string } | undefined, name: string): T => {
+  if (!result) {
+    throw new Error(`${name} function not available.`);
+  }
+  if ('error' in result) {
+    throw new Error(result.error);
+  }
+  return result as T;
+};
+
+interface RequestOutput {
+  pixels: ArrayBuffer;
+  width: number;
+  height: number;
+  progress?: SVDDecodeProgress;
+  factors?: SVDFactorsInfo;
+  copyInMs?: number; // Time spent copying the source into WASM memory, if it was sent
+  copyInBytes?: number;
+  copyOutMs: number; // Time spent copying the result out of WASM memory
+}
+
+// Feeds one TSVD chunk to the decoder; needs no source image
+const runDecode = (request: Extract<EngineRequest, { op: 'decodeSVD' }>): RequestOutput => {
+  const result = unwrap(scope.svdDecoderPush?.(request.streamId, new Uint8Array(request.chunk), request.final), 'svdDecoderPush');
+  const { width, height, rank, totalRank, done } = result;
+  const copyStart = performance.now();
+  const pixels = view(result).slice().buffer;
+  return { pixels, width, height, progress: { rank, totalRank, done }, copyOutMs: performance.now() - copyStart };
+};
+
+// Packs the source's SVD factors as float textures; the Float32 layout is copied bytewise
+const runFactors = (request: Extract<EngineRequest, { op: 'svdFactors' }>, copyInMs: number | undefined): RequestOutput => {
+  const { width, height } = request;
+  const result = unwrap(scope.svdFactorsShared?.(width, height, request.rank, request.options), 'svdFactorsShared');
+  const copyStart = performance.now();
+  const pixels = view(result).slice().buffer;
+  return {
+    pixels, width, height, factors: { terms: result.terms, ranks: result.ranks },
+    copyInMs, copyInBytes: request.pixels?.byteLength, copyOutMs: performance.now() - copyStart,
+  };
+};
+
+// Makes request's image the engine's source, copying it in if it was sent. Returns the
+// copy time, or undefined when the worker already held the image.
+const loadSource = (request: EngineRequest): number | undefined => {
+  if (request.pixels) {
+    // Copy the transferred source into the persistent Go-owned buffer once per image
+    const copyStart = performance.now();
+    const info = unwrap(scope.getSharedBuffer?.('source', request.pixels.byteLength), 'getSharedBuffer');
+    view(info).set(new Uint8ClampedArray(request.pixels));
+    sourceKey = request.imageKey;
+    return performance.now() - copyStart;
+  }
+  if (sourceKey !== request.imageKey) {
+    throw new Error(`Worker does not hold image ${request.imageKey}`);
+  }
+  return undefined;
+};
+
+// Hands the SIMD kernels to the engine. The kernel module imports the Go heap as its
+// memory, so it works on Go slices in place. Any failure leaves the engine on its
+// scalar loops, which produce the same results.
+const loadSIMDKernels = async (module: WebAssembly.Module) => {
+  try {
+    const instance = await WebAssembly.instantiate(module, { env: { memory: memory! } });
+    const result = scope.setSIMDKernels?.(instance.exports);
+    if (result && 'error' in result) {
+      throw new Error(result.error);
+    }
+  } catch (error) {
+    console.warn('SIMD kernels unavailable, using scalar loops:', error);
+  }
+};
+
+// Lets queued messages (cancels) in before the next engine call
+const yieldToMessages = () => new Promise<void>(resolve => setTimeout(resolve, 0));
+
+// Posts a quick reconstruction at each of the request's preview ranks below its rank,
+// checking for a cancel before each one. Previews are skipped when the engine already
+// caches the factors, since the exact result is then only a reconstruction away.
+// Returns false if the request was cancelled.
+const streamPreviews = async (request: Extract<EngineRequest, { op: 'compressSVD' }>): Promise<boolean> => {
+  const { width, height, rank, options } = request;
+  const ranks = [...new Set(request.previewRanks ?? [])].filter(r => r > 0 && r < rank).sort((a, b) => a - b);
+  if (ranks.length === 0 || options?.blockSize || scope.svdCacheReady?.(width, height, rank, options) !== false) {
+    return true;
+  }
+  for (const previewRank of ranks) {
+    await yieldToMessages();
+    if (isCancelled()) {
+      return false;
+    }
+    const info = unwrap(scope.compressSVDPreviewShared?.(width, height, previewRank, options), 'compressSVDPreviewShared');
+    const pixels = view(info).slice().buffer;
+    scope.postMessage({ type: 'partial', id: request.id, pixels, width, height, rank: previewRank }, { transfer: [pixels] });
+  }
+  await yieldToMessages();
+  return !isCancelled();
+};
+
+const runRequest = (request: EngineRequest, copyInMs: number | undefined): RequestOutput => {
+  if (request.op === 'decodeSVD') {
+    return runDecode(request);
+  }
+  const { width, height } = request;
+  if (request.op === 'svdFactors') {
+    return runFactors(request, copyInMs);
+  }
+
+  let result: SharedBufferResult | undefined;
+  switch (request.op) {
+    case 'applyFilter':
+      result = scope.applyFilterShared?.(width, height, request.filterType);
+      break;
+    case 'applyKernel':
+      result = scope.applyKernelShared?.(width, height, request.kernel);
+      break;
+    case 'applyPipeline':
+      result = scope.applyPipelineShared?.(width, height, request.stages);
+      break;
+    case 'compressSVD':
+      result = scope.compressSVDShared?.(width, height, request.rank, request.options);
+      break;
+    case 'encodeSVD':
+      result = scope.encodeSVDShared?.(width, height, request.rank, request.options);
+      break;
+  }
+
+  // One copy out of WASM memory into a standalone buffer that can be transferred
+  const info = unwrap(result, `${request.op}Shared`);
+  const copyStart = performance.now();
+  const pixels = view(info).slice().buffer;
+  return { pixels, width, height, copyInMs, copyInBytes: request.pixels?.byteLength, copyOutMs: performance.now() - copyStart };
+};
+
+// The engine's stats for the call that produced output, with the worker's own copies added
+const collectStats = (output: RequestOutput): EngineStats | undefined => {
+  const stats = scope.getEngineStats?.();
+  if (!stats) {
+    return undefined;
+  }
+  if (output.copyInMs !== undefined) {
+    stats.phases.unshift({ name: 'copy-in (js)', ms: output.copyInMs });
+    stats.bytesIn += output.copyInBytes ?? 0;
+  }
+  stats.phases.push({ name: 'copy-out (js)', ms: output.copyOutMs });
+  stats.bytesOut += output.pixels.byteLength;
+  return stats;
+};
+
+// Starts the Go instance from the modules compiled on the main thread
+const start = async (message: EngineInit) => {
+  try {
+    importScripts('/wasm_exec.js');
+    const go = new scope.Go();
+    const instance = await WebAssembly.instantiate(message.module, go.importObject);
+    memory = instance.exports.mem as WebAssembly.Memory;
+    // go.run executes main() synchronously up to its blocking select, registering the exports
+    go.run(instance).catch((err: unknown) => {
+      scope.postMessage({ type: 'initError', error: `Error during WASM execution: ${err}` });
+    });
+    if (typeof scope.applyFilterShared !== 'function') {
+      throw new Error("WASM exports not registered. Check Go registration.");
+    }
+    if (message.simdModule) {
+      await loadSIMDKernels(message.simdModule);
+    }
+    scope.postMessage({ type: 'ready' });
+  } catch (error) {
+    scope.postMessage({ type: 'initError', error: `Error loading WASM: ${error}` });
+  }
+};
+
+scope.onmessage = async (event) => {
+  const message = event.data;
+  if (message.op === 'init') {
+    await start(message);
+    return;
+  }
+  if (message.op === 'setCancelFlag') {
+    cancelFlag = message.flag;
+    return;
+  }
+  if (message.op === 'cancel') {
+    // Cancels only take effect between progressive steps; a request that already
+    // finished has been answered and the cancel is dropped
+    cancelRequested ||= message.id === activeId;
+    return;
+  }
+  const request = message;
+  const startTime = performance.now();
+  activeId = request.id;
+  cancelRequested = false;
+  if (request.logging !== undefined && request.logging !== logging) {
+    logging = request.logging;
+    scope.setEngineLogging?.(logging);
+  }
+  try {
+    const copyInMs = request.op === 'decodeSVD' ? undefined : loadSource(request);
+    if (request.op === 'compressSVD' && request.previewRanks && !(await streamPreviews(request))) {
+      scope.postMessage({ type: 'cancelled', id: request.id });
+      return;
+    }
+    // The engine polls the flag inside its loops; decoding keeps state and ignores it
+    scope.setCancelToken?.(cancelFlag, request.id);
+    const output = runRequest(request, copyInMs);
+    if (request.op !== 'decodeSVD' && isCancelled()) {
+      scope.postMessage({ type: 'cancelled', id: request.id }); // The output is incomplete
+      return;
+    }
+    const { pixels, width, height, progress, factors } = output;
+    const stats = collectStats(output);
+    scope.postMessage(
+      { type: 'result', id: request.id, pixels, width, height, elapsedMs: performance.now() - startTime, progress, factors, stats },
+      { transfer: [pixels] },
+    );
+  } catch (error) {
+    if (isCancelled()) {
+      scope.postMessage({ type: 'cancelled', id: request.id }); // Failed because it stopped halfway
+      return;
+    }
+    scope.postMessage({ type: 'error', id: request.id, error: error instanceof Error ? error.message : String(error) });
+  } finally {
+    activeId = null;
+  }
+};